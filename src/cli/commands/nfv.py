@@ -88,7 +88,8 @@ class SppNfv(object):
             dst = None
             for patch in nfv_attr['patches']:
                 if patch['src'] == port:
-                    dst = patch['dst']
+                    dst = ', '.join([patch['dst']] +
+                                    patch.get('fanout', []))
 
             if dst is None:
                 print('  - {}'.format(port))
@@ -513,6 +514,40 @@ class SppNfv(object):
                         params_index += 2
                         req_params["dst"] += "nq" + params[params_index]
 
+            elif params[params_index] == "fanout":
+                if params_index + 1 >= len(params):
+                    print("Error: Port of 'fanout' is required!")
+                    return
+                params_index += 1
+                fanout_port = params[params_index]
+                if params_index + 2 < len(params):
+                    if params[params_index + 1] == "nq":
+                        params_index += 2
+                        fanout_port += "nq" + params[params_index]
+                req_params.setdefault("fanout", []).append(fanout_port)
+
+            elif params[params_index] == "mode":
+                if (params_index + 1 >= len(params) or
+                        params[params_index + 1] not in ["copy", "hash"]):
+                    print("Error: Mode must be 'copy' or 'hash'!")
+                    return
+                params_index += 1
+                req_params["mode"] = params[params_index]
+
+            elif params[params_index] in ["burst", "drain"]:
+                if params_index + 1 >= len(params):
+                    print("Error: Value of '{}' is required!".format(
+                        params[params_index]))
+                    return
+                try:
+                    req_params[params[params_index]] = int(
+                        params[params_index + 1])
+                except ValueError:
+                    print("Error: Invalid value of '{}'!".format(
+                        params[params_index]))
+                    return
+                params_index += 1
+
             params_index += 1
 
         if flg_reset is False:
@@ -547,6 +582,11 @@ class SppNfv(object):
                    if "nq" in req_params["src"] else req_params["src"])
             dst = (req_params["dst"].replace("nq", " nq ")
                    if "nq" in req_params["dst"] else req_params["dst"])
+            for port in req_params.get("fanout", []):
+                dst += ", " + (port.replace("nq", " nq ")
+                               if "nq" in port else port)
+            if req_params.get("mode") == "hash":
+                dst = "hash of " + dst
             print("Patch ports ({0} -> {1}).".format(src, dst))
 
     def _run_exit(self):
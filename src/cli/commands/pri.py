@@ -164,6 +164,13 @@ class SppPrimary(object):
                         "rx": 78932932,
                         "tx": 78932931,
                         "tx_drop": 1,
+                        "nof_queues": {"rx": 16, "tx": 16},
+                        "offload": {
+                            "rx": ["vlan_strip"],
+                            "tx": ["tcp_tso"],
+                            "rss_hf": 4,
+                            "mtu": 1500
+                        }
                     }
                     ...
                 ],
@@ -194,6 +201,9 @@ class SppPrimary(object):
                   ID          rx          tx     tx_drop  rxq  txq  mac_addr
                    0    78932932    78932931           1   16   16  56:48:...
                    ...
+              - offloads:
+                   0  rx: [vlan_strip], tx: [tcp_tso], rss_hf: 0x4, mtu: 1500
+                   ...
               - ring ports:
                   ID          rx          tx     rx_drop     tx_drop
                    0       89283       89283           0           0
@@ -249,6 +259,22 @@ class SppPrimary(object):
                                       txq=pports["nof_queues"]["tx"],
                                       eth=pports['eth']))
 
+                # Offloads are shown only for ports enabling any of them.
+                offloads = [pp for pp in json_obj['phy_ports']
+                            if 'offload' in pp and (
+                                pp['offload']['rx'] or pp['offload']['tx']
+                                or pp['offload']['rss_hf'])]
+                if offloads:
+                    print('  - offloads:')
+                    for pports in offloads:
+                        print('{s6}{portid:2}  rx: [{rx}], tx: [{tx}], '
+                              'rss_hf: {rss:#x}, mtu: {mtu}'.format(
+                                  s6=sep*6, portid=pports['id'],
+                                  rx=', '.join(pports['offload']['rx']),
+                                  tx=', '.join(pports['offload']['tx']),
+                                  rss=pports['offload']['rss_hf'],
+                                  mtu=pports['offload']['mtu']))
+
             if 'ring_ports' in json_obj:
                 print('  - ring ports:')
                 print('{s6}ID{s10}rx{s10}tx{s5}rx_drop{s5}tx_drop'.format(
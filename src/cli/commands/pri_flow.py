@@ -28,11 +28,17 @@ class SppPrimaryFlow(object):
     FLOW_API_CREATE = "primary/flow_rules/port_id/{port_id}"
     FLOW_API_DESTROY = "primary/flow_rules/{rule_id}/port_id/{port_id}"
     FLOW_API_ALL_DESTROY = "primary/flow_rules/port_id/{port_id}"
+    FLOW_API_LIST = "primary/flow_rules/port_id/{port_id}?start={start}"
 
     # Completion class relevant to the pattern item type
     PTN_COMPL_CLASSES = {
         "eth": flow_compl_ptn.ComplEth,
         "vlan": flow_compl_ptn.ComplVlan,
+        "ipv4": flow_compl_ptn.ComplIpv4,
+        "ipv6": flow_compl_ptn.ComplIpv6,
+        "udp": flow_compl_ptn.ComplUdp,
+        "tcp": flow_compl_ptn.ComplTcp,
+        "vxlan": flow_compl_ptn.ComplVxlan,
     }
 
     # Completion class relevant to the action type
@@ -43,6 +49,9 @@ class SppPrimaryFlow(object):
         "of_set_vlan_pcp": flow_compl_act.ComplOfSetVlanPCP,
         "of_set_vlan_vid": flow_compl_act.ComplOfSetVlanVID,
         "queue": flow_compl_act.ComplQueue,
+        "rss": flow_compl_act.ComplRss,
+        "count": flow_compl_act.ComplCount,
+        "mark": flow_compl_act.ComplMark,
     }
 
     def __init__(self, spp_ctl_cli):
@@ -425,17 +434,7 @@ class SppPrimaryFlow(object):
             print("RES_UID is invalid")
             return None
 
-        status = self._get_pri_status()
-        if (status is None) or ("phy_ports" not in status):
-            print("Failed to get primary status")
-            return None
-
-        target_flow_list = None
-        for phy_port in status.get("phy_ports"):
-            if phy_port.get("id") == port_id:
-                target_flow_list = phy_port.get("flow")
-                break
-
+        target_flow_list = self._get_flow_rules(port_id)
         if target_flow_list is None:
             print("'{0}' is invalid".format(params[0]))
             return None
@@ -463,17 +462,7 @@ class SppPrimaryFlow(object):
             print("RULE_ID is invalid")
             return None
 
-        status = self._get_pri_status()
-        if (status is None) or ("phy_ports" not in status):
-            print("Failed to get primary status")
-            return None
-
-        target_flow_list = None
-        for phy_port in status.get("phy_ports"):
-            if phy_port.get("id") == port_id:
-                target_flow_list = phy_port.get("flow")
-                break
-
+        target_flow_list = self._get_flow_rules(port_id, rule_id, 1)
         if target_flow_list is None:
             print("'{0}' is invalid".format(params[0]))
             return None
@@ -508,6 +497,36 @@ class SppPrimaryFlow(object):
 
         return body
 
+    def _get_flow_rules(self, port_id, start=0, limit=None):
+        """Get flow rules of the port from rule ID `start`.
+
+        Rules are got page by page until `limit` of rules, or all of rules
+        if `limit` is None. Return None if failed.
+        """
+        flow_list = []
+        while start is not None:
+            url = self.FLOW_API_LIST.format(port_id=port_id, start=start)
+            if limit is not None:
+                url += "&limit={0}".format(limit - len(flow_list))
+
+            try:
+                res = self.spp_ctl_cli.get(url)
+                if res is None or res.status_code != 200:
+                    return None
+                body = res.json()
+            except Exception as _:
+                return None
+
+            if body.get("result") != "success":
+                return None
+
+            flow_list.extend(body.get("rules"))
+            start = body.get("next_rule_id")
+            if limit is not None and len(flow_list) >= limit:
+                break
+
+        return flow_list
+
     def _get_candidacy_phy_ports(self):
         """Get physical_ports candidates
 
@@ -545,19 +564,7 @@ class SppPrimaryFlow(object):
         except Exception as _:
             return None
 
-        pri_status = self._get_pri_status()
-        if pri_status is None:
-            return None
-
-        if "phy_ports" not in pri_status:
-            return None
-
-        flow_list = None
-        for port in pri_status["phy_ports"]:
-            if port["id"] == port_id:
-                flow_list = port["flow"]
-                break
-
+        flow_list = self._get_flow_rules(port_id)
         if flow_list is None:
             return None
 
@@ -884,6 +891,10 @@ class SppPrimaryFlow(object):
           - queue:
             - index: 0
           - of_pop_vlan:
+          - count:
+            - identifier: 0
+            - hits: 120
+            - bytes: 7680
         -----
         """
         act_type_indent = 2
@@ -901,6 +912,11 @@ class SppPrimaryFlow(object):
                 if conf is not None:
                     self._print_action_conf(conf)
 
+                # Query print, such as counters of `count`
+                query = act.get("query")
+                if query is not None:
+                    self._print_action_conf(query)
+
         except Exception as _:
             print("Error: `actions` structure of json received "
                   "from spp-ctl is invalid")
@@ -113,3 +113,91 @@ class ComplQueue(BaseComplAction):
     DATA_FIELDS_VALUES = {
         "index": "UNSIGNED_INT"
     }
+
+
+class ComplRss(BaseComplAction):
+    """Complete action `rss`.
+
+    Values of `types` and `queues` are given as a list terminated with
+    `end`, for example `rss types ip udp end queues 0 1 end`.
+    """
+
+    # Rss data fields
+    DATA_FIELDS = ["func", "level", "types", "queues"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "func": ["default", "toeplitz", "simple_xor"],
+        "level": ["UNSIGNED_INT"]
+    }
+
+    # Candidates of DATA_FIELDS given as a list
+    LIST_FIELDS_VALUES = {
+        "types": ["ip", "udp", "tcp", "sctp", "ipv4", "ipv6",
+                  "l2-payload", "vxlan"],
+        "queues": ["UNSIGNED_INT"]
+    }
+
+    def compl_action(self, tokens, index):
+        """Completion for actions list including lists of values."""
+        candidates = []
+        list_field = None
+
+        while index < len(tokens):
+            if list_field is not None:
+                if tokens[index - 1] == "end":
+                    # The list is terminated
+                    list_field = None
+                    candidates = copy.deepcopy(self.DATA_FIELDS)
+                    candidates.append("/")
+                else:
+                    candidates = copy.deepcopy(
+                        self.LIST_FIELDS_VALUES[list_field])
+                    candidates.append("end")
+
+            elif tokens[index - 1] == "/":
+                # Completion processing end when "/" is specified
+                candidates = []
+                break
+
+            elif tokens[index - 1] in self.LIST_FIELDS_VALUES:
+                list_field = tokens[index - 1]
+                candidates = copy.deepcopy(
+                    self.LIST_FIELDS_VALUES[list_field])
+
+            elif tokens[index - 1] in self.DATA_FIELDS_VALUES:
+                candidates = copy.deepcopy(
+                    self.DATA_FIELDS_VALUES[tokens[index - 1]])
+
+            else:
+                # Data fields candidate and end token
+                candidates = copy.deepcopy(self.DATA_FIELDS)
+                candidates.append("/")
+
+            index += 1
+
+        return (candidates, index)
+
+
+class ComplCount(BaseComplAction):
+    """Complete action `count`."""
+
+    # Count data fields
+    DATA_FIELDS = ["identifier"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "identifier": "UNSIGNED_INT"
+    }
+
+
+class ComplMark(BaseComplAction):
+    """Complete action `mark`."""
+
+    # Mark data fields
+    DATA_FIELDS = ["id"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "id": "UNSIGNED_INT"
+    }
@@ -82,3 +82,73 @@ class ComplVlan(BaseComplPatternItem):
         "vid": "UNSIGNED_INT",
         "inner_type": "UNSIGNED_INT"
     }
+
+
+class ComplIpv4(BaseComplPatternItem):
+    """Complete pattern item `ipv4`."""
+
+    # Ipv4 data fields
+    DATA_FIELDS = ["src", "dst", "tos", "ttl", "proto"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "IPV4_ADDRESS",
+        "dst": "IPV4_ADDRESS",
+        "tos": "UNSIGNED_INT",
+        "ttl": "UNSIGNED_INT",
+        "proto": "UNSIGNED_INT"
+    }
+
+
+class ComplIpv6(BaseComplPatternItem):
+    """Complete pattern item `ipv6`."""
+
+    # Ipv6 data fields
+    DATA_FIELDS = ["src", "dst", "proto", "hop"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "IPV6_ADDRESS",
+        "dst": "IPV6_ADDRESS",
+        "proto": "UNSIGNED_INT",
+        "hop": "UNSIGNED_INT"
+    }
+
+
+class ComplUdp(BaseComplPatternItem):
+    """Complete pattern item `udp`."""
+
+    # Udp data fields
+    DATA_FIELDS = ["src", "dst"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "UNSIGNED_INT",
+        "dst": "UNSIGNED_INT"
+    }
+
+
+class ComplTcp(BaseComplPatternItem):
+    """Complete pattern item `tcp`."""
+
+    # Tcp data fields
+    DATA_FIELDS = ["src", "dst", "flags"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "UNSIGNED_INT",
+        "dst": "UNSIGNED_INT",
+        "flags": "UNSIGNED_INT"
+    }
+
+
+class ComplVxlan(BaseComplPatternItem):
+    """Complete pattern item `vxlan`."""
+
+    # Vxlan data fields
+    DATA_FIELDS = ["vni"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "vni": "UNSIGNED_INT"
+    }
@@ -16,6 +16,7 @@
 #include <rte_kvargs.h>
 #include <rte_vhost.h>
 #include <rte_spinlock.h>
+#include <rte_jhash.h>
 
 static int vhost_logtype;
 
@@ -59,7 +60,75 @@ static struct rte_eth_link pmd_link = {
 };
 
 #define MZ_RTE_VHOST_PMD_INTERNAL "vhost_pmd_internal"
-static struct pmd_internal **pmd_internal_list;
+
+/* Num of buckets of index of internals hashed with iface name. */
+#define IFACE_IDX_BUCKETS (RTE_MAX_ETHPORTS * 2)
+
+/*
+ * Internals of ports shared among processes, and index of them for finding
+ * from iface name. Each of buckets is a list of port IDs chained with
+ * `iface_next`, and port ID + 1 is stored so that zero means the end.
+ * They are updated from primary and secondaries, so that `lock` must be
+ * held while referring or updating them.
+ */
+struct pmd_internal_shared {
+	rte_spinlock_t lock;
+	struct pmd_internal *list[RTE_MAX_ETHPORTS];
+	uint32_t iface_hash[RTE_MAX_ETHPORTS];
+	uint16_t iface_next[RTE_MAX_ETHPORTS];
+	uint16_t iface_heads[IFACE_IDX_BUCKETS];
+};
+
+static struct pmd_internal_shared *pmd_internal_shared;
+
+static inline uint32_t
+get_iface_hash(const char *iface_name)
+{
+	return rte_jhash(iface_name, strlen(iface_name), 0);
+}
+
+/* Add internal of the port to shared list and index of iface name. */
+static void
+register_internal(uint16_t port_id, struct pmd_internal *internal)
+{
+	struct pmd_internal_shared *shared = pmd_internal_shared;
+	uint32_t hash = get_iface_hash(internal->iface_name);
+	uint16_t *head = &shared->iface_heads[hash % IFACE_IDX_BUCKETS];
+
+	rte_spinlock_lock(&shared->lock);
+	shared->list[port_id] = internal;
+	shared->iface_hash[port_id] = hash;
+	shared->iface_next[port_id] = *head;
+	*head = port_id + 1;
+	rte_spinlock_unlock(&shared->lock);
+}
+
+/* Remove internal of the port from shared list and index of iface name. */
+static void
+unregister_internal(uint16_t port_id)
+{
+	struct pmd_internal_shared *shared = pmd_internal_shared;
+	uint16_t *p;
+
+	rte_spinlock_lock(&shared->lock);
+	if (shared->list[port_id] == NULL) {
+		rte_spinlock_unlock(&shared->lock);
+		return;
+	}
+
+	p = &shared->iface_heads[shared->iface_hash[port_id] %
+			IFACE_IDX_BUCKETS];
+	while (*p != 0) {
+		if (*p == port_id + 1) {
+			*p = shared->iface_next[port_id];
+			break;
+		}
+		p = &shared->iface_next[*p - 1];
+	}
+	shared->iface_next[port_id] = 0;
+	shared->list[port_id] = NULL;
+	rte_spinlock_unlock(&shared->lock);
+}
 
 static uint16_t
 eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
@@ -120,22 +189,30 @@ out:
 static inline struct pmd_internal *
 find_internal_resource(int vid)
 {
+	struct pmd_internal_shared *shared = pmd_internal_shared;
 	struct pmd_internal *internal;
-	int i;
+	struct pmd_internal *found = NULL;
+	uint32_t hash;
+	uint16_t i;
 	char ifname[PATH_MAX];
 
 	if (rte_vhost_get_ifname(vid, ifname, sizeof(ifname)) == -1)
 		return NULL;
 
-	/* likely(found in a few loops) */
-	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
-		internal = pmd_internal_list[i];
-		if (internal != NULL && !strcmp(internal->iface_name, ifname)) {
-			return internal;
+	hash = get_iface_hash(ifname);
+	rte_spinlock_lock(&shared->lock);
+	for (i = shared->iface_heads[hash % IFACE_IDX_BUCKETS]; i != 0;
+			i = shared->iface_next[i - 1]) {
+		internal = shared->list[i - 1];
+		if (internal != NULL && shared->iface_hash[i - 1] == hash &&
+				!strcmp(internal->iface_name, ifname)) {
+			found = internal;
+			break;
 		}
 	}
+	rte_spinlock_unlock(&shared->lock);
 
-	return NULL;
+	return found;
 }
 
 static int
@@ -386,21 +463,25 @@ static int
 init_shared_data(void)
 {
 	const struct rte_memzone *mz;
+	struct pmd_internal_shared *shared;
 
-	if (pmd_internal_list == NULL) {
+	if (pmd_internal_shared == NULL) {
 		if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
-			size_t len = sizeof(*pmd_internal_list) * RTE_MAX_ETHPORTS;
+			size_t len = sizeof(*pmd_internal_shared);
 			mz = rte_memzone_reserve(MZ_RTE_VHOST_PMD_INTERNAL,
 					len, rte_socket_id(), 0);
-			if (mz)
-				memset(mz->addr, 0, len);
+			if (mz) {
+				shared = mz->addr;
+				memset(shared, 0, len);
+				rte_spinlock_init(&shared->lock);
+			}
 		} else
 			mz = rte_memzone_lookup(MZ_RTE_VHOST_PMD_INTERNAL);
 		if (mz == NULL) {
 			VHOST_LOG(ERR, "Cannot allocate vhost shared data\n");
 			return -1;
 		}
-		pmd_internal_list = mz->addr;
+		pmd_internal_shared = mz->addr;
 	}
 
 	return 0;
@@ -444,7 +525,7 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	internal->eth_dev_data = data;
 	strncpy(internal->iface_name, iface_name, sizeof(internal->iface_name));
 
-	pmd_internal_list[data->port_id] = internal;
+	register_internal(data->port_id, internal);
 
 	rte_eth_dev_probing_finish(eth_dev);
 
@@ -568,7 +649,7 @@ rte_pmd_vhost_remove(struct rte_vdev_device *dev)
 	for (i = 0; i < eth_dev->data->nb_tx_queues; i++)
 		rte_free(eth_dev->data->tx_queues[i]);
 
-	pmd_internal_list[eth_dev->data->port_id] = NULL;
+	unregister_internal(eth_dev->data->port_id);
 
 	return rte_eth_dev_release_port(eth_dev);
 }
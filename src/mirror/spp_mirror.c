@@ -8,6 +8,7 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_pause.h>
 
 #include "spp_mirror.h"
 #include "shared/secondary/common.h"
@@ -19,6 +20,7 @@
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/shm_stats.h"
 
 #ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
@@ -40,13 +42,19 @@ enum SPP_LONGOPT_RETVAL {
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT,  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_TX_POLICY  /* For `--tx-policy` */
 };
 
+/* Num of TX ports of mirror, for original and mirrored packets. */
+#define MIR_NOF_TX 2
+
 /* A set of port info of rx and tx */
 struct mirror_rxtx {
 	struct sppwk_port_info rx; /* rx port */
 	struct sppwk_port_info tx; /* tx port */
+	enum tx_policy tx_policy;  /* TX policy of tx port */
+	uint64_t retry_tsc;  /* Budget of retrying TX in TSC */
 };
 
 /* Information on the path used for mirror. */
@@ -58,12 +66,26 @@ struct mirror_path {
 	struct mirror_rxtx ports[RTE_MAX_ETHPORTS];  /* used for mirror */
 };
 
+/**
+ * Packets held for TX_POLICY_HOLD to be sent on the next poll. It is kept
+ * over updates of mirror_path, and the destination is also kept to drop
+ * held packets if TX port is changed.
+ */
+struct mirror_hold {
+	int ethdev_port_id;
+	int queue_no;
+	uint16_t nof_pkts;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+};
+
 /* Information for mirror. */
 struct mirror_info {
 	volatile int ref_index; /* index to reference area */
 	volatile int upd_index; /* index to update area    */
 	struct mirror_path path[TWO_SIDES];
 				/* Information of data path */
+	struct mirror_hold hold[MIR_NOF_TX];  /* Held packets of TX ports */
+	struct stats stats;  /* Counters of packets in RX and TX */
 };
 
 static uint16_t nb_rxd = MIR_RX_DESC_DEFAULT;
@@ -100,11 +122,15 @@ usage(const char *progname)
 	RTE_LOG(INFO, MIRROR, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--tx-policy POLICY]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  : "
 				"Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --tx-policy POLICY        :"
+			" Policy of packets not accepted by TX queue,"
+			" such as `retry:20,ring:0=hold`\n"
 			, progname);
 }
 
@@ -131,6 +157,8 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "tx-policy", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TX_POLICY },
 			{ 0 },
 	};
 
@@ -162,6 +190,12 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_TX_POLICY:
+			if (parse_tx_policy_opt(optarg) != SPPWK_RET_OK) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			if (ret != SPPWK_RET_OK) {
@@ -246,6 +280,7 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	int cnt = 0;
 	int nof_rx = wk_comp->nof_rx;
 	int nof_tx = wk_comp->nof_tx;
+	struct tx_policy_conf tx_conf;
 	struct mirror_info *info = &g_mirror_info[wk_comp->comp_id];
 	struct mirror_path *path = &info->path[info->upd_index];
 
@@ -256,7 +291,7 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 			wk_comp->comp_id, wk_comp->wk_type, nof_rx);
 		return SPPWK_RET_NG;
 	}
-	if (unlikely(nof_tx > 2)) {
+	if (unlikely(nof_tx > MIR_NOF_TX)) {
 		RTE_LOG(ERR, MIRROR,
 			"Invalid num of TX (id=%d, type=%d, nof_tx=%d)\n",
 			wk_comp->comp_id, wk_comp->wk_type, nof_tx);
@@ -278,10 +313,19 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 				sizeof(struct sppwk_port_info));
 
 	/* Transmit port is set according with larger nof_rx / nof_tx. */
-	for (cnt = 0; cnt < nof_tx; cnt++)
+	for (cnt = 0; cnt < nof_tx; cnt++) {
 		memcpy(&path->ports[cnt].tx, wk_comp->tx_ports[cnt],
 				sizeof(struct sppwk_port_info));
 
+		get_tx_policy(wk_comp->tx_ports[cnt]->iface_type,
+				wk_comp->tx_ports[cnt]->iface_no, &tx_conf);
+		path->ports[cnt].tx_policy = tx_conf.policy;
+		if (tx_conf.policy == TX_POLICY_RETRY)
+			path->ports[cnt].retry_tsc =
+					(rte_get_tsc_hz() + US_PER_S - 1) /
+					US_PER_S * tx_conf.retry_us;
+	}
+
 	info->upd_index = info->ref_index;
 	while (likely(info->ref_index == info->upd_index))
 		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
@@ -305,6 +349,136 @@ change_mirror_index(int id)
 	}
 }
 
+/* Send packets to TX port. */
+static inline uint16_t
+send_packets(struct sppwk_port_info *tx, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+#ifdef SPP_RINGLATENCYSTATS_ENABLE
+	return sppwk_eth_ring_stats_tx_burst(tx->ethdev_port_id,
+			tx->iface_type, tx->iface_no, 0, bufs, nb_pkts);
+#else
+	return rte_eth_tx_burst(tx->ethdev_port_id, tx->queue_no, bufs,
+			nb_pkts);
+#endif
+}
+
+/* Send packets, and retry to send the rest until `retry_tsc` is passed. */
+static inline uint16_t
+send_packets_retry(struct sppwk_port_info *tx, struct rte_mbuf **bufs,
+		uint16_t nb_pkts, uint64_t retry_tsc)
+{
+	uint16_t nb_tx;
+	uint64_t start_tsc;
+
+	nb_tx = send_packets(tx, bufs, nb_pkts);
+	if (likely(nb_tx == nb_pkts) || retry_tsc == 0)
+		return nb_tx;
+
+	start_tsc = rte_rdtsc();
+	do {
+		rte_pause();
+		nb_tx += send_packets(tx, &bufs[nb_tx], nb_pkts - nb_tx);
+	} while (nb_tx < nb_pkts && rte_rdtsc() - start_tsc < retry_tsc);
+
+	return nb_tx;
+}
+
+/* Discard packets to release mbuf, and count them for the TX policy. */
+static inline void
+drop_packets(struct stats *stats, enum tx_policy tx_policy,
+		struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	uint16_t buf;
+
+	count_tx_drop(stats, tx_policy, nb_pkts);
+	for (buf = 0; buf < nb_pkts; buf++)
+		rte_pktmbuf_free(bufs[buf]);
+}
+
+/* Hold packets to be sent on the next poll, or drop them if no room. */
+static inline void
+hold_packets(struct mirror_info *info, struct mirror_hold *hold,
+		struct sppwk_port_info *tx, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+	uint16_t nb_hold = RTE_MIN(nb_pkts,
+			(uint16_t)(MAX_PKT_BURST - hold->nof_pkts));
+
+	if (hold->nof_pkts == 0) {
+		hold->ethdev_port_id = tx->ethdev_port_id;
+		hold->queue_no = tx->queue_no;
+	}
+
+	memcpy(&hold->pkts[hold->nof_pkts], bufs,
+			sizeof(struct rte_mbuf *) * nb_hold);
+	hold->nof_pkts += nb_hold;
+
+	if (unlikely(nb_hold < nb_pkts))
+		drop_packets(&info->stats, TX_POLICY_HOLD, &bufs[nb_hold],
+				nb_pkts - nb_hold);
+}
+
+/**
+ * Send packets held on the previous poll. Packets which cannot be sent are
+ * kept, or dropped if TX port or TX policy is changed.
+ */
+static inline void
+send_held_packets(struct mirror_info *info, struct mirror_hold *hold,
+		struct mirror_rxtx *port)
+{
+	uint16_t nb_tx;
+	struct sppwk_port_info *tx = &port->tx;
+
+	if (unlikely(port->tx_policy != TX_POLICY_HOLD ||
+			hold->ethdev_port_id != tx->ethdev_port_id ||
+			hold->queue_no != tx->queue_no)) {
+		drop_packets(&info->stats, TX_POLICY_HOLD, hold->pkts,
+				hold->nof_pkts);
+		hold->nof_pkts = 0;
+		return;
+	}
+
+	nb_tx = send_packets(tx, hold->pkts, hold->nof_pkts);
+	info->stats.tx += nb_tx;
+	hold->nof_pkts -= nb_tx;
+	if (hold->nof_pkts > 0 && nb_tx > 0)
+		memmove(hold->pkts, &hold->pkts[nb_tx],
+				sizeof(struct rte_mbuf *) * hold->nof_pkts);
+}
+
+/**
+ * Send packets to TX port of given port set, and retry, hold or discard
+ * packets which cannot be sent according to its TX policy.
+ */
+static inline void
+send_mirror_packets(struct mirror_info *info, struct mirror_hold *hold,
+		struct mirror_rxtx *port, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+	uint16_t nb_tx = 0;
+	struct sppwk_port_info *tx = &port->tx;
+
+	/* Keep order of packets behind held ones. */
+	if (unlikely(hold->nof_pkts > 0)) {
+		hold_packets(info, hold, tx, bufs, nb_pkts);
+		return;
+	}
+
+	if (tx->ethdev_port_id >= 0)
+		nb_tx = send_packets_retry(tx, bufs, nb_pkts,
+				port->retry_tsc);
+	info->stats.tx += nb_tx;
+	if (likely(nb_tx == nb_pkts))
+		return;
+
+	if (port->tx_policy == TX_POLICY_HOLD && tx->ethdev_port_id >= 0)
+		hold_packets(info, hold, tx, &bufs[nb_tx], nb_pkts - nb_tx);
+	else  /* Discard remained packets to release mbuf */
+		drop_packets(&info->stats, port->tx_policy, &bufs[nb_tx],
+				nb_pkts - nb_tx);
+}
+
 /**
  * Mirroring packets as mirror_proc
  *
@@ -314,11 +488,8 @@ change_mirror_index(int id)
 static int
 mirror_proc(int id)
 {
-	int cnt, buf;
-	int nb_rx = 0;
-	int nb_tx = 0;
-	int nb_tx1 = 0;
-	int nb_tx2 = 0;
+	int cnt;
+	uint16_t nb_rx = 0;
 	struct mirror_info *info = &g_mirror_info[id];
 	struct mirror_path *path = NULL;
 	struct sppwk_port_info *rx = NULL;
@@ -331,9 +502,16 @@ mirror_proc(int id)
 	path = &info->path[info->ref_index];
 
 	/* Practice condition check */
-	if (!(path->nof_tx == 2 && path->nof_rx == 1))
+	if (!(path->nof_tx == MIR_NOF_TX && path->nof_rx == 1))
 		return SPPWK_RET_OK;
 
+	/* Send packets held on the previous poll before new ones. */
+	for (cnt = 0; cnt < MIR_NOF_TX; cnt++) {
+		if (unlikely(info->hold[cnt].nof_pkts > 0))
+			send_held_packets(info, &info->hold[cnt],
+					&path->ports[cnt]);
+	}
+
 	rx = &path->ports[0].rx;
 
 #ifdef SPP_RINGLATENCYSTATS_ENABLE
@@ -346,11 +524,11 @@ mirror_proc(int id)
 
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
+	info->stats.rx += nb_rx;
 
 	/* mirror */
 	tx = &path->ports[1].tx;
 	if (tx->ethdev_port_id >= 0) {
-		nb_tx2 = 0;
 		for (cnt = 0; cnt < nb_rx; cnt++) {
 			org_mbuf = bufs[cnt];
 			rte_prefetch0(rte_pktmbuf_mtod(org_mbuf, void *));
@@ -398,46 +576,52 @@ mirror_proc(int id)
 #endif /* SPP_MIRROR_SHALLOWCOPY */
 		}
 
-		if (cnt != 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx2 = sppwk_eth_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, copybufs, cnt);
-#else
-			nb_tx2 = rte_eth_tx_burst(tx->ethdev_port_id,
-					tx->queue_no, copybufs, cnt);
-#endif
+		send_mirror_packets(info, &info->hold[1], &path->ports[1],
+				copybufs, cnt);
 	}
 
 	/* orginal */
-	tx = &path->ports[0].tx;
-	if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		nb_tx1 = sppwk_eth_ring_stats_tx_burst(tx->ethdev_port_id,
-				tx->iface_type, tx->iface_no, 0, bufs, nb_rx);
-#else
-		nb_tx1 = rte_eth_tx_burst(tx->ethdev_port_id, tx->queue_no,
-				bufs, nb_rx);
-#endif
-	nb_tx = nb_tx1;
+	send_mirror_packets(info, &info->hold[0], &path->ports[0], bufs,
+			nb_rx);
+	return SPPWK_RET_OK;
+}
 
-	if (nb_tx1 != nb_tx2)
-		RTE_LOG(INFO, MIRROR,
-			"mirror paket drop nb_rx=%d nb_tx1=%d nb_tx2=%d\n",
-							nb_rx, nb_tx1, nb_tx2);
-
-	/* Discard remained packets to release mbuf */
-	if (nb_tx1 < nb_tx2)
-		nb_tx = nb_tx2;
-	if (unlikely(nb_tx < nb_rx)) {
-		for (buf = nb_tx; buf < nb_rx; buf++)
-			rte_pktmbuf_free(bufs[buf]);
-	}
-	if (unlikely(nb_tx2 < nb_rx)) {
-		for (buf = nb_tx2; buf < nb_rx; buf++)
-			rte_pktmbuf_free(copybufs[buf]);
+/* Fill counters of components and its lcores to the stats segment. */
+static void
+collect_mirror_stats(struct shm_stats *st)
+{
+	int cnt;
+	unsigned int lcore_id;
+	struct sppwk_comp_info *comp;
+	struct shm_comp_stats *shm_comp;
+	struct shm_lcore_stats *shm_lcores[RTE_MAX_LCORE] = { NULL };
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		comp = &g_component_info[cnt];
+		if (comp->wk_type != SPPWK_TYPE_MIR)
+			continue;
+
+		shm_comp = &st->comps[st->nof_comps++];
+		snprintf(shm_comp->name, sizeof(shm_comp->name), "%s",
+				comp->name);
+		snprintf(shm_comp->type, sizeof(shm_comp->type), "%s",
+				SPPWK_TYPE_MIR_STR);
+		shm_comp->lcore_id = comp->lcore_id;
+		shm_comp->stats = g_mirror_info[cnt].stats;
+
+		/* Sum up components on the same lcore. */
+		lcore_id = comp->lcore_id;
+		if (lcore_id >= RTE_MAX_LCORE)
+			continue;
+		if (shm_lcores[lcore_id] == NULL) {
+			shm_lcores[lcore_id] = &st->lcores[st->nof_lcores++];
+			memset(shm_lcores[lcore_id], 0,
+					sizeof(struct shm_lcore_stats));
+			shm_lcores[lcore_id]->lcore_id = lcore_id;
+		}
+		add_stats(&shm_lcores[lcore_id]->stats,
+				&g_mirror_info[cnt].stats);
 	}
-	return SPPWK_RET_OK;
 }
 
 /* Main process of slave core */
@@ -615,6 +799,9 @@ main(int argc, char *argv[])
 		/* Backup the management information after initialization */
 		backup_mng_info(&g_backup_info);
 
+		/* Counters are published from this thread not to race cmds. */
+		shm_stats_init("mirror", get_client_id(), collect_mirror_stats);
+
 		/* Enter loop for accepting commands */
 		int ret_do = 0;
 		while (likely(g_core_info[master_lcore].status !=
@@ -624,6 +811,8 @@ main(int argc, char *argv[])
 			ret_do = sppwk_run_cmd();
 			if (unlikely(ret_do != SPPWK_RET_OK))
 				break;
+
+			shm_stats_update_periodic();
 			/*
 			 * To avoid making CPU busy, this thread waits
 			 * here for 100 ms.
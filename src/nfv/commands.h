@@ -6,6 +6,9 @@
 #ifndef _NFV_COMMANDS_H_
 #define _NFV_COMMANDS_H_
 
+#include <errno.h>
+
+#include "shared/json_writer.h"
 #include "shared/secondary/common.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
@@ -19,43 +22,45 @@
 static int
 do_del(char *p_type, int p_id, uint16_t queue_id)
 {
-	uint16_t port_id = PORT_RESET;
+	enum port_type type = get_port_type(p_type);
+	uint16_t port_id;
+
+	switch (type) {
+	case VHOST:
+	case RING:
+	case PCAP:
+	case MEMIF:
+	case NULLPMD:
+		break;
+	default:
+		return -1;
+	}
 
-	if (!strcmp(p_type, "vhost")) {
-		port_id = find_port_id(p_id, VHOST);
-		if (port_id == PORT_RESET)
-			return -1;
+	port_id = find_port_id(p_id, type);
+	if (port_id == PORT_RESET)
+		return -1;
+
+	/*
+	 * Remove patches of the port before stopping it. Forwarding lcores do
+	 * not refer the port after returned, so that other ports are kept
+	 * forwarding while deleting.
+	 */
+	forward_array_remove(port_id, queue_id);
+
+	switch (type) {
+	case VHOST:
 		rte_eth_dev_stop(port_id);
 		dev_detach_by_port_id(port_id);
-
-	} else if (!strcmp(p_type, "ring")) {
-		port_id = find_port_id(p_id, RING);
-		if (port_id == PORT_RESET)
-			return -1;
+		break;
+	case RING:
 		rte_eth_dev_stop(port_id);
 		rte_eth_dev_close(port_id);
-
-	} else if (!strcmp(p_type, "pcap")) {
-		port_id = find_port_id(p_id, PCAP);
-		if (port_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(port_id);
-
-	} else if (!strcmp(p_type, "memif")) {
-		port_id = find_port_id(p_id, MEMIF);
-		if (port_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(port_id);
-
-	} else if (!strcmp(p_type, "nullpmd")) {
-		port_id = find_port_id(p_id, NULLPMD);
-		if (port_id == PORT_RESET)
-			return -1;
+		break;
+	default:
 		dev_detach_by_port_id(port_id);
-
+		break;
 	}
 
-	forward_array_remove(port_id, queue_id);
 	port_map_init_one(port_id);
 
 	return 0;
@@ -97,13 +102,14 @@ do_add(char *p_type, int p_id, uint16_t queue_id)
 		return -1;
 
 	port_id = (uint16_t) res;
-	port_map[port_id].id = p_id;
-	port_map[port_id].port_type = type;
-	if (type == RING)
-		port_map[port_id].stats = &ports->client_stats[p_id];
-	/* NOTE: port_map[].stats points to &port_map[].default_stats
-	 * other than RING. There is no support to show/clear this stats
-	 * at the moment.
+	set_port_map_id(port_id, type, p_id);
+	get_tx_policy(type, p_id, &port_map[port_id].tx_conf);
+	if (type == RING) {
+		port_map[port_id].stats_type = STATS_CLIENT;
+		port_map[port_id].stats_idx = p_id;
+	}
+	/* NOTE: Counters of ports other than RING are not shared with
+	 * primary, and only shown in status of this process.
 	 */
 	port_map[port_id].queue_info = NULL;
 
@@ -114,6 +120,124 @@ do_add(char *p_type, int p_id, uint16_t queue_id)
 	return 0;
 }
 
+/* Find a destination of fan-out patch given as a resource UID. */
+static int
+parse_fanout_dst(char *res_uid, struct fanout_dst *dst)
+{
+	char *p_type;
+	int p_id;
+	uint16_t queue_id;
+	uint16_t out_port;
+	char uid[32];
+
+	/* Keep given UID for logging because it is tokenized in parsing. */
+	memset(uid, '\0', sizeof(uid));
+	strncpy(uid, res_uid, sizeof(uid) - 1);
+
+	if (parse_resource_uid(res_uid, &p_type, &p_id, &queue_id) < 0)
+		return -1;
+
+	out_port = find_port_id(p_id, get_port_type(p_type));
+	if (out_port == PORT_RESET) {
+		RTE_LOG(ERR, SPP_NFV, "Patch not found, fanout '%s'\n", uid);
+		return -1;
+	}
+
+	if (!is_valid_port(out_port, queue_id) ||
+			!is_valid_port_txq(out_port, queue_id)) {
+		RTE_LOG(ERR, SPP_NFV, "Invalid queue of fanout '%s'\n", uid);
+		return -1;
+	}
+
+	dst->port_id = out_port;
+	dst->queue_id = queue_id;
+	return 0;
+}
+
+/**
+ * Parse options of `patch` command following src and dst ports. Options are
+ * given as pairs of name and value, and all of them are validated before
+ * the patch is added.
+ *
+ *   patch phy:0 ring:0 burst 32 drain 100
+ *   patch phy:0 ring:0 fanout ring:1 fanout ring:2 mode hash
+ *
+ * `burst` is the num of packets buffered before sent, and `drain` is the
+ * interval in micro sec of sending buffered packets. `fanout` is an
+ * additional destination to which the same packets are sent. If `mode` is
+ * `hash`, each of packets is sent to one of destinations selected by hash
+ * of its flow instead.
+ */
+static int
+parse_patch_opts(char **token_list, int max_token, struct patch_opts *opts)
+{
+	int i;
+	int val;
+
+	memset(opts, 0, sizeof(*opts));
+	opts->drain_us = DEFAULT_DRAIN_US;
+
+	for (i = 3; i < max_token; i += 2) {
+		if (i + 1 >= max_token) {
+			RTE_LOG(ERR, SPP_NFV, "No value of '%s'\n",
+					token_list[i]);
+			return -1;
+		}
+
+		if (!strcmp(token_list[i], "fanout")) {
+			if (opts->nof_fanout >= MAX_PATCH_DSTS - 1) {
+				RTE_LOG(ERR, SPP_NFV,
+					"Too many fanout destinations\n");
+				return -1;
+			}
+			if (parse_fanout_dst(token_list[i + 1],
+					&opts->fanout[opts->nof_fanout]) < 0)
+				return -1;
+			opts->nof_fanout++;
+			continue;
+		}
+
+		if (!strcmp(token_list[i], "mode")) {
+			if (!strcmp(token_list[i + 1], "copy")) {
+				opts->mode = PATCH_MODE_COPY;
+			} else if (!strcmp(token_list[i + 1], "hash")) {
+				opts->mode = PATCH_MODE_HASH;
+			} else {
+				RTE_LOG(ERR, SPP_NFV, "Invalid mode '%s'\n",
+						token_list[i + 1]);
+				return -1;
+			}
+			opts->has_mode = 1;
+			continue;
+		}
+
+		if (spp_atoi(token_list[i + 1], &val) < 0 || val < 0) {
+			RTE_LOG(ERR, SPP_NFV, "Invalid value of '%s'\n",
+					token_list[i]);
+			return -1;
+		}
+
+		if (!strcmp(token_list[i], "burst")) {
+			if (val > MAX_PKT_BURST) {
+				RTE_LOG(ERR, SPP_NFV,
+					"burst exceeds %d\n", MAX_PKT_BURST);
+				return -1;
+			}
+			opts->tx_burst = (uint16_t)val;
+			opts->has_tx_buf = 1;
+		} else if (!strcmp(token_list[i], "drain")) {
+			opts->drain_us = (unsigned int)val;
+			opts->has_tx_buf = 1;
+		} else {
+			RTE_LOG(ERR, SPP_NFV, "Unknown patch option '%s'\n",
+					token_list[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static int
 do_connection(int *connected, int *sock)
 {
@@ -154,7 +278,7 @@ do_connection(int *connected, int *sock)
 
 /* Return -1 if exit command is called to terminate the process */
 static int
-parse_command(char *str)
+parse_command(char *str, struct json_writer *res)
 {
 	uint16_t dev_id;
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
@@ -162,12 +286,12 @@ parse_command(char *str)
 	int cli_id;
 	int max_token = 0;
 	int ret = 0;
-	char result[16] = { 0 };  /* succeeded or failed. */
-	char port_set[128] = { 0 };
+	const char *result;  /* succeeded or failed. */
 	char *p_type;
 	int p_id;
 	uint16_t queue_id;
 
+	jw_reset(res);
 	if (!str)
 		return 0;
 
@@ -185,12 +309,11 @@ parse_command(char *str)
 
 	if (!strcmp(token_list[0], "status")) {
 		RTE_LOG(DEBUG, SPP_NFV, "status\n");
-		memset(str, '\0', MSG_SIZE);
 		if (cmd == FORWARD)
-			get_sec_stats_json(str, get_client_id(), "running",
+			get_sec_stats_json(res, get_client_id(), "running",
 					lcore_id_used);
 		else
-			get_sec_stats_json(str, get_client_id(), "idling",
+			get_sec_stats_json(res, get_client_id(), "idling",
 					lcore_id_used);
 
 		RTE_ETH_FOREACH_DEV(dev_id) {
@@ -201,47 +324,66 @@ parse_command(char *str)
 		}
 
 	} else if (!strcmp(token_list[0], "_get_client_id")) {
-		memset(str, '\0', MSG_SIZE);
 		/**
 		 * TODO(yasufum) revise result msg. 1) need both of `results`
 		 * and `result`. 2) change `success` to `succeeded`.
 		 */
-		sprintf(str, "{%s:%s,%s:%d,%s:%s}",
-				"\"results\"", "[{\"result\":\"success\"}]",
-				"\"client_id\"", get_client_id(),
-				"\"process_type\"", "\"nfv\"");
+		jw_obj_begin(res, NULL);
+		jw_arr_begin(res, "results");
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", "success");
+		jw_obj_end(res);
+		jw_arr_end(res);
+		jw_int(res, "client_id", get_client_id());
+		jw_str(res, "process_type", "nfv");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "_set_client_id")) {
 		if (spp_atoi(token_list[1], &cli_id) >= 0) {
 			set_client_id(cli_id);
-			sprintf(result, "%s", "\"succeeded\"");
+			result = "succeeded";
 		} else
-			sprintf(result, "%s", "\"failed\"");
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"_set_client_id\"");
+			result = "failed";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "_set_client_id");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "exit")) {
 		RTE_LOG(DEBUG, SPP_NFV, "exit\n");
 		cmd = STOP;
 		ret = -1;
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"exit\"");
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", "succeeded");
+		jw_str(res, "command", "exit");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "stop")) {
 		RTE_LOG(DEBUG, SPP_NFV, "stop\n");
 		cmd = STOP;
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"stop\"");
+		if (wait_fwd_lcores(STOP) < 0)
+			result = "failed";
+		else
+			result = "succeeded";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "stop");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "forward")) {
 		RTE_LOG(DEBUG, SPP_NFV, "forward\n");
 		cmd = FORWARD;
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"forward\"");
+		if (wait_fwd_lcores(FORWARD) < 0)
+			result = "failed";
+		else
+			result = "succeeded";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "forward");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "add")) {
 		RTE_LOG(DEBUG, SPP_NFV, "Received add command\n");
@@ -253,16 +395,15 @@ parse_command(char *str)
 
 		if (do_add(p_type, p_id, queue_id) < 0) {
 			RTE_LOG(ERR, SPP_NFV, "Failed to do_add()\n");
-			sprintf(result, "%s", "\"failed\"");
+			result = "failed";
 		} else
-			sprintf(result, "%s", "\"succeeded\"");
+			result = "succeeded";
 
-		sprintf(port_set, "\"%s:%d\"", p_type, p_id);
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"add\"",
-				"\"port\"", port_set);
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "add");
+		jw_strf(res, "port", "%s:%d", p_type, p_id);
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "patch")) {
 		RTE_LOG(DEBUG, SPP_NFV, "patch\n");
@@ -273,6 +414,11 @@ parse_command(char *str)
 		if (strncmp(token_list[1], "reset", 5) == 0) {
 			/* reset forward array*/
 			forward_array_reset();
+
+			jw_obj_begin(res, NULL);
+			jw_str(res, "result", "succeeded");
+			jw_str(res, "command", "patch");
+			jw_obj_end(res);
 		} else {
 			uint16_t in_port;
 			uint16_t out_port;
@@ -285,6 +431,7 @@ parse_command(char *str)
 			int in_p_id;
 			int out_p_id;
 			uint16_t in_queue_id, out_queue_id;
+			struct patch_opts opts;
 			int res_uid_str_size = 32;
 			char in_res_uid[res_uid_str_size];
 			char out_res_uid[res_uid_str_size];
@@ -342,26 +489,32 @@ parse_command(char *str)
 					__func__, __LINE__);
 			}
 
-			if (add_patch(in_port, in_queue_id, out_port,
-				out_queue_id) == 0) {
+			/*
+			 * The patch and its options are published at once, and
+			 * a failed command does not change the patch.
+			 */
+			if (parse_patch_opts(token_list, max_token,
+					&opts) < 0 ||
+					add_patch_with_opts(in_port,
+					in_queue_id, out_port, out_queue_id,
+					&opts) < 0) {
+				RTE_LOG(ERR, SPP_NFV, "Failed to patch\n");
+				result = "failed";
+			} else {
 				RTE_LOG(INFO, SPP_NFV,
 					"Patched '%s' and '%s'\n",
 					in_res_uid, out_res_uid);
-				sprintf(result, "%s", "\"succeeded\"");
-			} else {
-				RTE_LOG(ERR, SPP_NFV, "Failed to patch\n");
-				sprintf(result, "%s", "\"failed\"");
+				result = "succeeded";
 			}
 
-			sprintf(port_set,
-				"{\"src\":\"%s\",\"dst\":\"%s\"}",
-				in_res_uid, out_res_uid);
-
-			memset(str, '\0', MSG_SIZE);
-			sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-					"\"result\"", result,
-					"\"command\"", "\"patch\"",
-					"\"ports\"", port_set);
+			jw_obj_begin(res, NULL);
+			jw_str(res, "result", result);
+			jw_str(res, "command", "patch");
+			jw_obj_begin(res, "ports");
+			jw_str(res, "src", in_res_uid);
+			jw_str(res, "dst", out_res_uid);
+			jw_obj_end(res);
+			jw_obj_end(res);
 
 			ret = 0;
 		}
@@ -369,8 +522,6 @@ parse_command(char *str)
 	} else if (!strcmp(token_list[0], "del")) {
 		RTE_LOG(DEBUG, SPP_NFV, "Received del command\n");
 
-		cmd = STOP;
-
 		ret = parse_resource_uid(token_list[1], &p_type, &p_id,
 				&queue_id);
 		if (ret < 0)
@@ -378,16 +529,15 @@ parse_command(char *str)
 
 		if (do_del(p_type, p_id, queue_id) < 0) {
 			RTE_LOG(ERR, SPP_NFV, "Failed to do_del()\n");
-			sprintf(result, "%s", "\"failed\"");
+			result = "failed";
 		} else
-			sprintf(result, "%s", "\"succeeded\"");
-
-		sprintf(port_set, "\"%s:%d\"", p_type, p_id);
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"del\"",
-				"\"port\"", port_set);
+			result = "succeeded";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "del");
+		jw_strf(res, "port", "%s:%d", p_type, p_id);
+		jw_obj_end(res);
 	}
 
 	return ret;
@@ -419,18 +569,33 @@ do_receive(int *connected, int *sock, char *str)
 }
 
 static int
-do_send(int *connected, int *sock, char *str)
+do_send(int *connected, int *sock, const struct json_writer *res)
 {
-	int ret;
-
-	ret = send(*sock, str, MSG_SIZE, 0);
-	if (ret == -1) {
-		RTE_LOG(ERR, SPP_NFV, "send failed");
-		*connected = 0;
-		return -1;
+	/* Reply even if no message is made not to block spp-ctl. */
+	static const char err_msg[] = "{\"result\":\"failed\"}";
+	const char *msg = err_msg;
+	size_t len = sizeof(err_msg) - 1;
+	ssize_t ret;
+
+	if (jw_error(res) == 0 && res->len > 0) {
+		msg = res->str;
+		len = res->len;
 	}
 
-	RTE_LOG(INFO, SPP_NFV, "To Server: %s\n", str);
+	RTE_LOG(INFO, SPP_NFV, "To Server: %s\n", msg);
+
+	while (len > 0) {
+		ret = send(*sock, msg, len, 0);
+		if (ret == -1) {
+			if (errno == EINTR)
+				continue;
+			RTE_LOG(ERR, SPP_NFV, "send failed");
+			*connected = 0;
+			return -1;
+		}
+		msg += ret;
+		len -= ret;
+	}
 
 	return 0;
 }
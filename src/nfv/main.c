@@ -38,10 +38,14 @@ uint8_t lcore_id_used[RTE_MAX_LCORE] = {};
 enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_ENABLE_VHOST_CLI,
+	CMD_OPT_TX_POLICY,
+	CMD_OPT_IDLE,
 };
 
 static struct option lgopts[] = {
 	{"vhost-client", no_argument, NULL, CMD_OPT_ENABLE_VHOST_CLI},
+	{"tx-policy", required_argument, NULL, CMD_OPT_TX_POLICY},
+	{"idle", required_argument, NULL, CMD_OPT_IDLE},
 	{0}
 };
 
@@ -52,9 +56,10 @@ static void
 usage(const char *progname)
 {
 	RTE_LOG(INFO, SPP_NFV,
-		"Usage: %s [EAL args] -- %s %s %s\n\n",
+		"Usage: %s [EAL args] -- %s %s %s %s %s\n\n",
 		progname, "-n <client_id>", "-s <ipaddr:port>",
-		"--vhost-client");
+		"--vhost-client", "--tx-policy <policy>",
+		"--idle <pause_polls[,yield_polls[,sleep_us]]>");
 }
 
 /*
@@ -80,6 +85,18 @@ parse_app_args(int argc, char *argv[])
 		case CMD_OPT_ENABLE_VHOST_CLI:
 			set_vhost_cli_mode(1);
 			break;
+		case CMD_OPT_TX_POLICY:
+			if (parse_tx_policy_opt(optarg) != 0) {
+				usage(progname);
+				return -1;
+			}
+			break;
+		case CMD_OPT_IDLE:
+			if (parse_idle_opt(optarg) != 0) {
+				usage(progname);
+				return -1;
+			}
+			break;
 		case 'n':
 			if (parse_client_id(&cli_id, optarg) != 0) {
 				usage(progname);
@@ -113,15 +130,7 @@ nfv_loop(void)
 
 	RTE_LOG(INFO, SPP_NFV, "entering main loop on lcore %u\n", lcore_id);
 
-	while (1) {
-		if (unlikely(cmd == STOP)) {
-			sleep(1);
-			/*RTE_LOG(INFO, SPP_NFV, "Idling\n");*/
-			continue;
-		} else if (cmd == FORWARD) {
-			forward();
-		}
-	}
+	fwd_lcore_loop(&cmd);
 }
 
 /* leading to nfv processing loop */
@@ -132,6 +141,14 @@ main_loop(void *dummy __rte_unused)
 	return 0;
 }
 
+/* Fill counters of ports and forwarding lcores to the stats segment. */
+static void
+collect_nfv_stats(struct shm_stats *st)
+{
+	collect_port_map_stats(st);
+	collect_fwd_lcore_stats(st);
+}
+
 /*
  * Application main function - loops through
  * receiving and processing packets. Never returns
@@ -145,6 +162,7 @@ main(int argc, char *argv[])
 	unsigned int nb_ports;
 	int connected = 0;
 	char str[MSG_SIZE] = { 0 };
+	struct json_writer res;
 	unsigned int i, j;
 	int flg_exit;  // used as res of parse_command() to exit if -1
 	int ret;
@@ -170,6 +188,9 @@ main(int argc, char *argv[])
 	/* initialize port forward array*/
 	forward_array_init();
 	port_map_init();
+	fwd_lcores_init();
+	if (init_lcore_patches() < 0)
+		rte_exit(EXIT_FAILURE, "Cannot allocate patches of lcores\n");
 
 	/* Check that there is an even number of ports to send/receive on. */
 	nb_ports = rte_eth_dev_count_avail();
@@ -219,9 +240,10 @@ main(int argc, char *argv[])
 		 * not display to avoid confusion.
 		 */
 
-		port_map[i].port_type = port_type;
-		port_map[i].id = port_id;
-		port_map[i].stats = &ports->port_stats[i];
+		set_port_map_id(i, port_type, port_id);
+		port_map[i].stats_type = STATS_PORT;
+		port_map[i].stats_idx = i;
+		get_tx_policy(port_type, port_id, &port_map[i].tx_conf);
 		port_map[i].queue_info = &ports->queue_info[i];
 
 		/* Update ports_fwd_array with phy port. */
@@ -258,10 +280,16 @@ main(int argc, char *argv[])
 		rte_eal_remote_launch(main_loop, NULL, lcore_id);
 	}
 
+	/* Publish counters to be read without `status` command. */
+	if (shm_stats_init("nfv", get_client_id(), collect_nfv_stats) == 0)
+		shm_stats_start_thread();
+
 	RTE_LOG(INFO, SPP_NFV, "My ID %d start handling message\n",
 			get_client_id());
 	RTE_LOG(INFO, SPP_NFV, "[Press Ctrl-C to quit ...]\n");
 
+	jw_init(&res);
+
 	/* send and receive msg loop */
 	while (on) {
 		ret = do_connection(&connected, &sock);
@@ -276,10 +304,10 @@ main(int argc, char *argv[])
 
 		RTE_LOG(DEBUG, SPP_NFV, "Received string: %s\n", str);
 
-		flg_exit = parse_command(str);
+		flg_exit = parse_command(str, &res);
 
 		/*Send the message back to client*/
-		ret = do_send(&connected, &sock, str);
+		ret = do_send(&connected, &sock, &res);
 
 		if (flg_exit < 0)  /* terminate process if exit is called */
 			break;
@@ -288,6 +316,7 @@ main(int argc, char *argv[])
 	}
 
 	/* exit */
+	jw_free(&res);
 	close(sock);
 	sock = SOCK_RESET;
 	RTE_LOG(INFO, SPP_NFV, "spp_nfv exit.\n");
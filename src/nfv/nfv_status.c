@@ -5,6 +5,7 @@
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
 #include "shared/port_manager.h"
@@ -22,247 +23,193 @@
  *     "lcores": [1, 2],
  *     "ports": ["phy:0", "phy:1", "ring:0", "vhost:0"],
  *     "patches": [
- *       {"src":"phy:0","dst": "ring:0"},
- *       {"src":"ring:0","dst": "vhost:0"}
+ *       {"src":"phy:0","dst": "ring:0","lcore":1,"burst":0,"drain":0},
+ *       {"src":"ring:0","dst": "vhost:0","lcore":2,"burst":0,"drain":0}
+ *     ],
+ *     "port_stats": [
+ *       {"port":"phy:0","rx":100,"tx":0,"tx_drop":0,"tx_retry_drop":0,
+ *        "tx_hold_drop":0,"tx_policy":"drop"},
+ *       ...
  *     ]
  *   }
  */
 void
-get_sec_stats_json(char *str, int cli_id,
+get_sec_stats_json(struct json_writer *jw, int cli_id,
 		const char *running_stat,
 		uint8_t lcore_id_used[RTE_MAX_LCORE])
 {
-	sprintf(str, "{\"client-id\":%d,", cli_id);
-
-	sprintf(str + strlen(str), "\"status\":");
-	sprintf(str + strlen(str), "\"%s\",", running_stat);
-
-	append_lcore_info_json(str, lcore_id_used);
-	sprintf(str + strlen(str), ",");
-
-	append_port_info_json(str);
-	sprintf(str + strlen(str), ",");
-
-	append_patch_info_json(str);
-	sprintf(str + strlen(str), "}");
-
-	/* Make sure to be terminated with null character. */
-	sprintf(str + strlen(str), "%c", '\0');
+	jw_obj_begin(jw, NULL);
+	jw_int(jw, "client-id", cli_id);
+	jw_str(jw, "status", running_stat);
+	append_lcore_info_json(jw, lcore_id_used);
+	append_port_info_json(jw);
+	append_patch_info_json(jw);
+	append_port_stats_json(jw);
+	jw_obj_end(jw);
 }
 
-int
-append_lcore_info_json(char *str,
+void
+append_lcore_info_json(struct json_writer *jw,
 		uint8_t lcore_id_used[RTE_MAX_LCORE])
 {
 	int i;
-	sprintf(str + strlen(str), "\"master-lcore\":%d,",
-			rte_get_master_lcore());
-	sprintf(str + strlen(str), "\"lcores\":[");
+
+	jw_int(jw, "master-lcore", rte_get_master_lcore());
+	jw_arr_begin(jw, "lcores");
 	for (i = 0; i < RTE_MAX_LCORE; i++) {
 		if (lcore_id_used[i] == 1)
-			sprintf(str + strlen(str), "%d,", i);
+			jw_int(jw, NULL, i);
 	}
-
-	/* Remove last ','. */
-	sprintf(str + strlen(str) - 1, "%s", "]");
-	return 0;
+	jw_arr_end(jw);
 }
 
+/*
+ * Append port such as `"phy:0"` as a resource UID. Queue ID is added as
+ * `"phy:0 nq 1"` if the port has several queues.
+ */
+static void
+append_port_string(struct json_writer *jw, const char *key,
+		uint16_t port_id, uint16_t queue_id)
+{
+	struct port_map *port = &port_map[port_id];
+
+	/* TODO(yasufum) Need to remove print for undefined ? */
+	if (port->port_type == UNDEF)
+		jw_str(jw, key, "udf");
+	else if (port->port_type == PHY &&
+			get_port_max_queues(port_id) > 1)
+		jw_strf(jw, key, "phy:%u nq %u", port->id, queue_id);
+	else
+		jw_strf(jw, key, "%s:%u", get_port_type_name(port->port_type),
+				port->id);
+}
 
 /*
  * Append patch info to sec status. It is called from get_sec_stats_json()
- * to add a JSON formatted patch info to given 'str'. Here is an example.
+ * to add a JSON formatted patch info to given 'jw'. Here is an example.
  *
  *     "ports": ["phy:0", "phy:1", "ring:0", "vhost:0"]
  */
-int
-append_port_info_json(char *str)
+void
+append_port_info_json(struct json_writer *jw)
 {
 	unsigned int i, j;
-	unsigned int has_port = 0;  // for checking having port at last
 	uint16_t max_queue;
 
-	sprintf(str + strlen(str), "\"ports\":[");
+	jw_arr_begin(jw, "ports");
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
 		max_queue = get_port_max_queues(i);
 
 		for (j = 0; j < max_queue; j++) {
 			if (ports_fwd_array[i][j].in_port_id == PORT_RESET)
 				continue;
-
-			has_port = 1;
-			switch (port_map[i].port_type) {
-			case PHY:
-				if (max_queue == 1)
-					sprintf(str + strlen(str),
-						"\"phy:%u\",", port_map[i].id);
-				else
-					sprintf(str + strlen(str),
-						"\"phy:%u nq %u\",",
-						port_map[i].id, j);
-				break;
-			case RING:
-				sprintf(str + strlen(str), "\"ring:%u\",",
-					port_map[i].id);
-				break;
-			case VHOST:
-				sprintf(str + strlen(str), "\"vhost:%u\",",
-					port_map[i].id);
-				break;
-			case PCAP:
-				sprintf(str + strlen(str), "\"pcap:%u\",",
-						port_map[i].id);
-				break;
-			case NULLPMD:
-				sprintf(str + strlen(str), "\"nullpmd:%u\",",
-						port_map[i].id);
-				break;
-			case TAP:
-				sprintf(str + strlen(str), "\"tap:%u\",",
-						port_map[i].id);
-				break;
-			case MEMIF:
-				sprintf(str + strlen(str), "\"memif:%u\",",
-						port_map[i].id);
-				break;
-			case UNDEF:
-				/*
-				 * TODO(yasufum) Need to remove print for
-				 * undefined ?
-				 */
-				sprintf(str + strlen(str), "\"udf\",");
-				break;
-			}
+			append_port_string(jw, NULL, i, j);
 		}
 	}
-
-	/* Check if it has at least one port to remove ",". */
-	if (has_port == 0) {
-		sprintf(str + strlen(str), "]");
-	} else {  /* Remove last ',' .*/
-		sprintf(str + strlen(str) - 1, "]");
-	}
-
-	return 0;
-}
-
-static void
-append_port_string(char *str, enum port_type port_type,
-		uint16_t port_id, uint16_t queue_id, int max_queue)
-{
-	switch (port_type) {
-	case PHY:
-		RTE_LOG(INFO, SHARED, "Type: PHY\n");
-		if (max_queue > 1)
-			sprintf(str, "\"phy:%u nq %u\"", port_id, queue_id);
-		else
-			sprintf(str, "\"phy:%u\"", port_id);
-		break;
-
-	case RING:
-		RTE_LOG(INFO, SHARED, "Type: RING\n");
-		sprintf(str, "\"ring:%u\"", port_id);
-		break;
-
-	case VHOST:
-		RTE_LOG(INFO, SHARED, "Type: VHOST\n");
-		sprintf(str, "\"vhost:%u\"", port_id);
-		break;
-
-	case PCAP:
-		RTE_LOG(INFO, SHARED, "Type: PCAP\n");
-		sprintf(str, "\"pcap:%u\"", port_id);
-		break;
-
-	case NULLPMD:
-		RTE_LOG(INFO, SHARED, "Type: NULLPMD\n");
-		sprintf(str, "\"nullpmd:%u\"", port_id);
-		break;
-
-	case TAP:
-		RTE_LOG(INFO, SHARED, "Type: TAP\n");
-		sprintf(str, "\"tap:%u\"", port_id);
-		break;
-
-	case MEMIF:
-		RTE_LOG(INFO, SHARED, "Type: MEMIF\n");
-		sprintf(str, "\"memif:%u\"", port_id);
-		break;
-
-	case UNDEF:
-		RTE_LOG(INFO, SHARED, "Type: UDF\n");
-		/* TODO(yasufum) Need to remove print for undefined ? */
-		sprintf(str, "\"udf\"");
-		break;
-	}
+	jw_arr_end(jw);
 }
 
 /*
  * Append patch info to sec status. It is called from get_sec_stats_json()
- * to add a JSON formatted patch info to given 'str'. Here is an example.
+ * to add a JSON formatted patch info to given 'jw'. Here is an example.
  *
  *     "patches": [
- *       {"src":"phy:0","dst": "ring:0"},
- *       {"src":"ring:0","dst": "vhost:0"}
+ *       {"src":"phy:0","dst": "ring:0","fanout":[],"mode":"copy",
+ *        "lcore":1,"burst":0,"drain":0},
+ *       {"src":"ring:0","dst": "vhost:0","fanout":["vhost:1"],
+ *        "mode":"hash","lcore":2,"burst":32,"drain":100}
  *      ]
+ *
+ * `fanout` is a list of destinations other than `dst` of fan-out patch.
+ * `mode` is `copy` if packets are sent to all of destinations, or `hash`
+ * if distributed to them by hash of flows.
+ * `lcore` is the ID of lcore forwarding the patch, or -1 if no lcore is
+ * assigned. `burst` and `drain` are params of TX buffer of the patch.
  */
-int
-append_patch_info_json(char *str)
+void
+append_patch_info_json(struct json_writer *jw)
 {
 	unsigned int i, j;
-	unsigned int has_patch = 0;  // for checking having patch at last
-	unsigned int out_port_id;
-	uint16_t out_queue_id;
-	uint16_t in_max_queue, out_max_queue;
+	uint16_t in_max_queue;
+	uint16_t d;
+	struct port *patch;
 
-	char patch_str[128];
-	sprintf(str + strlen(str), "\"patches\":[");
+	jw_arr_begin(jw, "patches");
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
 		in_max_queue = get_port_max_queues(i);
 
 		for (j = 0; j < in_max_queue; j++) {
-
-			if (ports_fwd_array[i][j].in_port_id == PORT_RESET ||
-				ports_fwd_array[i][j].out_port_id == PORT_RESET)
+			patch = &ports_fwd_array[i][j];
+			if (patch->in_port_id == PORT_RESET ||
+					patch->out_port_id == PORT_RESET)
 				continue;
 
-			has_patch = 1;
-			RTE_LOG(INFO, SHARED, "Port ID %d\n", i);
-			RTE_LOG(INFO, SHARED, "Queue ID %d\n", j);
-			RTE_LOG(INFO, SHARED, "Status %d\n",
-				ports_fwd_array[i][j].in_port_id);
-
-			memset(patch_str, '\0', sizeof(patch_str));
-
-			sprintf(patch_str, "{\"src\":");
-			append_port_string(patch_str + strlen(patch_str),
-				port_map[i].port_type, port_map[i].id,
-				j, in_max_queue);
-			sprintf(patch_str + strlen(patch_str), ",\"dst\":");
-
-			out_port_id = ports_fwd_array[i][j].out_port_id;
-			out_queue_id = ports_fwd_array[i][j].out_queue_id;
-			RTE_LOG(INFO, SHARED, "Out Port ID %d\n", out_port_id);
-			RTE_LOG(INFO, SHARED, "Out Queue ID %d\n",
-				out_queue_id);
-
-			out_max_queue = get_port_max_queues(out_port_id);
-			append_port_string(patch_str + strlen(patch_str),
-				port_map[out_port_id].port_type,
-				port_map[out_port_id].id,
-				out_queue_id, out_max_queue);
-			sprintf(patch_str + strlen(patch_str), "},");
-
-			sprintf(str + strlen(str), "%s", patch_str);
+			jw_obj_begin(jw, NULL);
+			append_port_string(jw, "src", i, j);
+			append_port_string(jw, "dst", patch->out_port_id,
+					patch->out_queue_id);
+
+			jw_arr_begin(jw, "fanout");
+			for (d = 0; d < patch->nof_fanout; d++)
+				append_port_string(jw, NULL,
+						patch->fanout[d].port_id,
+						patch->fanout[d].queue_id);
+			jw_arr_end(jw);
+
+			jw_str(jw, "mode", patch->mode == PATCH_MODE_HASH ?
+					"hash" : "copy");
+			jw_int(jw, "lcore", (int)patch->lcore_id);
+			jw_uint(jw, "burst", patch->tx_burst);
+			jw_uint(jw, "drain", patch->drain_us);
+			jw_obj_end(jw);
 		}
 	}
+	jw_arr_end(jw);
+}
 
-	/* Check if it has at least one patch to remove ",". */
-	if (has_patch == 0) {
-		sprintf(str + strlen(str), "]");
-	} else {  /* Remove last ','. */
-		sprintf(str + strlen(str) - 1, "]");
-	}
+/*
+ * Append counters of ports to sec status. Each of counters is a sum of
+ * all of lcores forwarding the port. Here is an example.
+ *
+ *     "port_stats": [
+ *       {"port":"phy:0","rx":100,"tx":0,"tx_drop":0,"tx_retry_drop":0,
+ *        "tx_hold_drop":0,"tx_policy":"drop"},
+ *       {"port":"ring:0","rx":0,"tx":100,"tx_drop":2,"tx_retry_drop":2,
+ *        "tx_hold_drop":0,"tx_policy":"retry"}
+ *      ]
+ *
+ * `tx_drop` is the total of dropped packets in TX, and `tx_retry_drop` and
+ * `tx_hold_drop` are ones dropped with `retry` and `hold` TX policy.
+ * Phy ports also have `hw` of counters reported by the NIC, which is
+ * omitted in the example.
+ */
+void
+append_port_stats_json(struct json_writer *jw)
+{
+	unsigned int i;
+	struct stats st;
 
-	return 0;
+	jw_arr_begin(jw, "port_stats");
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (port_map[i].port_type == UNDEF)
+			continue;
+
+		get_port_stats_sum(i, &st);
+
+		jw_obj_begin(jw, NULL);
+		jw_strf(jw, "port", "%s:%u",
+				get_port_type_name(port_map[i].port_type),
+				port_map[i].id);
+		jw_uint(jw, "rx", st.rx);
+		jw_uint(jw, "tx", st.tx);
+		jw_uint(jw, "tx_drop", st.tx_drop);
+		jw_uint(jw, "tx_retry_drop", st.tx_retry_drop);
+		jw_uint(jw, "tx_hold_drop", st.tx_hold_drop);
+		jw_str(jw, "tx_policy",
+				tx_policy_str(port_map[i].tx_conf.policy));
+		if (port_map[i].port_type == PHY)
+			append_eth_stats_json(jw, "hw", i);
+		jw_obj_end(jw);
+	}
+	jw_arr_end(jw);
 }
@@ -5,18 +5,23 @@
 #ifndef _NFV_STATUS_H_
 #define _NFV_STATUS_H_
 
+#include "shared/json_writer.h"
+
 /* Get status of spp_nfv or spp_vm as JSON format. */
-void get_sec_stats_json(char *str, int client_id,
+void get_sec_stats_json(struct json_writer *jw, int client_id,
 		const char *running_stat,
 		uint8_t lcore_id_used[RTE_MAX_LCORE]);
 
-int append_lcore_info_json(char *str,
+void append_lcore_info_json(struct json_writer *jw,
 		uint8_t lcore_id_used[RTE_MAX_LCORE]);
 
 /* Append port info to sec status, called from get_sec_stats_json(). */
-int append_port_info_json(char *str);
+void append_port_info_json(struct json_writer *jw);
 
 /* Append patch info to sec status, called from get_sec_stats_json(). */
-int append_patch_info_json(char *str);
+void append_patch_info_json(struct json_writer *jw);
+
+/* Append counters of ports to sec status, called from get_sec_stats_json(). */
+void append_port_stats_json(struct json_writer *jw);
 
 #endif
@@ -9,6 +9,7 @@
 /* the port details */
 struct port_info *ports;
 
-static enum cmd_type cmd;
+/* Updated from main thread and referred from forwarding lcores. */
+static volatile enum cmd_type cmd;
 
 #endif // _NFV_PARAMS_H_
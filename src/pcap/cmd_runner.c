@@ -104,10 +104,9 @@ append_json_comma(char **output)
 static int
 append_json_uint_value(const char *name, char **output, unsigned int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%u"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's numeric format failed to add. "
@@ -115,8 +114,6 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%u"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -128,10 +125,9 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 static int
 append_json_int_value(const char *name, char **output, int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%d"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's numeric format failed to add. "
@@ -139,8 +135,6 @@ append_json_int_value(const char *name, char **output, int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%d"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -152,10 +146,9 @@ append_json_int_value(const char *name, char **output, int value)
 static int
 append_json_str_value(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("\"%s\""),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's string format failed to add. "
@@ -163,8 +156,6 @@ append_json_str_value(const char *name, char **output, const char *str)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("\"%s\""),
-			JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -176,10 +167,9 @@ append_json_str_value(const char *name, char **output, const char *str)
 static int
 append_json_array_brackets(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_ARRAY,
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's square bracket failed to add. "
@@ -187,8 +177,6 @@ append_json_array_brackets(const char *name, char **output, const char *str)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_ARRAY,
-			JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -196,10 +184,10 @@ append_json_array_brackets(const char *name, char **output, const char *str)
 static int
 append_json_block_brackets(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	*output = spp_strbuf_appendf(*output, name[0] == '\0' ?
+			JSON_APPEND_BLOCK_NONAME : JSON_APPEND_BLOCK,
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's curly bracket failed to add. "
@@ -207,12 +195,6 @@ append_json_block_brackets(const char *name, char **output, const char *str)
 		return SPPWK_RET_NG;
 	}
 
-	if (name[0] == '\0')
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK_NONAME,
-				JSON_APPEND_COMMA(len), name, str);
-	else
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK,
-				JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -549,7 +531,7 @@ append_response_list_value(char **output,
 	}
 
 	for (i = 0; list[i].tag_name[0] != '\0'; i++) {
-		tmp_buff[0] = '\0';
+		spp_strbuf_clear(tmp_buff);
 		ret = list[i].func(list[i].tag_name, &tmp_buff, tmp);
 		if (unlikely(ret < SPPWK_RET_OK)) {
 			spp_strbuf_free(tmp_buff);
@@ -575,7 +557,7 @@ append_response_list_value(char **output,
 		}
 
 		*output = spp_strbuf_append(*output, tmp_buff,
-				strlen(tmp_buff));
+				spp_strbuf_len(tmp_buff));
 		if (unlikely(*output == NULL)) {
 			spp_strbuf_free(tmp_buff);
 			RTE_LOG(ERR, PCAP_RUNNER,
@@ -635,7 +617,7 @@ append_command_results_value(const char *name, char **output,
 	}
 
 	for (i = 0; i < num; i++) {
-		tmp_buff1[0] = '\0';
+		spp_strbuf_clear(tmp_buff1);
 		ret = append_response_list_value(&tmp_buff1,
 				response_result_list, &results[i]);
 		if (unlikely(ret < 0)) {
@@ -730,7 +712,7 @@ send_parse_error_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"Failed to send parse error response.\n");
@@ -824,7 +806,7 @@ send_command_result_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 			"Failed to send command result response.\n");
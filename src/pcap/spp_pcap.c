@@ -13,6 +13,7 @@
 #include <lz4frame.h>
 
 #include "shared/common.h"
+#include "shared/shm_stats.h"
 #include "data_types.h"
 #include "cmd_utils.h"
 #include "spp_pcap.h"
@@ -141,6 +142,7 @@ struct pcap_mng_info {
 	size_t outbuf_capacity;  /* compress date buffer size */
 	void *outbuff;  /* compress date buffer */
 	uint64_t file_size;  /* file write size */
+	struct stats stats;  /* Updated only from the thread. */
 };
 
 /* Pcap status info. */
@@ -870,6 +872,9 @@ static int pcap_proc_receive(int lcore_id)
 
 	total_rx += nb_rx;
 	total_drop += nb_rx - nb_tx;
+	info->stats.rx += nb_rx;
+	info->stats.tx += nb_tx;
+	info->stats.tx_drop += nb_rx - nb_tx;
 
 	return SPPWK_RET_OK;
 }
@@ -938,6 +943,9 @@ static int pcap_proc_write(int lcore_id)
 			break;
 		}
 	}
+	info->stats.rx += nb_rx;
+	info->stats.tx += buf;
+	info->stats.tx_drop += nb_rx - buf;
 
 	/* Free mbuf */
 	for (buf = 0; buf < nb_rx; buf++)
@@ -947,6 +955,57 @@ static int pcap_proc_write(int lcore_id)
 	return ret;
 }
 
+/*
+ * Fill counters of receiver and writer threads to the stats segment. `tx` of
+ * receiver is the num of packets passed to writers, and `tx` of writer is
+ * the num of packets written to files.
+ */
+static void
+collect_pcap_stats(struct shm_stats *st)
+{
+	unsigned int lcore_id;
+	struct pcap_mng_info *info;
+	struct shm_comp_stats *shm_comp;
+	struct shm_lcore_stats *shm_lcore;
+	struct shm_port_stats *shm_port;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		if (info->type == PCAP_UNUSE)
+			continue;
+
+		shm_comp = &st->comps[st->nof_comps++];
+		if (info->type == PCAP_RECEIVE) {
+			snprintf(shm_comp->name, sizeof(shm_comp->name),
+					"receive");
+			snprintf(shm_comp->type, sizeof(shm_comp->type),
+					"receive");
+		} else {
+			snprintf(shm_comp->name, sizeof(shm_comp->name),
+					"write%d", info->thread_no);
+			snprintf(shm_comp->type, sizeof(shm_comp->type),
+					"write");
+		}
+		shm_comp->lcore_id = lcore_id;
+		shm_comp->stats = info->stats;
+
+		/* Each of threads runs on its own lcore. */
+		shm_lcore = &st->lcores[st->nof_lcores++];
+		memset(shm_lcore, 0, sizeof(*shm_lcore));
+		shm_lcore->lcore_id = lcore_id;
+		shm_lcore->stats = info->stats;
+
+		if (info->type != PCAP_RECEIVE)
+			continue;
+
+		shm_port = &st->ports[st->nof_ports++];
+		memset(shm_port, 0, sizeof(*shm_port));
+		shm_port->port_type = g_pcap_option.port_cap.iface_type;
+		shm_port->port_id = g_pcap_option.port_cap.iface_no;
+		shm_port->stats.rx = info->stats.rx;
+	}
+}
+
 /* Main process of slave core */
 static int
 slave_main(void *arg __attribute__ ((unused)))
@@ -1147,6 +1206,9 @@ main(int argc, char *argv[])
 		set_all_core_status(SPPWK_LCORE_RUNNING);
 		RTE_LOG(INFO, SPP_PCAP, "[Press Ctrl-C to quit ...]\n");
 
+		/* Counters are published from this thread not to race cmds. */
+		shm_stats_init("pcap", get_client_id(), collect_pcap_stats);
+
 		/* Enter loop for accepting commands */
 		int ret_do = 0;
 		while (likely(g_core_info[master_lcore].status !=
@@ -1156,6 +1218,7 @@ main(int argc, char *argv[])
 			if (unlikely(ret_do != SPPWK_RET_OK))
 				break;
 
+			shm_stats_update_periodic();
 			/*
 			 * Wait to avoid CPU overloaded.
 			 */
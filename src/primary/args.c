@@ -6,8 +6,11 @@
 #include <getopt.h>
 
 #include <rte_memory.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
 
 #include "shared/common.h"
+#include "shared/basic_forwarder.h"
 #include "args.h"
 #include "init.h"
 #include "primary.h"
@@ -20,6 +23,43 @@ int server_port;
 /* Flag for deciding to forward */
 int do_forwarding;
 
+/* Sizes of rings, descriptors and mbuf pools - extern in header */
+struct size_opt ring_size_opt = { .def = CLIENT_QUEUE_RINGSIZE };
+struct size_opt ring_mbufs_opt = { .def = MBUFS_PER_CLIENT };
+struct size_opt rxd_opt = { .def = RTE_MP_RX_DESC_DEFAULT };
+struct size_opt txd_opt = { .def = RTE_MP_TX_DESC_DEFAULT };
+struct size_opt port_mbufs_opt = { .def = MBUFS_PER_PORT };
+unsigned int mbuf_cache_size = MBUF_CACHE_SIZE;
+
+/* Address of metrics exporter, or NULL if disabled - extern in header */
+char *metrics_addr;
+
+/* Offloads for all of phy ports, and overridden for each of ports. */
+static struct offload_conf default_offload_opt;
+static struct offload_conf port_offload_opts[RTE_MAX_ETHPORTS];
+static uint8_t port_offload_given[RTE_MAX_ETHPORTS];
+
+/* Items of `--offload` option without value. */
+static const struct {
+	const char *name;
+	uint64_t rx_offloads;
+	uint64_t tx_offloads;
+	uint64_t rss_hf;
+} offload_items[] = {
+	{ "rss-ip", 0, 0, ETH_RSS_IP },
+	{ "rss-udp", 0, 0, ETH_RSS_UDP },
+	{ "rss-tcp", 0, 0, ETH_RSS_TCP },
+	{ "vlan-strip", DEV_RX_OFFLOAD_VLAN_STRIP, 0, 0 },
+	{ "vlan-insert", 0, DEV_TX_OFFLOAD_VLAN_INSERT, 0 },
+	{ "rx-cksum", DEV_RX_OFFLOAD_IPV4_CKSUM | DEV_RX_OFFLOAD_UDP_CKSUM |
+		DEV_RX_OFFLOAD_TCP_CKSUM, 0, 0 },
+	{ "tx-cksum", 0, DEV_TX_OFFLOAD_IPV4_CKSUM | DEV_TX_OFFLOAD_UDP_CKSUM |
+		DEV_TX_OFFLOAD_TCP_CKSUM, 0 },
+	{ "tso", 0, DEV_TX_OFFLOAD_TCP_TSO, 0 },
+	{ "multi-seg", DEV_RX_OFFLOAD_SCATTER, DEV_TX_OFFLOAD_MULTI_SEGS, 0 },
+	{ "fast-free", 0, DEV_TX_OFFLOAD_MBUF_FAST_FREE, 0 },
+};
+
 /*
  * Long options mapped to a short option.
  *
@@ -30,11 +70,29 @@ enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_DISP_STATS,
 	CMD_OPT_PORT_NUM, /* For `--port-num` */
+	CMD_OPT_IDLE, /* For `--idle` */
+	CMD_OPT_RING_SIZE, /* For `--ring-size` */
+	CMD_OPT_RING_MBUFS, /* For `--ring-mbufs` */
+	CMD_OPT_RXD, /* For `--rxd` */
+	CMD_OPT_TXD, /* For `--txd` */
+	CMD_OPT_PORT_MBUFS, /* For `--port-mbufs` */
+	CMD_OPT_MBUF_CACHE, /* For `--mbuf-cache` */
+	CMD_OPT_OFFLOAD, /* For `--offload` */
+	CMD_OPT_METRICS, /* For `--metrics` */
 };
 
 struct option lgopts[] = {
 	{"disp-stats", no_argument, NULL, CMD_OPT_DISP_STATS},
 	{"port-num", required_argument, NULL, CMD_OPT_PORT_NUM},
+	{"idle", required_argument, NULL, CMD_OPT_IDLE},
+	{"ring-size", required_argument, NULL, CMD_OPT_RING_SIZE},
+	{"ring-mbufs", required_argument, NULL, CMD_OPT_RING_MBUFS},
+	{"rxd", required_argument, NULL, CMD_OPT_RXD},
+	{"txd", required_argument, NULL, CMD_OPT_TXD},
+	{"port-mbufs", required_argument, NULL, CMD_OPT_PORT_MBUFS},
+	{"mbuf-cache", required_argument, NULL, CMD_OPT_MBUF_CACHE},
+	{"offload", required_argument, NULL, CMD_OPT_OFFLOAD},
+	{"metrics", required_argument, NULL, CMD_OPT_METRICS},
 	{0}
 };
 
@@ -49,12 +107,31 @@ usage(void)
 	RTE_LOG(INFO, PRIMARY,
 	    "%s [EAL options] -- -p PORTMASK -n NUM_CLIENTS [-s NUM_SOCKETS]"
 		" [--port-num NUM_PORT"
-		" rxq NUM_RX_QUEUE txq NUM_TX_QUEUE]...\n"
+		" rxq NUM_RX_QUEUE txq NUM_TX_QUEUE]..."
+		" [--idle PAUSE_POLLS[,YIELD_POLLS[,SLEEP_US]]]"
+		" [--ring-size SIZE[,RING_ID=SIZE]...]"
+		" [--ring-mbufs NUM[,RING_ID=NUM]...]"
+		" [--rxd NUM[,PORT_ID=NUM]...] [--txd NUM[,PORT_ID=NUM]...]"
+		" [--port-mbufs NUM[,PORT_ID=NUM]...] [--mbuf-cache SIZE]"
+		" [--offload ITEM[+ITEM]...[,PORT_ID=ITEM[+ITEM]...]...]"
+		" [--metrics [IP:]PORT|PATH]\n"
 	    " -p PORTMASK: hexadecimal bitmask of ports to use\n"
 	    " -n NUM_RINGS: number of ring ports used from secondaries\n"
 		" --port-num NUM_PORT: number of ports for multi-queue setting\n"
 		" rxq NUM_RX_QUEUE: number of receive queues\n"
 		" txq NUM_TX_QUEUE number of transmit queues\n"
+		" --idle: num of empty polls before pausing and yielding,"
+		" and sleep time instead of yielding\n"
+		" --ring-size: num of entries of ring ports, power of 2\n"
+		" --ring-mbufs: num of mbufs in pools for ring ports\n"
+		" --rxd: num of RX descriptors of phy ports\n"
+		" --txd: num of TX descriptors of phy ports\n"
+		" --port-mbufs: num of mbufs in pools for phy ports\n"
+		" --mbuf-cache: size of per-lcore cache of mbuf pools\n"
+		" --offload: offloads of phy ports, rss-ip, rss-udp, rss-tcp,"
+		" rss-key:HEX, vlan-strip, vlan-insert, rx-cksum, tx-cksum,"
+		" tso, multi-seg, fast-free or mtu:SIZE\n"
+		" --metrics: serve metrics on TCP port or UNIX socket\n"
 	    , progname);
 }
 
@@ -224,6 +301,196 @@ parse_nof_queues(struct port_queue *arg_queues, const char *str_port_num,
 	return 0;
 }
 
+/**
+ * Parse sizes such as `1024,0=4096` given to `opt_name` option. First one
+ * without ID is for all of rings or ports, and others are for the ID.
+ * Sizes must be in from `min` to `max`, and power of 2 if `pow2` is 1.
+ */
+static int
+parse_size_opt(struct size_opt *opt, const char *opt_name, const char *str,
+		unsigned long min, unsigned long max, int pow2)
+{
+	char buf[256];
+	char *saveptr = NULL;
+	char *token, *val, *endp;
+	unsigned long id = 0, size;
+
+	if (str == NULL || strlen(str) >= sizeof(buf))
+		goto invalid;
+	strcpy(buf, str);
+
+	for (token = strtok_r(buf, ",", &saveptr); token != NULL;
+			token = strtok_r(NULL, ",", &saveptr)) {
+		val = strchr(token, '=');
+		if (val != NULL) {
+			*val++ = '\0';
+			id = strtoul(token, &endp, 10);
+			if (*token == '\0' || *endp != '\0' ||
+					id >= RTE_DIM(opt->sizes))
+				goto invalid;
+		}
+
+		size = strtoul(val != NULL ? val : token, &endp, 10);
+		if (*endp != '\0' || endp == (val != NULL ? val : token) ||
+				size < min || size > max ||
+				(pow2 && !rte_is_power_of_2(size)))
+			goto invalid;
+
+		if (val != NULL)
+			opt->sizes[id] = (unsigned int)size;
+		else
+			opt->def = (unsigned int)size;
+	}
+
+	return 0;
+
+invalid:
+	RTE_LOG(ERR, PRIMARY, "Invalid %s '%s'\n", opt_name, str);
+	return -1;
+}
+
+/* Parse size of per-lcore cache of mbuf pools. */
+static int
+parse_mbuf_cache(unsigned int *cache_size, const char *str)
+{
+	char *end = NULL;
+	unsigned long temp;
+
+	if (str == NULL || *str == '\0')
+		return -1;
+
+	temp = strtoul(str, &end, 10);
+	if (end == NULL || *end != '\0' ||
+			temp > RTE_MEMPOOL_CACHE_MAX_SIZE) {
+		RTE_LOG(ERR, PRIMARY, "Invalid mbuf-cache '%s', max is %u\n",
+			str, RTE_MEMPOOL_CACHE_MAX_SIZE);
+		return -1;
+	}
+
+	*cache_size = (unsigned int)temp;
+	return 0;
+}
+
+/* Parse RSS hash key given as hex string such as `6d5a6d5a...`. */
+static int
+parse_rss_key(struct offload_conf *conf, const char *str)
+{
+	size_t len = strlen(str);
+	char byte[3] = { '\0' };
+	char *end;
+	size_t i;
+
+	if (len == 0 || len % 2 != 0 || len / 2 > sizeof(conf->rss_key))
+		return -1;
+
+	for (i = 0; i < len / 2; i++) {
+		byte[0] = str[i * 2];
+		byte[1] = str[i * 2 + 1];
+		conf->rss_key[i] = (uint8_t)strtoul(byte, &end, 16);
+		if (*end != '\0')
+			return -1;
+	}
+	conf->rss_key_len = (uint8_t)(len / 2);
+
+	return 0;
+}
+
+/* Parse items of offloads such as `rss-ip+vlan-strip+mtu:9000`. */
+static int
+parse_offload_items(struct offload_conf *conf, char *str)
+{
+	char *saveptr = NULL;
+	char *token, *end;
+	unsigned long mtu;
+	unsigned int i;
+
+	memset(conf, 0, sizeof(*conf));
+
+	for (token = strtok_r(str, "+", &saveptr); token != NULL;
+			token = strtok_r(NULL, "+", &saveptr)) {
+		if (!strncmp(token, "mtu:", 4)) {
+			mtu = strtoul(&token[4], &end, 10);
+			if (token[4] == '\0' || *end != '\0' ||
+					mtu < RTE_ETHER_MIN_MTU ||
+					mtu > UINT16_MAX)
+				return -1;
+			conf->mtu = (uint16_t)mtu;
+			continue;
+		}
+
+		if (!strncmp(token, "rss-key:", 8)) {
+			if (parse_rss_key(conf, &token[8]) != 0)
+				return -1;
+			continue;
+		}
+
+		for (i = 0; i < RTE_DIM(offload_items); i++) {
+			if (!strcmp(token, offload_items[i].name))
+				break;
+		}
+		if (i == RTE_DIM(offload_items))
+			return -1;
+
+		conf->rx_offloads |= offload_items[i].rx_offloads;
+		conf->tx_offloads |= offload_items[i].tx_offloads;
+		conf->rss_hf |= offload_items[i].rss_hf;
+	}
+
+	return 0;
+}
+
+/*
+ * Parse offloads such as `rx-cksum,0=rss-ip+rss-tcp`. First one without
+ * port ID is for all of phy ports, and others replace it for the port.
+ */
+static int
+parse_offload_opt(const char *opt)
+{
+	char buf[512];
+	char *saveptr = NULL;
+	char *token, *items, *end;
+	unsigned long port_id;
+
+	if (strlen(opt) >= sizeof(buf))
+		goto invalid;
+	strcpy(buf, opt);
+
+	for (token = strtok_r(buf, ",", &saveptr); token != NULL;
+			token = strtok_r(NULL, ",", &saveptr)) {
+		items = strchr(token, '=');
+		if (items == NULL) {
+			if (parse_offload_items(&default_offload_opt,
+						token) != 0)
+				goto invalid;
+			continue;
+		}
+
+		*items++ = '\0';
+		port_id = strtoul(token, &end, 10);
+		if (*token == '\0' || *end != '\0' ||
+				port_id >= RTE_MAX_ETHPORTS)
+			goto invalid;
+		if (parse_offload_items(&port_offload_opts[port_id],
+					items) != 0)
+			goto invalid;
+		port_offload_given[port_id] = 1;
+	}
+
+	return 0;
+
+invalid:
+	RTE_LOG(ERR, PRIMARY, "Invalid offload '%s'\n", opt);
+	return -1;
+}
+
+const struct offload_conf *
+get_offload_opt(uint16_t port_id)
+{
+	if (port_id < RTE_MAX_ETHPORTS && port_offload_given[port_id])
+		return &port_offload_opts[port_id];
+	return &default_offload_opt;
+}
+
 /**
  * Set the number of queues for port_id.
  * If not specified number of queue is set as 1.
@@ -301,6 +568,67 @@ parse_app_args(uint16_t max_ports, int argc, char *argv[])
 				return -1;
 			}
 			break;
+		case CMD_OPT_IDLE:
+			if (parse_idle_opt(optarg) != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_RING_SIZE:
+			ret = parse_size_opt(&ring_size_opt, "ring-size",
+					optarg, 2, RTE_RING_SZ_MASK, 1);
+			if (ret != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_RING_MBUFS:
+			ret = parse_size_opt(&ring_mbufs_opt, "ring-mbufs",
+					optarg, 1, UINT32_MAX, 0);
+			if (ret != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_RXD:
+			ret = parse_size_opt(&rxd_opt, "rxd", optarg,
+					1, UINT16_MAX, 0);
+			if (ret != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_TXD:
+			ret = parse_size_opt(&txd_opt, "txd", optarg,
+					1, UINT16_MAX, 0);
+			if (ret != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_PORT_MBUFS:
+			ret = parse_size_opt(&port_mbufs_opt, "port-mbufs",
+					optarg, 1, UINT32_MAX, 0);
+			if (ret != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_MBUF_CACHE:
+			if (parse_mbuf_cache(&mbuf_cache_size, optarg) != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_OFFLOAD:
+			if (parse_offload_opt(optarg) != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_METRICS:
+			metrics_addr = optarg;
+			break;
 		default:
 			RTE_LOG(ERR,
 				PRIMARY, "ERROR: Unknown option '%c'\n", opt);
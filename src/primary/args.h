@@ -13,6 +13,51 @@ extern uint16_t num_rings;
 extern char *server_ip;
 extern int server_port;
 
+/*
+ * Size of all of rings or ports, overridden for each of them with ID.
+ * It is given as `SIZE[,ID=SIZE]...` to an option such as `--ring-size`.
+ */
+struct size_opt {
+	unsigned int def;  /* Size used if not overridden. */
+	unsigned int sizes[RTE_MAX_ETHPORTS];  /* Overridden, or 0 if not. */
+};
+
+extern struct size_opt ring_size_opt;  /* Num of entries of a ring port. */
+extern struct size_opt ring_mbufs_opt;  /* Num of mbufs for a ring port. */
+extern struct size_opt rxd_opt;  /* Num of RX descriptors of a phy port. */
+extern struct size_opt txd_opt;  /* Num of TX descriptors of a phy port. */
+extern struct size_opt port_mbufs_opt;  /* Num of mbufs for a phy port. */
+extern unsigned int mbuf_cache_size;  /* Per-lcore cache of mbuf pools. */
+extern char *metrics_addr;  /* Address of metrics exporter, or NULL. */
+
+/* Get size for ring or port of `id`. */
+static inline unsigned int
+get_size_opt(const struct size_opt *opt, unsigned int id)
+{
+	if (id < RTE_DIM(opt->sizes) && opt->sizes[id] != 0)
+		return opt->sizes[id];
+	return opt->def;
+}
+
+/* Max length of RSS hash key given with `--offload` option. */
+#define OFFLOAD_RSS_KEY_MAX_LEN 64
+
+/*
+ * Offloads of a phy port requested with `--offload` option, or enabled for
+ * the port after checking capabilities of the device.
+ */
+struct offload_conf {
+	uint64_t rx_offloads;  /* DEV_RX_OFFLOAD_* */
+	uint64_t tx_offloads;  /* DEV_TX_OFFLOAD_* */
+	uint64_t rss_hf;  /* Hash types of RSS, or 0 for disabled. */
+	uint8_t rss_key[OFFLOAD_RSS_KEY_MAX_LEN];
+	uint8_t rss_key_len;  /* 0 for the default key of PMD. */
+	uint16_t mtu;  /* 0 for the default of PMD. */
+};
+
+/* Get offloads requested for phy port of `port_id`. */
+const struct offload_conf *get_offload_opt(uint16_t port_id);
+
 /* Return value definition for getopt_long(). Only for long option. */
 #define SPP_LONGOPT_RETVAL_PORT_NUM 1 /* For `--port-num` */
 
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "count.h"
+
+/* Define action "count" operations */
+struct flow_detail_ops count_ops_list[] = {
+	{
+		.token = "identifier",
+		.offset = offsetof(struct rte_flow_action_count, id),
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_action_count_json(const void *conf, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_action_count *count = conf;
+
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "identifier", count->id);
+	jw_obj_end(jw);
+}
+
+/*
+ * Counters are not reset by the query, so they are accumulated from the
+ * creation of the flow. It is null if the PMD fails to query.
+ */
+void
+append_action_count_query_json(int port_id, struct rte_flow *flow,
+	const struct rte_flow_action *action, const char *key,
+	struct json_writer *jw)
+{
+	int ret;
+	struct rte_flow_query_count count = { .reset = 0 };
+	struct rte_flow_error error = { 0 };
+
+	ret = rte_flow_query(port_id, flow, action, &count, &error);
+	if (ret != 0) {
+		RTE_LOG(DEBUG, SPP_FLOW,
+			"Failed to query count of port %d: %s(%s:%d)\n",
+			port_id,
+			error.message ? error.message : "(no stated reason)",
+			__func__, __LINE__);
+		jw_null(jw, key);
+		return;
+	}
+
+	jw_obj_begin(jw, key);
+	if (count.hits_set)
+		jw_uint(jw, "hits", count.hits);
+	else
+		jw_null(jw, "hits");
+	if (count.bytes_set)
+		jw_uint(jw, "bytes", count.bytes);
+	else
+		jw_null(jw, "bytes");
+	jw_obj_end(jw);
+}
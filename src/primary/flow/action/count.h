@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_COUNT_H_
+#define _PRIMARY_FLOW_ACTION_COUNT_H_
+
+extern struct flow_detail_ops count_ops_list[];
+
+void append_action_count_json(const void *conf, const char *key,
+	struct json_writer *jw);
+
+/* Append counters of the flow taken with rte_flow_query(). */
+void append_action_count_query_json(int port_id, struct rte_flow *flow,
+	const struct rte_flow_action *action, const char *key,
+	struct json_writer *jw);
+
+#endif
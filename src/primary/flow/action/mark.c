@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "mark.h"
+
+/* Define action "mark" operations */
+struct flow_detail_ops mark_ops_list[] = {
+	{
+		.token = "id",
+		.offset = offsetof(struct rte_flow_action_mark, id),
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_action_mark_json(const void *conf, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_action_mark *mark = conf;
+
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "id", mark->id);
+	jw_obj_end(jw);
+}
@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_MARK_H_
+#define _PRIMARY_FLOW_ACTION_MARK_H_
+
+extern struct flow_detail_ops mark_ops_list[];
+
+void append_action_mark_json(const void *conf, const char *key,
+	struct json_writer *jw);
+
+#endif
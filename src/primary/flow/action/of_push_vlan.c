@@ -23,22 +23,13 @@ struct flow_detail_ops of_push_vlan_ops_list[] = {
 	},
 };
 
-int
-append_action_of_push_vlan_json(const void *conf, int buf_size,
-	char *action_str)
+void
+append_action_of_push_vlan_json(const void *conf, const char *key,
+	struct json_writer *jw)
 {
 	const struct rte_flow_action_of_push_vlan *of_push_vlan = conf;
-	char tmp_str[64] = { 0 };
 
-	snprintf(tmp_str, 64,
-		"{\"ethertype\":\"0x%04x\"}",
-		of_push_vlan->ethertype);
-
-	if ((int)strlen(action_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(action_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_strf(jw, "ethertype", "0x%04x", of_push_vlan->ethertype);
+	jw_obj_end(jw);
 }
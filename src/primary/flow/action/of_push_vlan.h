@@ -7,7 +7,7 @@
 
 extern struct flow_detail_ops of_push_vlan_ops_list[];
 
-int append_action_of_push_vlan_json(const void *conf, int buf_size,
-	char *action_str);
+void append_action_of_push_vlan_json(const void *conf, const char *key,
+	struct json_writer *jw);
 
 #endif
@@ -23,22 +23,13 @@ struct flow_detail_ops of_set_vlan_pcp_ops_list[] = {
 	},
 };
 
-int
-append_action_of_set_vlan_pcp_json(const void *conf, int buf_size,
-	char *action_str)
+void
+append_action_of_set_vlan_pcp_json(const void *conf, const char *key,
+	struct json_writer *jw)
 {
 	const struct rte_flow_action_of_set_vlan_pcp *pcp = conf;
-	char tmp_str[64] = { 0 };
 
-	snprintf(tmp_str, 64,
-		"{\"vlan_pcp\":\"0x%01x\"}",
-		pcp->vlan_pcp);
-
-	if ((int)strlen(action_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(action_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_strf(jw, "vlan_pcp", "0x%01x", pcp->vlan_pcp);
+	jw_obj_end(jw);
 }
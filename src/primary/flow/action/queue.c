@@ -22,21 +22,13 @@ struct flow_detail_ops queue_ops_list[] = {
 	},
 };
 
-int
-append_action_queue_json(const void *conf, int buf_size, char *action_str)
+void
+append_action_queue_json(const void *conf, const char *key,
+	struct json_writer *jw)
 {
 	const struct rte_flow_action_queue *queue = conf;
-	char tmp_str[64] = { 0 };
 
-	snprintf(tmp_str, 64,
-		"{\"index\":%d}",
-		queue->index);
-
-	if ((int)strlen(action_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(action_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "index", queue->index);
+	jw_obj_end(jw);
 }
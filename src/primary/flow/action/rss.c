@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <inttypes.h>
+#include <rte_flow.h>
+#include <rte_ethdev.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "rss.h"
+
+/* Hash functions of "func" */
+static const char *const rss_func_list[] = {
+	[RTE_ETH_HASH_FUNCTION_DEFAULT] = "default",
+	[RTE_ETH_HASH_FUNCTION_TOEPLITZ] = "toeplitz",
+	[RTE_ETH_HASH_FUNCTION_SIMPLE_XOR] = "simple_xor",
+};
+
+/*
+ * Hash types of "types". Types including others are listed first to be
+ * shown with the shortest names in status.
+ */
+static const struct {
+	const char *str;
+	uint64_t rss_type;
+} rss_type_list[] = {
+	{ "ip", ETH_RSS_IP },
+	{ "udp", ETH_RSS_UDP },
+	{ "tcp", ETH_RSS_TCP },
+	{ "sctp", ETH_RSS_SCTP },
+	{ "ipv4", ETH_RSS_IPV4 },
+	{ "ipv6", ETH_RSS_IPV6 },
+	{ "l2-payload", ETH_RSS_L2_PAYLOAD },
+	{ "vxlan", ETH_RSS_VXLAN },
+};
+
+static int
+parse_rss_func(char *func_str, enum rte_eth_hash_function *func)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_DIM(rss_func_list); i++) {
+		if (!strcmp(func_str, rss_func_list[i])) {
+			*func = i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static int
+parse_rss_type(char *type_str, uint64_t *types)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_DIM(rss_type_list); i++) {
+		if (!strcmp(type_str, rss_type_list[i].str)) {
+			*types |= rss_type_list[i].rss_type;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int
+parse_action_rss(char *token_list[], int *index,
+	struct rte_flow_action *action,
+	struct flow_action_ops *ops)
+{
+	int ret = 0;
+	int i, nof_tokens = 0;
+	char *token;
+	uint16_t *queue;
+	struct rte_flow_action_rss *rss;
+
+	/*
+	 * Queues are placed following the conf to be freed with it. Tokens
+	 * of the action are enough for the num of queues.
+	 */
+	for (i = *index + 1; token_list[i] != NULL; i++) {
+		if (!strcmp(token_list[i], "/"))
+			break;
+		nof_tokens++;
+	}
+
+	rss = malloc(sizeof(*rss) + sizeof(uint16_t) * nof_tokens);
+	if (rss == NULL) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"Memory allocation failure(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+	memset(rss, 0, sizeof(*rss));
+	queue = (uint16_t *)(rss + 1);
+	rss->queue = queue;
+
+	/* Next to word */
+	(*index)++;
+
+	while (token_list[*index] != NULL) {
+		token = token_list[*index];
+
+		/* Exit if "/" */
+		if (!strcmp(token, "/"))
+			break;
+
+		(*index)++;
+		if (token_list[*index] == NULL) {
+			ret = -1;
+		} else if (!strcmp(token, "func")) {
+			ret = parse_rss_func(token_list[*index], &rss->func);
+		} else if (!strcmp(token, "level")) {
+			ret = str_to_uint32_t(token_list[*index],
+				&rss->level);
+		} else if (!strcmp(token, "types")) {
+			/* List of types terminated with "end" */
+			while (token_list[*index] != NULL &&
+					strcmp(token_list[*index], "end")) {
+				ret = parse_rss_type(token_list[*index],
+					&rss->types);
+				if (ret != 0)
+					break;
+				(*index)++;
+			}
+			if (token_list[*index] == NULL)
+				ret = -1;
+		} else if (!strcmp(token, "queues")) {
+			/* List of queues terminated with "end" */
+			while (token_list[*index] != NULL &&
+					strcmp(token_list[*index], "end")) {
+				ret = str_to_uint16_t(token_list[*index],
+					&queue[rss->queue_num]);
+				if (ret != 0)
+					break;
+				rss->queue_num++;
+				(*index)++;
+			}
+			if (token_list[*index] == NULL)
+				ret = -1;
+		} else {
+			ret = -1;
+		}
+
+		if (ret != 0) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid \"%s\" action arguments \"%s\""
+				"(%s:%d)\n",
+				ops->str_type, token, __func__, __LINE__);
+			ret = -1;
+			break;
+		}
+
+		(*index)++;
+	}
+
+	/* Free memory allocated in case of failure. */
+	if (ret != 0) {
+		free(rss);
+		rss = NULL;
+	}
+
+	/* Parse result to action. */
+	action->conf = rss;
+
+	return ret;
+}
+
+void
+append_action_rss_json(const void *conf, const char *key,
+	struct json_writer *jw)
+{
+	uint32_t i;
+	uint64_t types;
+	const struct rte_flow_action_rss *rss = conf;
+
+	jw_obj_begin(jw, key);
+
+	if ((unsigned int)rss->func < RTE_DIM(rss_func_list))
+		jw_str(jw, "func", rss_func_list[rss->func]);
+	else
+		jw_uint(jw, "func", rss->func);
+
+	jw_uint(jw, "level", rss->level);
+
+	/* Show names of types, and the rest not named as a number. */
+	types = rss->types;
+	jw_arr_begin(jw, "types");
+	for (i = 0; i < RTE_DIM(rss_type_list); i++) {
+		if ((types & rss_type_list[i].rss_type) ==
+				rss_type_list[i].rss_type) {
+			jw_str(jw, NULL, rss_type_list[i].str);
+			types &= ~rss_type_list[i].rss_type;
+		}
+	}
+	if (types != 0)
+		jw_strf(jw, NULL, "0x%"PRIx64, types);
+	jw_arr_end(jw);
+
+	jw_arr_begin(jw, "queues");
+	for (i = 0; i < rss->queue_num; i++)
+		jw_uint(jw, NULL, rss->queue[i]);
+	jw_arr_end(jw);
+
+	jw_obj_end(jw);
+}
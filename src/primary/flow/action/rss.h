@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_RSS_H_
+#define _PRIMARY_FLOW_ACTION_RSS_H_
+
+/*
+ * Parse action "rss". Queues are given as a list terminated with "end",
+ * and so are hash types, for example
+ *   rss types ip udp end queues 0 1 2 3 end
+ */
+int parse_action_rss(char *token_list[], int *index,
+	struct rte_flow_action *action,
+	struct flow_action_ops *ops);
+
+void append_action_rss_json(const void *conf, const char *key,
+	struct json_writer *jw);
+
+#endif
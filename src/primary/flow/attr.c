@@ -80,26 +80,15 @@ parse_flow_attr(char *token_list[], int *index,
 	return ret;
 }
 
-int
-append_flow_attr_json(const struct rte_flow_attr *attr, int buf_size,
-	char *attr_str)
+void
+append_flow_attr_json(const struct rte_flow_attr *attr, const char *key,
+	struct json_writer *jw)
 {
-	char tmp_str[128] = { 0 };
-
-	snprintf(tmp_str, 128,
-		"{\"group\":%d,"
-		"\"priority\":%d,"
-		"\"ingress\":%d,"
-		"\"egress\":%d,"
-		"\"transfer\":%d}",
-		attr->group, attr->priority, attr->ingress,
-		attr->egress, attr->transfer);
-
-	if ((int)strlen(attr_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(attr_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "group", attr->group);
+	jw_uint(jw, "priority", attr->priority);
+	jw_uint(jw, "ingress", attr->ingress);
+	jw_uint(jw, "egress", attr->egress);
+	jw_uint(jw, "transfer", attr->transfer);
+	jw_obj_end(jw);
 }
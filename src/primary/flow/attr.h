@@ -5,9 +5,11 @@
 #ifndef _PRIMARY_FLOW_ATTR_H_
 #define _PRIMARY_FLOW_ATTR_H_
 
+#include "shared/json_writer.h"
+
 int parse_flow_attr(char *token_list[], int *index,
 	struct rte_flow_attr *attr);
-int append_flow_attr_json(const struct rte_flow_attr *attr,
-	int buf_size, char *attr_str);
+void append_flow_attr_json(const struct rte_flow_attr *attr,
+	const char *key, struct json_writer *jw);
 
 #endif
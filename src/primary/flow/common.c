@@ -2,6 +2,7 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <arpa/inet.h>
 #include <rte_ethdev.h>
 
 #include "shared/secondary/spp_worker_th/data_types.h"
@@ -282,6 +283,76 @@ str_to_uint32_t(char *target_str, void *output)
 	return 0;
 }
 
+/*
+ * Convert string to uint8_t.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_uint8_t(char *target_str, void *output)
+{
+	char *end;
+	unsigned long value;
+
+	value = strtoul(target_str, &end, 0);
+	if (end == NULL || *end != '\0' || value > UINT8_MAX)
+		return -1;
+
+	*(uint8_t *)output = (uint8_t)value;
+	return 0;
+}
+
+/*
+ * Convert dotted decimal string of IPv4 address to rte_be32_t.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_ipv4_addr(char *addr_str, void *output)
+{
+	if (inet_pton(AF_INET, addr_str, output) != 1)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Convert string of IPv6 address to 16 bytes in network order.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_ipv6_addr(char *addr_str, void *output)
+{
+	if (inet_pton(AF_INET6, addr_str, output) != 1)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Convert string to VNI of VXLAN, which is 24bits in network order.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_vni(char *vni_str, void *output)
+{
+	char *end;
+	unsigned long vni;
+	uint8_t *vni_bytes = output;
+
+	vni = strtoul(vni_str, &end, 0);
+	if (end == NULL || *end != '\0' || vni > 0xffffff)
+		return -1;
+
+	vni_bytes[0] = (uint8_t)(vni >> 16);
+	vni_bytes[1] = (uint8_t)(vni >> 8);
+	vni_bytes[2] = (uint8_t)vni;
+
+	return 0;
+}
+
 int
 parse_rte_flow_item_field(char *token_list[], int *index,
 	struct flow_detail_ops *detail_list, size_t size,
@@ -527,6 +598,8 @@ parse_item_common(char *token_list[], int *index,
 
 		if (mask != NULL)
 			free(mask);
+
+		spec = last = mask = NULL;
 	}
 
 	/* Parse result to item. */
@@ -615,19 +688,11 @@ parse_action_common(char *token_list[], int *index,
 }
 
 /* Append action json, conf field is null */
-int
+void
 append_action_null_json(const void *conf __attribute__ ((unused)),
-	int buf_size, char *action_str)
+	const char *key, struct json_writer *jw)
 {
-	char null_str[] = "null";
-
-	if ((int)strlen(action_str) + (int)strlen(null_str)
-		> buf_size)
-		return -1;
-
-	strncat(action_str, null_str, strlen(null_str));
-
-	return 0;
+	jw_null(jw, key);
 }
 
 int
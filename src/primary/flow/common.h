@@ -17,6 +17,10 @@ int str_to_pcp(char *pcp_str, void *output);
 int str_to_rte_be16_t(char *target_str, void *output);
 int str_to_uint16_t(char *target_str, void *output);
 int str_to_uint32_t(char *target_str, void *output);
+int str_to_uint8_t(char *target_str, void *output);
+int str_to_ipv4_addr(char *addr_str, void *output);
+int str_to_ipv6_addr(char *addr_str, void *output);
+int str_to_vni(char *vni_str, void *output);
 
 /* Functions for setting string to data */
 int set_pcp_in_tci(char *pcp_str, void *output);
@@ -45,7 +49,8 @@ int parse_action_common(char *token_list[], int *index,
 	struct flow_action_ops *ops);
 
 /* Append action json, conf field is null */
-int append_action_null_json(const void *conf, int buf_size, char *action_str);
+void append_action_null_json(const void *conf, const char *key,
+	struct json_writer *jw);
 
 /* Allocate memory for the size */
 int malloc_object(void **ptr, size_t size);
@@ -17,12 +17,20 @@
 
 #include "primary/flow/pattern/eth.h"
 #include "primary/flow/pattern/vlan.h"
+#include "primary/flow/pattern/ipv4.h"
+#include "primary/flow/pattern/ipv6.h"
+#include "primary/flow/pattern/udp.h"
+#include "primary/flow/pattern/tcp.h"
+#include "primary/flow/pattern/vxlan.h"
 
 #include "primary/flow/action/jump.h"
 #include "primary/flow/action/queue.h"
 #include "primary/flow/action/of_push_vlan.h"
 #include "primary/flow/action/of_set_vlan_vid.h"
 #include "primary/flow/action/of_set_vlan_pcp.h"
+#include "primary/flow/action/rss.h"
+#include "primary/flow/action/count.h"
+#include "primary/flow/action/mark.h"
 
 
 /* Flow list for each port */
@@ -52,6 +60,46 @@ static struct flow_item_ops flow_item_ops_list[] = {
 		.detail_list = vlan_ops_list,
 		.status = append_item_vlan_json,
 	},
+	{
+		.str_type = "ipv4",
+		.type = RTE_FLOW_ITEM_TYPE_IPV4,
+		.size = sizeof(struct rte_flow_item_ipv4),
+		.parse = parse_item_common,
+		.detail_list = ipv4_ops_list,
+		.status = append_item_ipv4_json,
+	},
+	{
+		.str_type = "ipv6",
+		.type = RTE_FLOW_ITEM_TYPE_IPV6,
+		.size = sizeof(struct rte_flow_item_ipv6),
+		.parse = parse_item_common,
+		.detail_list = ipv6_ops_list,
+		.status = append_item_ipv6_json,
+	},
+	{
+		.str_type = "udp",
+		.type = RTE_FLOW_ITEM_TYPE_UDP,
+		.size = sizeof(struct rte_flow_item_udp),
+		.parse = parse_item_common,
+		.detail_list = udp_ops_list,
+		.status = append_item_udp_json,
+	},
+	{
+		.str_type = "tcp",
+		.type = RTE_FLOW_ITEM_TYPE_TCP,
+		.size = sizeof(struct rte_flow_item_tcp),
+		.parse = parse_item_common,
+		.detail_list = tcp_ops_list,
+		.status = append_item_tcp_json,
+	},
+	{
+		.str_type = "vxlan",
+		.type = RTE_FLOW_ITEM_TYPE_VXLAN,
+		.size = sizeof(struct rte_flow_item_vxlan),
+		.parse = parse_item_common,
+		.detail_list = vxlan_ops_list,
+		.status = append_item_vxlan_json,
+	},
 };
 
 /* Define action operations */
@@ -112,22 +160,43 @@ static struct flow_action_ops flow_action_ops_list[] = {
 		.detail_list = of_set_vlan_pcp_ops_list,
 		.status = append_action_of_set_vlan_pcp_json,
 	},
+	{
+		.str_type = "rss",
+		.type = RTE_FLOW_ACTION_TYPE_RSS,
+		.size = sizeof(struct rte_flow_action_rss),
+		.parse = parse_action_rss,
+		.detail_list = NULL,
+		.status = append_action_rss_json,
+	},
+	{
+		.str_type = "count",
+		.type = RTE_FLOW_ACTION_TYPE_COUNT,
+		.size = sizeof(struct rte_flow_action_count),
+		.parse = parse_action_common,
+		.detail_list = count_ops_list,
+		.status = append_action_count_json,
+		.query = append_action_count_query_json,
+	},
+	{
+		.str_type = "mark",
+		.type = RTE_FLOW_ACTION_TYPE_MARK,
+		.size = sizeof(struct rte_flow_action_mark),
+		.parse = parse_action_common,
+		.detail_list = mark_ops_list,
+		.status = append_action_mark_json,
+	},
 };
 
-/* Free memory of "flow_args". */
+/* Free memory of a rule of "flow_args". */
 static void
-free_flow_args(struct flow_args *input)
+free_flow_rule_args(struct flow_rule_args *rule)
 {
 	int i;
 	struct rte_flow_item *pattern;
 	struct rte_flow_action *actions;
 	char **target;
 
-	if ((input->command != VALIDATE) &&
-		(input->command != CREATE))
-		return;
-
-	pattern = input->args.rule.pattern;
+	pattern = rule->pattern;
 	if (pattern != NULL) {
 		for (i = 0; pattern[i].type != RTE_FLOW_ITEM_TYPE_END; i++) {
 			target = (char **)((char *)(&pattern[i]) +
@@ -149,7 +218,7 @@ free_flow_args(struct flow_args *input)
 		free(pattern);
 	}
 
-	actions = input->args.rule.actions;
+	actions = rule->actions;
 	if (actions != NULL) {
 		for (i = 0; actions[i].type != RTE_FLOW_ACTION_TYPE_END; i++) {
 			target = (char **)((char *)(&actions[i]) +
@@ -162,28 +231,50 @@ free_flow_args(struct flow_args *input)
 	}
 }
 
+/* Free memory of "flow_args". */
+static void
+free_flow_args(struct flow_args *input)
+{
+	int i;
+
+	switch (input->command) {
+	case VALIDATE:
+	case CREATE:
+		if (input->args.rule.rules == NULL)
+			break;
+		for (i = 0; i < input->args.rule.nof_rules; i++)
+			free_flow_rule_args(&input->args.rule.rules[i]);
+		free(input->args.rule.rules);
+		input->args.rule.rules = NULL;
+		break;
+	case DESTROY:
+		free(input->args.destroy.rule_ids);
+		input->args.destroy.rule_ids = NULL;
+		break;
+	default:
+		break;
+	}
+}
+
 /*
  * Create response in JSON format.
  * `rule_id` must be empty if flow create is failed.
  */
 static void
-make_response(char *response, const char *result, const char *message,
-	char *rule_id)
+make_response(struct json_writer *response, const char *result,
+	const char *message, char *rule_id)
 {
-	if (rule_id == NULL)
-		snprintf(response, MSG_SIZE,
-			"{\"result\": \"%s\", \"message\": \"%s\"}",
-			result, message);
-	else
-		snprintf(response, MSG_SIZE,
-			"{\"result\": \"%s\", \"message\": \"%s\", "
-			"\"rule_id\": \"%s\"}",
-			result, message, rule_id);
+	jw_obj_begin(response, NULL);
+	jw_str(response, "result", result);
+	jw_str(response, "message", message);
+	if (rule_id != NULL)
+		jw_str(response, "rule_id", rule_id);
+	jw_obj_end(response);
 }
 
 /* Create error response from rte_flow_error */
 static void
-make_error_response(char *response, const char *message,
+make_error_response(struct json_writer *response, const char *message,
 	struct rte_flow_error error, char *rule_id)
 {
 	/* Define description for each error type */
@@ -219,11 +310,11 @@ make_error_response(char *response, const char *message,
 
 
 	if (error.cause != NULL)
-		snprintf(cause, sizeof(cause), "cause: %p\\n", error.cause);
+		snprintf(cause, sizeof(cause), "cause: %p\n", error.cause);
 
 	snprintf(msg, sizeof(msg),
-		"%s\\nerror type: %d (%s)\\n"
-		"%serror message: %s\\nrte_errno: %s",
+		"%s\nerror type: %d (%s)\n"
+		"%serror message: %s\nrte_errno: %s",
 		message, error.type, errstr, cause,
 		error.message ? error.message : "(no stated reason)",
 		rte_strerror(err));
@@ -377,11 +468,17 @@ parse_flow_pattern(char *token_list[], int *index,
 	return 0;
 }
 
+/*
+ * Parse rules following the port. Each of rules consists of attributes,
+ * pattern and actions, and the next rule starts after "end" of actions.
+ */
 static int
-parse_flow_rule(char *token_list[], struct flow_args *input)
+parse_flow_rules(char *token_list[], struct flow_args *input)
 {
 	int ret = 0;
-	int index;
+	int index, i;
+	int nof_rules = 0;
+	struct flow_rule_args *rule;
 
 	ret = parse_phy_port_id(token_list[2], &input->port_id);
 	if (ret < 0)
@@ -390,38 +487,74 @@ parse_flow_rule(char *token_list[], struct flow_args *input)
 	/* The next index of the port */
 	index = 3;
 
-	/* Attribute parse */
-	ret = parse_flow_attr(token_list, &index, &input->args.rule.attr);
-	if (ret < 0) {
+	/* Each of rules has "actions" once. */
+	for (i = index; token_list[i] != NULL; i++) {
+		if (!strcmp(token_list[i], "actions"))
+			nof_rules++;
+	}
+	if (nof_rules == 0) {
 		RTE_LOG(ERR, SPP_FLOW,
-			"Failed to parse Attribute(%s:%d)\n",
+			"Actions are not specified(%s:%d)\n",
 			__func__, __LINE__);
 		return -1;
 	}
 
-	/* The next index of the pattern */
-	index++;
-
-	/* Pattern parse */
-	ret = parse_flow_pattern(token_list, &index,
-		&input->args.rule.pattern);
-	if (ret < 0) {
+	input->args.rule.rules = calloc(nof_rules,
+		sizeof(struct flow_rule_args));
+	if (input->args.rule.rules == NULL) {
 		RTE_LOG(ERR, SPP_FLOW,
-			"Failed to parse Pattern(%s:%d)\n",
+			"Memory allocation failure(%s:%d)\n",
 			__func__, __LINE__);
 		return -1;
 	}
 
-	/* The next index of the actions */
-	index++;
+	for (i = 0; i < nof_rules; i++) {
+		rule = &input->args.rule.rules[i];
+
+		/* Count it before parsed to be freed even if failed. */
+		input->args.rule.nof_rules++;
+
+		/* Attribute parse */
+		ret = parse_flow_attr(token_list, &index, &rule->attr);
+		if (ret < 0) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Failed to parse Attribute(%s:%d)\n",
+				__func__, __LINE__);
+			return -1;
+		}
+
+		/* The next index of the pattern */
+		index++;
+
+		/* Pattern parse */
+		ret = parse_flow_pattern(token_list, &index, &rule->pattern);
+		if (ret < 0 || token_list[index] == NULL) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Failed to parse Pattern(%s:%d)\n",
+				__func__, __LINE__);
+			return -1;
+		}
+
+		/* The next index of the actions */
+		index++;
 
-	/* Actions parse */
-	ret = parse_flow_actions(token_list, &index,
-		&input->args.rule.actions);
-	if (ret < 0) {
+		/*
+		 * Actions parse. The index is moved to the next of "end",
+		 * which is attributes of the next rule.
+		 */
+		ret = parse_flow_actions(token_list, &index, &rule->actions);
+		if (ret < 0 || strcmp(token_list[index - 1], "end")) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Failed to parse Actions(%s:%d)\n",
+				__func__, __LINE__);
+			return -1;
+		}
+	}
+
+	if (token_list[index] != NULL) {
 		RTE_LOG(ERR, SPP_FLOW,
-			"Failed to parse Actions(%s:%d)\n",
-			__func__, __LINE__);
+			"Invalid parameter is %s(%s:%d)\n",
+			token_list[index], __func__, __LINE__);
 		return -1;
 	}
 
@@ -432,6 +565,8 @@ static int
 parse_flow_destroy(char *token_list[], struct flow_args *input)
 {
 	int ret;
+	int i, nof_rule_ids = 0;
+	unsigned long rule_id;
 	char *end;
 
 	ret = parse_phy_port_id(token_list[2], &input->port_id);
@@ -447,12 +582,66 @@ parse_flow_destroy(char *token_list[], struct flow_args *input)
 
 	if (!strcmp(token_list[3], "ALL")) {
 		input->command = FLUSH;
+		return 0;
+	}
 
-	} else {
-		input->command = DESTROY;
-		input->args.destroy.rule_id = strtoul(token_list[3],
-			&end, 10);
+	input->command = DESTROY;
+
+	for (i = 3; token_list[i] != NULL; i++)
+		nof_rule_ids++;
+
+	input->args.destroy.rule_ids = malloc(sizeof(uint32_t) *
+		nof_rule_ids);
+	if (input->args.destroy.rule_ids == NULL) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"Memory allocation failure(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < nof_rule_ids; i++) {
+		rule_id = strtoul(token_list[i + 3], &end, 10);
+		if (*end != '\0' || rule_id > UINT32_MAX) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid rule_id %s(%s:%d)\n",
+				token_list[i + 3], __func__, __LINE__);
+			return -1;
+		}
+		input->args.destroy.rule_ids[i] = rule_id;
+	}
+	input->args.destroy.nof_rule_ids = nof_rule_ids;
+
+	return 0;
+}
+
+/* Parse `flow list phy:0 [START_ID [MAX_RULES]]`. */
+static int
+parse_flow_list(char *token_list[], struct flow_args *input)
+{
+	int ret;
+	int i;
+	unsigned long val[2] = { 0, FLOW_LIST_MAX_RULES };
+	char *end;
+
+	ret = parse_phy_port_id(token_list[2], &input->port_id);
+	if (ret < 0)
+		return -1;
+
+	for (i = 0; i < 2 && token_list[i + 3] != NULL; i++) {
+		val[i] = strtoul(token_list[i + 3], &end, 10);
+		if (*end != '\0' || val[i] > UINT32_MAX) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid parameter is %s(%s:%d)\n",
+				token_list[i + 3], __func__, __LINE__);
+			return -1;
+		}
 	}
+	if (token_list[i + 3] != NULL)
+		return -1;
+
+	input->args.list.start_id = val[0];
+	input->args.list.max_rules = RTE_MIN(val[1],
+		(unsigned long)FLOW_LIST_MAX_RULES);
 
 	return 0;
 }
@@ -494,102 +683,378 @@ create_flow_rule(struct rte_flow_attr *attr,
 	return NULL;
 }
 
-/* Execute rte_flow_validate().*/
 static void
-exec_flow_validate(int port_id,
-	struct rte_flow_attr *attr,
-	struct rte_flow_item *pattern,
-	struct rte_flow_action *actions,
-	char *response)
+append_flow_pattern_json(const struct rte_flow_item *pattern,
+	const char *key, struct json_writer *jw)
 {
-	int ret;
-	struct rte_flow_error error;
+	uint32_t i, j;
+	uint32_t nof_elems = 3;
+	const char element_str[][5] = { "spec", "last", "mask" };
+	const struct rte_flow_item *ptn;
+	struct flow_item_ops *ops;
+	const void *tmp_ptr[nof_elems];
 
-	memset(&error, 0, sizeof(error));
+	jw_arr_begin(jw, key);
+	for (ptn = pattern; ptn->type != RTE_FLOW_ITEM_TYPE_END; ptn++) {
+		tmp_ptr[0] = ptn->spec;
+		tmp_ptr[1] = ptn->last;
+		tmp_ptr[2] = ptn->mask;
 
-	ret = rte_flow_validate(port_id, attr, pattern, actions, &error);
-	if (ret != 0)
-		make_error_response(response, "Flow validate error", error,
-			NULL);
+		for (i = 0; i < RTE_DIM(flow_item_ops_list); i++) {
+			ops = &flow_item_ops_list[i];
+			if (ptn->type != ops->type)
+				continue;
+
+			jw_obj_begin(jw, NULL);
+			jw_str(jw, "type", ops->str_type);
+			for (j = 0; j < nof_elems; j++) {
+				if (tmp_ptr[j] != NULL)
+					ops->status(tmp_ptr[j], element_str[j],
+						jw);
+				else
+					jw_null(jw, element_str[j]);
+			}
+			jw_obj_end(jw);
+			break;
+		}
+	}
+	jw_arr_end(jw);
+}
+
+/* Results of queryable actions such as count are appended as "query". */
+static void
+append_flow_action_json(int port_id, struct rte_flow *flow,
+	const struct rte_flow_action *actions,
+	const char *key, struct json_writer *jw)
+{
+	uint32_t i;
+	const struct rte_flow_action *act;
+	struct flow_action_ops *ops;
+
+	jw_arr_begin(jw, key);
+	for (act = actions; act->type != RTE_FLOW_ACTION_TYPE_END; act++) {
+		for (i = 0; i < RTE_DIM(flow_action_ops_list); i++) {
+			ops = &flow_action_ops_list[i];
+			if (act->type != ops->type)
+				continue;
+
+			jw_obj_begin(jw, NULL);
+			jw_str(jw, "type", ops->str_type);
+			ops->status(act->conf, "conf", jw);
+			if (ops->query != NULL)
+				ops->query(port_id, flow, act, "query", jw);
+			jw_obj_end(jw);
+			break;
+		}
+	}
+	jw_arr_end(jw);
+}
+
+static void
+append_flow_rule_json(int port_id, struct flow_rule *flow,
+	struct json_writer *jw)
+{
+	struct rte_flow_conv_rule *rule = &flow->rule;
+
+	jw_obj_begin(jw, NULL);
+	jw_uint(jw, "rule_id", flow->rule_id);
+	append_flow_attr_json(rule->attr_ro, "attr", jw);
+	append_flow_pattern_json(rule->pattern_ro, "patterns", jw);
+	append_flow_action_json(port_id, flow->flow_handle, rule->actions_ro,
+		"actions", jw);
+	jw_obj_end(jw);
+}
+
+static inline struct flow_rule **
+flow_table_bucket(struct port_flow *port, uint32_t rule_id)
+{
+	return &port->buckets[rule_id & (port->nof_buckets - 1)];
+}
+
+/* Find a flow of the rule ID, or return NULL if not found. */
+static struct flow_rule *
+flow_table_find(struct port_flow *port, uint32_t rule_id)
+{
+	struct flow_rule *rule;
+
+	if (port->buckets == NULL)
+		return NULL;
+
+	for (rule = *flow_table_bucket(port, rule_id); rule != NULL;
+			rule = rule->hash_next) {
+		if (rule->rule_id == rule_id)
+			return rule;
+	}
+	return NULL;
+}
+
+/* Allocate buckets at first, or double them to keep chains short. */
+static int
+flow_table_grow(struct port_flow *port)
+{
+	struct flow_rule **old_buckets = port->buckets;
+	struct flow_rule **new_buckets, **bucket;
+	struct flow_rule *rule, *next;
+	uint32_t old_size = port->nof_buckets;
+	uint32_t new_size, i;
+
+	new_size = old_size ? old_size * 2 : FLOW_TABLE_INIT_SIZE;
+	new_buckets = calloc(new_size, sizeof(*new_buckets));
+	if (new_buckets == NULL)
+		return -1;
+
+	port->buckets = new_buckets;
+	port->nof_buckets = new_size;
+
+	for (i = 0; i < old_size; i++) {
+		for (rule = old_buckets[i]; rule != NULL; rule = next) {
+			next = rule->hash_next;
+			bucket = flow_table_bucket(port, rule->rule_id);
+			rule->hash_next = *bucket;
+			*bucket = rule;
+		}
+	}
+	free(old_buckets);
+
+	return 0;
+}
+
+/* Add a flow to the rule table and to the tail of the list. */
+static int
+flow_table_add(struct port_flow *port, struct flow_rule *rule)
+{
+	struct flow_rule **bucket;
+
+	/* Chains get longer if failed to grow, but it still works. */
+	if (port->nof_rules >= port->nof_buckets &&
+			flow_table_grow(port) < 0 && port->buckets == NULL)
+		return -1;
+
+	bucket = flow_table_bucket(port, rule->rule_id);
+	rule->hash_next = *bucket;
+	*bucket = rule;
+
+	rule->prev = port->tail;
+	rule->next = NULL;
+	if (port->tail != NULL)
+		port->tail->next = rule;
 	else
-		make_response(response, "success", "Flow rule validated",
-			NULL);
+		port->head = rule;
+	port->tail = rule;
+
+	port->nof_rules++;
+	return 0;
 }
 
-/* Execute rte_flow_create(). Save flow rules globally */
+/* Remove a flow from the rule table and the list, it is not freed. */
 static void
-exec_flow_create(int port_id,
-	struct rte_flow_attr *attr,
-	struct rte_flow_item *pattern,
-	struct rte_flow_action *actions,
-	char *response)
+flow_table_del(struct port_flow *port, struct flow_rule *rule)
 {
-	uint32_t rule_id;
-	char mes[32];
-	char rule_id_str[11] = {0};
-	struct rte_flow_error error;
+	struct flow_rule **next_ptr;
+
+	next_ptr = flow_table_bucket(port, rule->rule_id);
+	while (*next_ptr != rule)
+		next_ptr = &((*next_ptr)->hash_next);
+	*next_ptr = rule->hash_next;
+
+	if (rule->prev != NULL)
+		rule->prev->next = rule->next;
+	else
+		port->head = rule->next;
+
+	if (rule->next != NULL)
+		rule->next->prev = rule->prev;
+	else
+		port->tail = rule->prev;
+
+	port->nof_rules--;
+}
+
+/* Free all of flows and the table. Rule IDs are assigned from 0 again. */
+static void
+flow_table_clear(struct port_flow *port)
+{
+	struct flow_rule *rule, *next;
+
+	for (rule = port->head; rule != NULL; rule = next) {
+		next = rule->next;
+		free(rule);
+	}
+	free(port->buckets);
+	memset(port, 0, sizeof(*port));
+}
+
+/*
+ * Create a flow on the port and add it to the rule table. Return NULL and
+ * set `error` if failed.
+ */
+static struct flow_rule *
+add_port_flow(int port_id, struct flow_rule_args *args,
+	struct rte_flow_error *error)
+{
+	struct port_flow *port = &port_list[port_id];
 	struct rte_flow *flow;
 	struct flow_rule *rule;
-	struct port_flow *port;
 
-	memset(&error, 0, sizeof(error));
+	if (port->next_rule_id == UINT32_MAX) {
+		rte_flow_error_set(error, ENOSPC,
+			RTE_FLOW_ERROR_TYPE_UNSPECIFIED, NULL,
+			"Rule ID must be less than 4294967295");
+		return NULL;
+	}
 
-	flow = rte_flow_create(port_id, attr, pattern, actions, &error);
-	if (flow == NULL) {
-		make_error_response(response, "Flow create error", error,
-			rule_id_str);
+	flow = rte_flow_create(port_id, &args->attr, args->pattern,
+		args->actions, error);
+	if (flow == NULL)
+		return NULL;
+
+	rule = create_flow_rule(&args->attr, args->pattern, args->actions,
+		error);
+	if (rule == NULL) {
+		rte_flow_destroy(port_id, flow, NULL);
+		return NULL;
+	}
+
+	/* Keep it globally in the rule table */
+	rule->rule_id = port->next_rule_id;
+	rule->flow_handle = flow;
+
+	if (flow_table_add(port, rule) < 0) {
+		rte_flow_destroy(port_id, flow, NULL);
+		free(rule);
+		rte_flow_error_set(error, ENOMEM,
+			RTE_FLOW_ERROR_TYPE_UNSPECIFIED, NULL,
+			"calloc() failed");
+		return NULL;
+	}
+
+	port->next_rule_id++;
+	return rule;
+}
+
+/* Execute rte_flow_validate() for each of rules. */
+static void
+exec_flow_validate(int port_id, struct flow_rule_args *rules,
+	int nof_rules, struct json_writer *response)
+{
+	int i;
+	int ret;
+	char mes[64];
+	struct rte_flow_error error;
+
+	for (i = 0; i < nof_rules; i++) {
+		memset(&error, 0, sizeof(error));
+
+		ret = rte_flow_validate(port_id, &rules[i].attr,
+			rules[i].pattern, rules[i].actions, &error);
+		if (ret == 0)
+			continue;
+
+		if (nof_rules == 1)
+			sprintf(mes, "Flow validate error");
+		else
+			sprintf(mes, "Flow validate error of rule %d", i);
+		make_error_response(response, mes, error, NULL);
 		return;
 	}
 
-	port = &port_list[port_id];
-	if (port->flow_list != NULL) {
-		if (port->flow_list->rule_id >= UINT32_MAX) {
-			make_response(response, "error",
-				"Rule ID must be less than %"PRIu32,
-				rule_id_str);
-			rte_flow_destroy(port_id, flow, NULL);
-			return;
-		}
-		rule_id = port->flow_list->rule_id + 1;
+	if (nof_rules == 1) {
+		make_response(response, "success", "Flow rule validated",
+			NULL);
 	} else {
-		rule_id = 0;
+		sprintf(mes, "%d flow rules validated", nof_rules);
+		make_response(response, "success", mes, NULL);
 	}
+}
 
-	rule = create_flow_rule(attr, pattern, actions, &error);
-	if (rule == NULL) {
-		rte_flow_destroy(port_id, flow, NULL);
-		make_error_response(response, "Flow create error", error,
+/*
+ * Execute rte_flow_create() for each of rules. Save flow rules globally.
+ * If one of them is failed, created ones in this command are destroyed
+ * for onboarding all of rules of a tenant at once or nothing.
+ */
+static void
+exec_flow_create(int port_id, struct flow_rule_args *rules,
+	int nof_rules, struct json_writer *response)
+{
+	int i;
+	char mes[64];
+	char rule_id_str[11] = {0};
+	struct rte_flow_error error;
+	struct flow_rule **created;
+	struct port_flow *port = &port_list[port_id];
+
+	created = malloc(sizeof(*created) * nof_rules);
+	if (created == NULL) {
+		make_response(response, "error", "Memory allocation failure",
 			rule_id_str);
 		return;
 	}
 
-	/* Keep it globally as a list */
-	rule->rule_id = rule_id;
-	rule->flow_handle = flow;
+	for (i = 0; i < nof_rules; i++) {
+		memset(&error, 0, sizeof(error));
+		created[i] = add_port_flow(port_id, &rules[i], &error);
+		if (created[i] == NULL)
+			break;
+	}
 
-	if (port->flow_list == NULL)
-		rule->prev = NULL;
-	else
-		rule->prev = port->flow_list;
+	if (i < nof_rules) {
+		if (nof_rules == 1) {
+			make_error_response(response, "Flow create error",
+				error, rule_id_str);
+		} else {
+			sprintf(mes, "Flow create error of rule %d", i);
+			make_error_response(response, mes, error, NULL);
+		}
+
+		/* Created ones are the newest, so IDs can be reused. */
+		if (i > 0)
+			port->next_rule_id = created[0]->rule_id;
+		while (--i >= 0) {
+			rte_flow_destroy(port_id, created[i]->flow_handle,
+				NULL);
+			flow_table_del(port, created[i]);
+			free(created[i]);
+		}
+		free(created);
+		return;
+	}
 
-	port->flow_list = rule;
+	if (nof_rules == 1) {
+		sprintf(mes, "Flow rule #%u created", created[0]->rule_id);
+		sprintf(rule_id_str, "%u", created[0]->rule_id);
+		make_response(response, "success", mes, rule_id_str);
+	} else {
+		jw_obj_begin(response, NULL);
+		jw_str(response, "result", "success");
+		jw_strf(response, "message", "%d flow rules created",
+			nof_rules);
+		jw_arr_begin(response, "rule_ids");
+		for (i = 0; i < nof_rules; i++)
+			jw_uint(response, NULL, created[i]->rule_id);
+		jw_arr_end(response);
+		jw_obj_end(response);
+	}
 
-	sprintf(mes, "Flow rule #%d created", rule_id);
-	sprintf(rule_id_str, "%d", rule_id);
-	make_response(response, "success", mes, rule_id_str);
+	free(created);
 }
 
-/* Execute rte_flow_destroy(). Destroying a globally saved flow rule */
+/*
+ * Execute rte_flow_destroy() for each of rule IDs. Destroying globally
+ * saved flow rules. Rest of rules are destroyed even if one of them is
+ * failed, and the first failure is responded.
+ */
 static void
-exec_flow_destroy(int port_id, uint32_t rule_id, char *response)
+exec_flow_destroy(int port_id, uint32_t *rule_ids, int nof_rule_ids,
+	struct json_writer *response)
 {
+	int i;
 	int ret;
-	int found_flg = 0;
+	int nof_destroyed = 0;
 	char mes[64];
-	struct flow_rule *rule, **next_ptr;
-	struct rte_flow_error error;
-
-	memset(&error, 0, sizeof(error));
+	char failure[64] = "";
+	struct flow_rule *rule;
+	struct port_flow *port = &port_list[port_id];
+	struct rte_flow_error error, first_error;
 
 	ret = is_portid_used(port_id);
 	if (ret != 0) {
@@ -598,47 +1063,61 @@ exec_flow_destroy(int port_id, uint32_t rule_id, char *response)
 		return;
 	}
 
-	next_ptr = &(port_list[port_id].flow_list);
-	rule = port_list[port_id].flow_list;
+	memset(&first_error, 0, sizeof(first_error));
 
-	while (rule != NULL) {
-		if (rule->rule_id != rule_id) {
-			next_ptr = &(rule->prev);
-			rule = rule->prev;
+	for (i = 0; i < nof_rule_ids; i++) {
+		rule = flow_table_find(port, rule_ids[i]);
+		if (rule == NULL) {
+			/* Rule_id not found */
+			if (failure[0] == '\0')
+				sprintf(failure, "Flow rule #%u not found",
+					rule_ids[i]);
 			continue;
 		}
 
+		memset(&error, 0, sizeof(error));
 		ret = rte_flow_destroy(port_id, rule->flow_handle, &error);
 		if (ret != 0) {
-			make_error_response(response, "Flow destroy error",
-				error, NULL);
-			return;
+			if (failure[0] == '\0') {
+				sprintf(failure, "Flow destroy error");
+				first_error = error;
+			}
+			continue;
 		}
 
-		/* Remove flow from global list */
-		*next_ptr = rule->prev;
+		/* Remove flow from global rule table */
+		flow_table_del(port, rule);
 		free(rule);
-		found_flg = 1;
-
-		sprintf(mes, "Flow rule #%d destroyed", rule_id);
-		make_response(response, "success", mes, NULL);
-		break;
+		nof_destroyed++;
 	}
 
-	/* Rule_id not found */
-	if (found_flg == 0) {
-		sprintf(mes, "Flow rule #%d not found", rule_id);
-		make_response(response, "error", mes, NULL);
+	if (failure[0] != '\0') {
+		if (nof_rule_ids > 1)
+			sprintf(mes, "%s, %d of %d destroyed", failure,
+				nof_destroyed, nof_rule_ids);
+		else
+			strcpy(mes, failure);
+
+		if (first_error.type != RTE_FLOW_ERROR_TYPE_NONE)
+			make_error_response(response, mes, first_error, NULL);
+		else
+			make_response(response, "error", mes, NULL);
+		return;
 	}
+
+	if (nof_rule_ids == 1)
+		sprintf(mes, "Flow rule #%u destroyed", rule_ids[0]);
+	else
+		sprintf(mes, "%d flow rules destroyed", nof_destroyed);
+	make_response(response, "success", mes, NULL);
 }
 
 /* Delete all globally saved flow rules */
 static void
-exec_flow_flush(int port_id, char *response)
+exec_flow_flush(int port_id, struct json_writer *response)
 {
 	int ret;
 	char mes[64];
-	struct flow_rule *rule;
 	struct rte_flow_error error;
 
 	memset(&error, 0, sizeof(error));
@@ -660,67 +1139,157 @@ exec_flow_flush(int port_id, char *response)
 
 	/*
 	 * Even if a failure occurs, flow handle is invalidated,
-	 * so delete flow_list.
+	 * so delete rule table.
 	 */
+	flow_table_clear(&port_list[port_id]);
+}
+
+/*
+ * Respond a page of saved flow rules from `start_id`. `next_rule_id` in
+ * the response is given as `start_id` for the next page, or null if no
+ * more rules.
+ */
+static void
+exec_flow_list(int port_id, uint32_t start_id, uint32_t max_rules,
+	struct json_writer *response)
+{
+	int ret;
+	char mes[64];
+	uint32_t nof_rules = 0;
+	struct flow_rule *rule;
+	struct port_flow *port = &port_list[port_id];
 
-	while (port_list[port_id].flow_list != NULL) {
-		rule = port_list[port_id].flow_list->prev;
-		free(port_list[port_id].flow_list);
-		port_list[port_id].flow_list = rule;
+	ret = is_portid_used(port_id);
+	if (ret != 0) {
+		sprintf(mes, "Invalid port %d", port_id);
+		make_response(response, "error", mes, NULL);
+		return;
 	}
+
+	/* Find the next one in ascending order if it is destroyed. */
+	rule = flow_table_find(port, start_id);
+	if (rule == NULL) {
+		for (rule = port->head; rule != NULL; rule = rule->next) {
+			if (rule->rule_id >= start_id)
+				break;
+		}
+	}
+
+	jw_obj_begin(response, NULL);
+	jw_str(response, "result", "success");
+	jw_uint(response, "nof_rules", port->nof_rules);
+	jw_arr_begin(response, "rules");
+	for (; rule != NULL && nof_rules < max_rules; rule = rule->next) {
+		append_flow_rule_json(port_id, rule, response);
+		nof_rules++;
+	}
+	jw_arr_end(response);
+	if (rule != NULL)
+		jw_uint(response, "next_rule_id", rule->rule_id);
+	else
+		jw_null(response, "next_rule_id");
+	jw_obj_end(response);
 }
 
 static void
-exec_flow(struct flow_args *input, char *response)
+exec_flow(struct flow_args *input, struct json_writer *response)
 {
 	switch (input->command) {
 	case VALIDATE:
 		exec_flow_validate(input->port_id,
-			&input->args.rule.attr,
-			input->args.rule.pattern,
-			input->args.rule.actions,
+			input->args.rule.rules,
+			input->args.rule.nof_rules,
 			response);
 		break;
 	case CREATE:
 		exec_flow_create(input->port_id,
-			&input->args.rule.attr,
-			input->args.rule.pattern,
-			input->args.rule.actions,
+			input->args.rule.rules,
+			input->args.rule.nof_rules,
 			response);
 		break;
 	case DESTROY:
 		exec_flow_destroy(input->port_id,
-			input->args.destroy.rule_id,
+			input->args.destroy.rule_ids,
+			input->args.destroy.nof_rule_ids,
 			response);
 		break;
 	case FLUSH:
 		exec_flow_flush(input->port_id, response);
 		break;
+	case LIST:
+		exec_flow_list(input->port_id,
+			input->args.list.start_id,
+			input->args.list.max_rules,
+			response);
+		break;
 	}
 
 	/* Argument data is no longer needed and freed */
 	free_flow_args(input);
 }
 
+/*
+ * Split command into tokens separated with spaces. The list is allocated
+ * for the num of tokens because bulk commands have many of them.
+ */
+static char **
+tokenize_flow_command(char *str)
+{
+	char **token_list;
+	char *p;
+	int nof_tokens = 0;
+
+	/* Tokens are at most the num of separators plus one. */
+	for (p = str; *p != '\0'; p++) {
+		if (*p == ' ')
+			nof_tokens++;
+	}
+
+	token_list = malloc(sizeof(char *) * (nof_tokens + 2));
+	if (token_list == NULL)
+		return NULL;
+
+	nof_tokens = 0;
+	token_list[nof_tokens] = strtok(str, " ");
+	while (token_list[nof_tokens] != NULL) {
+		nof_tokens++;
+		token_list[nof_tokens] = strtok(NULL, " ");
+	}
+
+	return token_list;
+}
+
 int
-parse_flow(char *token_list[], char *response)
+parse_flow(char *str, struct json_writer *response)
 {
 	int ret = 0;
+	char **token_list;
 	struct flow_args input = { 0 };
 
-	if (token_list[1] == NULL) {
+	token_list = tokenize_flow_command(str);
+	if (token_list == NULL) {
+		make_response(response, "error",
+			"Memory allocation failure", NULL);
+		return 0;
+	}
+
+	if (token_list[0] == NULL || token_list[1] == NULL) {
 		ret = -1;
 	} else if (!strcmp(token_list[1], "validate")) {
 		input.command = VALIDATE;
-		ret = parse_flow_rule(token_list, &input);
+		ret = parse_flow_rules(token_list, &input);
 
 	} else if (!strcmp(token_list[1], "create")) {
 		input.command = CREATE;
-		ret = parse_flow_rule(token_list, &input);
+		ret = parse_flow_rules(token_list, &input);
 
 	} else if (!strcmp(token_list[1], "destroy")) {
 		ret = parse_flow_destroy(token_list, &input);
 
+	} else if (!strcmp(token_list[1], "list")) {
+		input.command = LIST;
+		ret = parse_flow_list(token_list, &input);
+
 	} else {
 		ret = -1;
 	}
@@ -729,317 +1298,32 @@ parse_flow(char *token_list[], char *response)
 		free_flow_args(&input);
 		make_response(response, "error",
 			"Flow command invalid argument", NULL);
-		return 0;
+	} else {
+		exec_flow(&input, response);
 	}
 
-	exec_flow(&input, response);
-
+	free(token_list);
 	return 0;
 }
 
-static int
-append_flow_pattern_json(const struct rte_flow_item *pattern, int buf_size,
-	char *pattern_str)
+void
+append_flow_json(struct json_writer *jw, const char *key, int port_id)
 {
-	uint32_t i, j;
-	uint32_t nof_elems = 3;
-	int ret = 0;
-	char *tmp_str;
-	const char element_str[][5] = { "spec", "last", "mask" };
-	const struct rte_flow_item *ptn = pattern;
-	struct flow_item_ops *ops;
-	const void *tmp_ptr[nof_elems];
-
-	tmp_str = malloc(buf_size);
-	if (tmp_str == NULL) {
-		RTE_LOG(ERR, SPP_FLOW,
-			"Memory allocation failure(%s:%d)\n",
-			__func__, __LINE__);
-		return -1;
-	}
-
-	while (ptn->type != RTE_FLOW_ITEM_TYPE_END) {
-		memset(tmp_str, 0, buf_size);
-
-		tmp_ptr[0] = ptn->spec;
-		tmp_ptr[1] = ptn->last;
-		tmp_ptr[2] = ptn->mask;
-
-		for (i = 0; i < RTE_DIM(flow_item_ops_list); i++) {
-			ops = &flow_item_ops_list[i];
-			if (ptn->type != ops->type)
-				continue;
-
-			snprintf(tmp_str, buf_size,
-				"{\"type\":\"%s\",",
-				ops->str_type);
-
-			for (j = 0; j < nof_elems; j++) {
-				snprintf(tmp_str + strlen(tmp_str), buf_size,
-					"\"%s\":",
-					element_str[j]);
-
-				if (tmp_ptr[j] != NULL)
-					ret = ops->status(tmp_ptr[j],
-						buf_size - (int)strlen(tmp_str),
-						tmp_str + strlen(tmp_str));
-				else
-					snprintf(tmp_str + strlen(tmp_str),
-						buf_size,
-						"null");
-
-				if (ret != 0)
-					break;
-
-				if (j < nof_elems - 1)
-					tmp_str[strlen(tmp_str)] = ',';
-			}
-
-			tmp_str[strlen(tmp_str)] = '}';
-
-			break;
-		}
-
-		if (ret != 0)
-			break;
-
-		if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
-			> buf_size - 1) {
-			ret = -1;
-			break;
-		}
-		strncat(pattern_str, tmp_str, strlen(tmp_str));
-
-		/*
-		 * If there is the following pattern, add ',' to
-		 * pattern_str
-		 */
-		ptn++;
-		if (ptn->type != RTE_FLOW_ITEM_TYPE_END) {
-			if ((int)strlen(pattern_str) + 1 > buf_size - 1) {
-				ret = -1;
-				break;
-			}
-			pattern_str[strlen(pattern_str)] = ',';
-		}
-	}
-
-	if (tmp_str != NULL)
-		free(tmp_str);
-
-	return ret;
-}
-
-static int
-append_flow_action_json(const struct rte_flow_action *actions, int buf_size,
-	char *actions_str)
-{
-	uint32_t i;
-	int ret = 0;
-	char *tmp_str;
-	const struct rte_flow_action *act = actions;
-	struct flow_action_ops *ops;
-
-	tmp_str = malloc(buf_size);
-	if (tmp_str == NULL) {
-		RTE_LOG(ERR, SPP_FLOW,
-			"Memory allocation failure(%s:%d)\n",
-			__func__, __LINE__);
-		return -1;
-	}
-
-	while (act->type != RTE_FLOW_ACTION_TYPE_END) {
-		memset(tmp_str, 0, buf_size);
-
-		for (i = 0; i < RTE_DIM(flow_action_ops_list); i++) {
-			ops = &flow_action_ops_list[i];
-			if (act->type != ops->type)
-				continue;
-
-			snprintf(tmp_str, buf_size,
-				"{\"type\":\"%s\",\"conf\":",
-				ops->str_type);
-
-			ret = ops->status(act->conf,
-				buf_size - (int)strlen(tmp_str),
-				tmp_str + strlen(tmp_str));
-			tmp_str[strlen(tmp_str)] = '}';
-			break;
-		}
-
-		if (ret != 0)
-			break;
-
-		if ((int)strlen(actions_str) + (int)strlen(tmp_str)
-			> buf_size - 1) {
-			ret = -1;
-			break;
-		}
-		strncat(actions_str, tmp_str, strlen(tmp_str));
-
-		/*
-		 * If there is the following pattern, add ',' to
-		 * actions_str
-		 */
-		act++;
-		if (act->type != RTE_FLOW_ACTION_TYPE_END) {
-			if ((int)strlen(actions_str) + 1 > buf_size - 1) {
-				ret = -1;
-				break;
-			}
-			actions_str[strlen(actions_str)] = ',';
-		}
-	}
-
-	if (tmp_str != NULL)
-		free(tmp_str);
-
-	return ret;
-}
-
-static int
-append_flow_rule_json(struct flow_rule *flow, int buf_size, char *flow_str)
-{
-	int ret = 0;
-	struct rte_flow_conv_rule rule;
-	char *tmp_str, *attr_str, *pattern_str, *actions_str;
-
-	while (1) {
-		tmp_str = malloc(buf_size);
-		attr_str = malloc(buf_size);
-		pattern_str = malloc(buf_size);
-		actions_str = malloc(buf_size);
-		if (tmp_str == NULL || attr_str == NULL
-			|| pattern_str == NULL || actions_str == NULL) {
-			RTE_LOG(ERR, SPP_FLOW,
-				"Memory allocation failure(%s:%d)\n",
-				__func__, __LINE__);
-			ret = -1;
-			break;
-		}
-		memset(tmp_str, 0, buf_size);
-		memset(attr_str, 0, buf_size);
-		memset(pattern_str, 0, buf_size);
-		memset(actions_str, 0, buf_size);
-
-		rule = flow->rule;
-
-		ret = append_flow_attr_json(rule.attr_ro, buf_size, attr_str);
-		if (ret != 0)
-			break;
-
-		ret = append_flow_pattern_json(rule.pattern_ro, buf_size,
-			pattern_str);
-		if (ret != 0)
-			break;
-
-		ret = append_flow_action_json(rule.actions_ro, buf_size,
-			actions_str);
-		if (ret != 0)
-			break;
-
-		snprintf(tmp_str, buf_size,
-			"{\"rule_id\":%d,"
-			"\"attr\":%s,"
-			"\"patterns\":[%s],"
-			"\"actions\":[%s]}",
-			flow->rule_id, attr_str, pattern_str, actions_str);
-
-		if ((int)strlen(tmp_str) > buf_size - 1) {
-			ret = -1;
-			break;
-		}
-
-		snprintf(flow_str, buf_size, "%s", tmp_str);
-		break;
+	struct flow_rule *flow;
+	int nof_flows = 0;
+
+	jw_arr_begin(jw, key);
+	for (flow = port_list[port_id].head;
+			flow != NULL && nof_flows < FLOW_STATUS_MAX_RULES;
+			flow = flow->next) {
+		append_flow_rule_json(port_id, flow, jw);
+		nof_flows++;
 	}
-
-	if (tmp_str != NULL)
-		free(tmp_str);
-	if (attr_str != NULL)
-		free(attr_str);
-	if (pattern_str != NULL)
-		free(pattern_str);
-	if (actions_str != NULL)
-		free(actions_str);
-
-	return ret;
+	jw_arr_end(jw);
 }
 
-int
-append_flow_json(int port_id, int buf_size, char *output)
+uint32_t
+get_nof_flow_rules(int port_id)
 {
-	int ret = 0;
-	int str_size = 0;
-	char *flow_str, *tmp_str;
-	struct flow_rule *flow;
-
-	flow_str = malloc(buf_size);
-	tmp_str = malloc(buf_size);
-	if (flow_str == NULL || tmp_str == NULL) {
-		RTE_LOG(ERR, SPP_FLOW,
-			"Memory allocation failure(%s:%d)\n",
-			__func__, __LINE__);
-		return -1;
-	}
-
-	flow = port_list[port_id].flow_list;
-
-	while (flow != NULL) {
-		memset(flow_str, 0, buf_size);
-
-		ret = append_flow_rule_json(flow, buf_size, flow_str);
-		if (ret != 0)
-			break;
-
-		if (str_size == 0) {
-			snprintf(output, buf_size, "%s", flow_str);
-			str_size += (int)strlen(flow_str);
-
-		} else {
-			str_size += ((int)strlen(flow_str) + 1);
-			if (str_size > buf_size - 1) {
-				ret = -1;
-				break;
-			}
-
-			/*
-			 * Since flow_list is in descending order,
-			 * concatenate the strings in front.
-			 */
-			memset(tmp_str, 0, buf_size);
-			strncpy(tmp_str, output, buf_size);
-			memset(output, 0, buf_size);
-
-			snprintf(output, buf_size, "%s,%s",
-				flow_str, tmp_str);
-		}
-
-		flow = flow->prev;
-	}
-
-	if (ret == 0) {
-		if ((int)strlen("[]") + (int)strlen(flow_str)
-			> buf_size - 1)
-			ret = -1;
-		else {
-			memset(tmp_str, 0, buf_size);
-			strncpy(tmp_str, output, buf_size);
-			memset(output, 0, buf_size);
-
-			snprintf(output, buf_size, "[%s]", tmp_str);
-		}
-	}
-
-	if (ret != 0)
-		RTE_LOG(ERR, SPP_FLOW,
-			"Cannot send all of flow stats(%s:%d)\n",
-			__func__, __LINE__);
-
-	if (flow_str != NULL)
-		free(flow_str);
-	if (tmp_str != NULL)
-		free(tmp_str);
-
-	return ret;
+	return port_list[port_id].nof_rules;
 }
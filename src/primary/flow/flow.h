@@ -6,14 +6,32 @@
 #define _PRIMARY_FLOW_H_
 
 #include <rte_log.h>
+#include "shared/json_writer.h"
 
 #define RTE_LOGTYPE_SPP_FLOW RTE_LOGTYPE_USER1
 
+/* Initial num of buckets of rule table of each port, must be power of 2. */
+#define FLOW_TABLE_INIT_SIZE 256
+
+/* Max num of rules in status of primary, get the rest with `flow list`. */
+#define FLOW_STATUS_MAX_RULES 64
+
+/* Max num of rules returned by `flow list` at once. */
+#define FLOW_LIST_MAX_RULES 256
+
 enum flow_command {
 	VALIDATE = 0,
 	CREATE,
 	DESTROY,
-	FLUSH
+	FLUSH,
+	LIST
+};
+
+/* A rule of validate or create arguments. */
+struct flow_rule_args {
+	struct rte_flow_attr attr;
+	struct rte_flow_item *pattern;
+	struct rte_flow_action *actions;
 };
 
 /* Parser result of flow command arguments */
@@ -22,13 +40,17 @@ struct flow_args {
 	int port_id;
 	union {
 		struct {
-			struct rte_flow_attr attr;
-			struct rte_flow_item *pattern;
-			struct rte_flow_action *actions;
+			int nof_rules;
+			struct flow_rule_args *rules;
 		} rule; /* validate or create arguments. */
 		struct {
-			uint32_t rule_id;
+			int nof_rule_ids;
+			uint32_t *rule_ids;
 		} destroy; /* destroy arguments. */
+		struct {
+			uint32_t start_id;
+			uint32_t max_rules;
+		} list; /* list arguments. */
 	} args;
 };
 
@@ -37,8 +59,12 @@ struct flow_rule {
 	/* Flow rule ID */
 	uint32_t rule_id;
 
-	/* Previous flow in list. */
+	/* Previous and next flows in order of creation. */
 	struct flow_rule *prev;
+	struct flow_rule *next;
+
+	/* Next flow in the same bucket of rule table. */
+	struct flow_rule *hash_next;
 
 	/* Opaque flow object returned by PMD. */
 	struct rte_flow *flow_handle;
@@ -47,10 +73,23 @@ struct flow_rule {
 	struct rte_flow_conv_rule rule;
 };
 
-/* Flow rule list of the port */
+/*
+ * Flow rules of the port. Rules are listed in order of creation, which is
+ * also ascending order of rule IDs, and indexed by IDs in the rule table.
+ */
 struct port_flow {
-	/* Associated flows */
-	struct flow_rule *flow_list;
+	/* The oldest and the newest flows */
+	struct flow_rule *head;
+	struct flow_rule *tail;
+
+	/* Rule table of chained buckets, allocated at first creation. */
+	struct flow_rule **buckets;
+	uint32_t nof_buckets;
+
+	uint32_t nof_rules;
+
+	/* Rule ID assigned to the next created flow. */
+	uint32_t next_rule_id;
 };
 
 /* Detail parse operation for a specific item or action */
@@ -71,8 +110,8 @@ struct flow_item_ops {
 		struct rte_flow_item *pattern,
 		struct flow_item_ops *ops);
 	struct flow_detail_ops *detail_list;
-	int (*status)(const void *element,
-		int buf_size, char *pattern_str);
+	void (*status)(const void *element, const char *key,
+		struct json_writer *jw);
 };
 
 /* Operation for each action type */
@@ -84,11 +123,23 @@ struct flow_action_ops {
 		struct rte_flow_action *action,
 		struct flow_action_ops *ops);
 	struct flow_detail_ops *detail_list;
-	int (*status)(const void *conf,
-		int buf_size, char *action_str);
+	void (*status)(const void *conf, const char *key,
+		struct json_writer *jw);
+	/* Append result of rte_flow_query(), or NULL if not queryable. */
+	void (*query)(int port_id, struct rte_flow *flow,
+		const struct rte_flow_action *action, const char *key,
+		struct json_writer *jw);
 };
 
-int parse_flow(char *token_list[], char *response);
-int append_flow_json(int port_id, int buf_size, char *output);
+/*
+ * Parse and execute flow command. Several rules can be given to validate
+ * and create, and several rule IDs to destroy, at once.
+ */
+int parse_flow(char *str, struct json_writer *response);
+
+/* Append rules of the port up to FLOW_STATUS_MAX_RULES as JSON array. */
+void append_flow_json(struct json_writer *jw, const char *key, int port_id);
+
+uint32_t get_nof_flow_rules(int port_id);
 
 #endif
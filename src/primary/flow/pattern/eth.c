@@ -36,28 +36,20 @@ struct flow_detail_ops eth_ops_list[] = {
 	},
 };
 
-int
-append_item_eth_json(const void *element, int buf_size, char *pattern_str)
+void
+append_item_eth_json(const void *element, const char *key,
+	struct json_writer *jw)
 {
 	const struct rte_flow_item_eth *eth = element;
 	char dst_mac[RTE_ETHER_ADDR_FMT_SIZE] = { 0 };
 	char src_mac[RTE_ETHER_ADDR_FMT_SIZE] = { 0 };
-	char tmp_str[128] = { 0 };
 
 	rte_ether_format_addr(dst_mac, RTE_ETHER_ADDR_FMT_SIZE, &eth->dst);
 	rte_ether_format_addr(src_mac, RTE_ETHER_ADDR_FMT_SIZE, &eth->src);
 
-	snprintf(tmp_str, 128,
-		"{\"dst\":\"%s\","
-		"\"src\":\"%s\","
-		"\"type\":\"0x%04x\"}",
-		dst_mac, src_mac, eth->type);
-
-	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(pattern_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_str(jw, "dst", dst_mac);
+	jw_str(jw, "src", src_mac);
+	jw_strf(jw, "type", "0x%04x", eth->type);
+	jw_obj_end(jw);
 }
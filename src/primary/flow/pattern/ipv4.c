@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <arpa/inet.h>
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "ipv4.h"
+
+/* Define item "ipv4" operations */
+struct flow_detail_ops ipv4_ops_list[] = {
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_ipv4, hdr.src_addr),
+		.size = sizeof(rte_be32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv4_addr,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_ipv4, hdr.dst_addr),
+		.size = sizeof(rte_be32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv4_addr,
+	},
+	{
+		.token = "tos",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.type_of_service),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "ttl",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.time_to_live),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "proto",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.next_proto_id),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_item_ipv4_json(const void *element, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_item_ipv4 *ipv4 = element;
+	char src_addr[INET_ADDRSTRLEN] = { 0 };
+	char dst_addr[INET_ADDRSTRLEN] = { 0 };
+
+	inet_ntop(AF_INET, &ipv4->hdr.src_addr, src_addr, sizeof(src_addr));
+	inet_ntop(AF_INET, &ipv4->hdr.dst_addr, dst_addr, sizeof(dst_addr));
+
+	jw_obj_begin(jw, key);
+	jw_str(jw, "src", src_addr);
+	jw_str(jw, "dst", dst_addr);
+	jw_uint(jw, "tos", ipv4->hdr.type_of_service);
+	jw_uint(jw, "ttl", ipv4->hdr.time_to_live);
+	jw_uint(jw, "proto", ipv4->hdr.next_proto_id);
+	jw_obj_end(jw);
+}
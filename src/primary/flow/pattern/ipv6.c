@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <arpa/inet.h>
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "ipv6.h"
+
+/* Define item "ipv6" operations */
+struct flow_detail_ops ipv6_ops_list[] = {
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.src_addr),
+		.size = sizeof(((struct rte_ipv6_hdr *)0)->src_addr),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv6_addr,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.dst_addr),
+		.size = sizeof(((struct rte_ipv6_hdr *)0)->dst_addr),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv6_addr,
+	},
+	{
+		.token = "proto",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.proto),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "hop",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.hop_limits),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_item_ipv6_json(const void *element, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_item_ipv6 *ipv6 = element;
+	char src_addr[INET6_ADDRSTRLEN] = { 0 };
+	char dst_addr[INET6_ADDRSTRLEN] = { 0 };
+
+	inet_ntop(AF_INET6, ipv6->hdr.src_addr, src_addr, sizeof(src_addr));
+	inet_ntop(AF_INET6, ipv6->hdr.dst_addr, dst_addr, sizeof(dst_addr));
+
+	jw_obj_begin(jw, key);
+	jw_str(jw, "src", src_addr);
+	jw_str(jw, "dst", dst_addr);
+	jw_uint(jw, "proto", ipv6->hdr.proto);
+	jw_uint(jw, "hop", ipv6->hdr.hop_limits);
+	jw_obj_end(jw);
+}
@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+#include <rte_byteorder.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "udp.h"
+
+/* Define item "udp" operations */
+struct flow_detail_ops udp_ops_list[] = {
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_udp, hdr.src_port),
+		.size = sizeof(rte_be16_t),
+		.flg_value = 1,
+		.parse_detail = str_to_rte_be16_t,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_udp, hdr.dst_port),
+		.size = sizeof(rte_be16_t),
+		.flg_value = 1,
+		.parse_detail = str_to_rte_be16_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_item_udp_json(const void *element, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_item_udp *udp = element;
+
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "src", rte_be_to_cpu_16(udp->hdr.src_port));
+	jw_uint(jw, "dst", rte_be_to_cpu_16(udp->hdr.dst_port));
+	jw_obj_end(jw);
+}
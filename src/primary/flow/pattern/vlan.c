@@ -50,22 +50,14 @@ struct flow_detail_ops vlan_ops_list[] = {
 	},
 };
 
-int
-append_item_vlan_json(const void *element, int buf_size, char *pattern_str)
+void
+append_item_vlan_json(const void *element, const char *key,
+	struct json_writer *jw)
 {
 	const struct rte_flow_item_vlan *vlan = element;
-	char tmp_str[128] = { 0 };
 
-	snprintf(tmp_str, 128,
-		"{\"tci\":\"0x%04x\","
-		"\"inner_type\":\"0x%04x\"}",
-		vlan->tci, vlan->inner_type);
-
-	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
-		> buf_size)
-		return -1;
-
-	strncat(pattern_str, tmp_str, strlen(tmp_str));
-
-	return 0;
+	jw_obj_begin(jw, key);
+	jw_strf(jw, "tci", "0x%04x", vlan->tci);
+	jw_strf(jw, "inner_type", "0x%04x", vlan->inner_type);
+	jw_obj_end(jw);
 }
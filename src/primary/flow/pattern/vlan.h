@@ -7,7 +7,7 @@
 
 extern struct flow_detail_ops vlan_ops_list[];
 
-int append_item_vlan_json(const void *element, int buf_size,
-	char *pattern_str);
+void append_item_vlan_json(const void *element, const char *key,
+	struct json_writer *jw);
 
 #endif
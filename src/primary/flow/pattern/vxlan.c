@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "vxlan.h"
+
+/* Define item "vxlan" operations */
+struct flow_detail_ops vxlan_ops_list[] = {
+	{
+		.token = "vni",
+		.offset = offsetof(struct rte_flow_item_vxlan, vni),
+		.size = sizeof(((struct rte_flow_item_vxlan *)0)->vni),
+		.flg_value = 1,
+		.parse_detail = str_to_vni,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+void
+append_item_vxlan_json(const void *element, const char *key,
+	struct json_writer *jw)
+{
+	const struct rte_flow_item_vxlan *vxlan = element;
+
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "vni", (vxlan->vni[0] << 16) | (vxlan->vni[1] << 8) |
+		vxlan->vni[2]);
+	jw_obj_end(jw);
+}
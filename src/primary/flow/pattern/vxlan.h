@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_PATTERN_VXLAN_H_
+#define _PRIMARY_FLOW_PATTERN_VXLAN_H_
+
+extern struct flow_detail_ops vxlan_ops_list[];
+
+void append_item_vxlan_json(const void *element, const char *key,
+	struct json_writer *jw);
+
+#endif
@@ -3,7 +3,9 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
 
 #include <rte_cycles.h>
 #include <rte_malloc.h>
@@ -17,8 +19,8 @@
 /* array of info/queues for ring_ports */
 struct ring_port *ring_ports;
 
-/* The mbuf pool for packet rx */
-static struct rte_mempool *pktmbuf_pool;
+/* The mbuf pools for packet rx, one for each of sockets in use */
+static struct rte_mempool *pktmbuf_pools[RTE_MAX_NUMA_NODES];
 
 /* the port details */
 struct port_info *ports;
@@ -26,37 +28,97 @@ struct port_info *ports;
 /* global var - extern in header */
 uint8_t lcore_id_used[RTE_MAX_LCORE] = {};
 
+/*
+ * Get socket of the port. Virtual devices are not bound to any socket and
+ * placed on the socket of master lcore.
+ */
+static unsigned int
+get_port_socket_id(uint16_t port_id)
+{
+	int socket_id = rte_eth_dev_socket_id(port_id);
+
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES)
+		return rte_socket_id();
+	return (unsigned int)socket_id;
+}
+
 /**
- * Initialise the mbuf pool for packet reception for the NIC, and any other
+ * Initialise the mbuf pools for packet reception for the NIC, and any other
  * buffer pools needed by the app - currently none.
+ * A pool is created on each of sockets which has lcores or ports in use so
+ * that ports receive packets into local memory.
  */
 static int
 init_mbuf_pools(void)
 {
-	const unsigned int num_mbufs = (num_rings * MBUFS_PER_CLIENT)
-		+ (ports->num_ports * MBUFS_PER_PORT);
+	uint64_t port_mbufs[RTE_MAX_NUMA_NODES] = {};
+	uint8_t socket_used[RTE_MAX_NUMA_NODES] = {};
+	uint64_t ring_mbufs = 0;
+	uint64_t num_mbufs;
+	unsigned int socket_id;
+	unsigned int lcore_id;
+	const char *name;
+	uint16_t count;
+	unsigned int i;
 
-	/*
-	 * don't pass single-producer/single-consumer flags to mbuf create as
-	 * it seems faster to use a cache instead
-	 */
-	RTE_LOG(DEBUG, PRIMARY, "Creating mbuf pool '%s' [%u mbufs] ...\n",
-		PKTMBUF_POOL_NAME, num_mbufs);
+	RTE_LCORE_FOREACH(lcore_id) {
+		socket_used[rte_lcore_to_socket_id(lcore_id)] = 1;
+	}
+	socket_used[rte_socket_id()] = 1;
 
-	if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
-		pktmbuf_pool = rte_mempool_lookup(PKTMBUF_POOL_NAME);
-		if (pktmbuf_pool == NULL)
-			rte_exit(EXIT_FAILURE,
-				"Cannot get mempool for mbufs\n");
-	} else {
-		pktmbuf_pool = rte_mempool_create(PKTMBUF_POOL_NAME, num_mbufs,
-			MBUF_SIZE, MBUF_CACHE_SIZE,
-			sizeof(struct rte_pktmbuf_pool_private),
-			rte_pktmbuf_pool_init, NULL, rte_pktmbuf_init, NULL,
-			rte_socket_id(), NO_FLAGS);
+	for (count = 0; count < ports->num_ports; count++) {
+		socket_id = get_port_socket_id(ports->id[count]);
+		socket_used[socket_id] = 1;
+		port_mbufs[socket_id] += get_size_opt(&port_mbufs_opt,
+				ports->id[count]);
+	}
+
+	for (i = 0; i < num_rings; i++)
+		ring_mbufs += get_size_opt(&ring_mbufs_opt, i);
+
+	for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES; socket_id++) {
+		if (socket_used[socket_id] == 0)
+			continue;
+
+		/*
+		 * Ring ports can be used from secondaries on any socket, so
+		 * each pool has mbufs for all of rings.
+		 */
+		num_mbufs = ring_mbufs + port_mbufs[socket_id];
+		if (num_mbufs > UINT32_MAX) {
+			RTE_LOG(ERR, PRIMARY,
+				"Too many mbufs %"PRIu64" on socket %u\n",
+				num_mbufs, socket_id);
+			return -1;
+		}
+		name = get_pktmbuf_pool_name(socket_id);
+
+		/*
+		 * don't pass single-producer/single-consumer flags to mbuf
+		 * create as it seems faster to use a cache instead
+		 */
+		RTE_LOG(DEBUG, PRIMARY, "Creating mbuf pool '%s' "
+			"[%"PRIu64" mbufs] on socket %u ...\n",
+			name, num_mbufs, socket_id);
+
+		if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
+			pktmbuf_pools[socket_id] = rte_mempool_lookup(name);
+			if (pktmbuf_pools[socket_id] == NULL)
+				rte_exit(EXIT_FAILURE,
+					"Cannot get mempool for mbufs\n");
+		} else {
+			pktmbuf_pools[socket_id] = rte_mempool_create(name,
+				num_mbufs, MBUF_SIZE, mbuf_cache_size,
+				sizeof(struct rte_pktmbuf_pool_private),
+				rte_pktmbuf_pool_init, NULL,
+				rte_pktmbuf_init, NULL, socket_id, NO_FLAGS);
+		}
+
+		if (pktmbuf_pools[socket_id] == NULL)
+			return -1;
 	}
 
-	return (pktmbuf_pool == NULL); /* 0  on success */
+	return 0;
 }
 
 /**
@@ -67,7 +129,7 @@ init_mbuf_pools(void)
 static int
 init_shm_rings(void)
 {
-	const unsigned int ringsize = CLIENT_QUEUE_RINGSIZE;
+	unsigned int ringsize;
 	unsigned int socket_id;
 	const char *q_name;
 	unsigned int i;
@@ -81,6 +143,7 @@ init_shm_rings(void)
 	for (i = 0; i < num_rings; i++) {
 		/* Create an RX queue for each ring_ports */
 		socket_id = rte_socket_id();
+		ringsize = get_size_opt(&ring_size_opt, i);
 		q_name = get_rx_queue_name(i);
 		if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
 			ring_ports[i].rx_q = rte_ring_lookup(q_name);
@@ -99,6 +162,133 @@ init_shm_rings(void)
 	return 0;
 }
 
+/* Print link status of the port. */
+static void
+print_link_status(uint16_t port_id)
+{
+	struct rte_eth_link link;
+
+	memset(&link, 0, sizeof(link));
+	rte_eth_link_get_nowait(port_id, &link);
+
+	if (link.link_status)
+		RTE_LOG(INFO, PRIMARY,
+			"Port %d Link Up - speed %u Mbps - %s\n",
+			port_id, link.link_speed,
+			(link.link_duplex == ETH_LINK_FULL_DUPLEX) ?
+				"full-duplex" : "half-duplex");
+	else
+		RTE_LOG(INFO, PRIMARY, "Port %d Link Down\n", port_id);
+}
+
+/* Callback of LSC interrupt, called from interrupt thread of EAL. */
+static int
+lsc_event_callback(uint16_t port_id, enum rte_eth_event_type type,
+		void *param __rte_unused, void *ret_param __rte_unused)
+{
+	if (type == RTE_ETH_EVENT_INTR_LSC)
+		print_link_status(port_id);
+	return 0;
+}
+
+/* Return 1 if link status of the port is notified with LSC interrupt. */
+static int
+has_lsc_intr(uint16_t port_id)
+{
+	return (rte_eth_devices[port_id].data->dev_flags &
+			RTE_ETH_DEV_INTR_LSC) &&
+		rte_eth_devices[port_id].data->dev_conf.intr_conf.lsc;
+}
+
+/*
+ * Check the link status of ports without LSC interrupt in up to 9s, and
+ * print them if changed. It runs in a control thread not to block
+ * accepting commands while links are coming up.
+ */
+static void *
+link_monitor(void *arg __rte_unused)
+{
+#define CHECK_INTERVAL 100 /* 100ms */
+#define MAX_CHECK_TIME 90 /* 9s (90 * 100ms) in total */
+	uint8_t link_up[RTE_MAX_ETHPORTS] = {};
+	unsigned int count;
+	int all_ports_up;
+	uint16_t i, port_id;
+	struct rte_eth_link link;
+
+	for (count = 0; count <= MAX_CHECK_TIME; count++) {
+		all_ports_up = 1;
+		for (i = 0; i < ports->num_ports; i++) {
+			port_id = ports->id[i];
+			if (link_up[port_id] || has_lsc_intr(port_id))
+				continue;
+
+			memset(&link, 0, sizeof(link));
+			rte_eth_link_get_nowait(port_id, &link);
+			if (link.link_status == 0) {
+				all_ports_up = 0;
+				continue;
+			}
+
+			link_up[port_id] = 1;
+			print_link_status(port_id);
+		}
+
+		if (all_ports_up)
+			return NULL;
+		rte_delay_ms(CHECK_INTERVAL);
+	}
+
+	/* timed out */
+	for (i = 0; i < ports->num_ports; i++) {
+		port_id = ports->id[i];
+		if (!link_up[port_id] && !has_lsc_intr(port_id))
+			print_link_status(port_id);
+	}
+
+	return NULL;
+}
+
+/* Launch link_monitor() for ports which do not notify link status. */
+static void
+start_link_monitor(void)
+{
+	pthread_t tid;
+	int ret;
+
+	ret = rte_ctrl_thread_create(&tid, "spp-link-mon", NULL,
+			link_monitor, NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, PRIMARY, "Cannot create link monitor thread\n");
+		return;
+	}
+	pthread_detach(tid);
+}
+
+/*
+ * Initialise all of ports one by one. Configuring and starting ethdevs is
+ * not thread-safe, so it is done in this thread and only waiting for links
+ * to be up is left to link_monitor() running in background.
+ */
+static void
+init_all_ports(void)
+{
+	uint16_t port_id;
+	uint16_t count;
+	int ret;
+
+	for (count = 0; count < ports->num_ports; count++) {
+		port_id = ports->id[count];
+		ret = init_port(port_id,
+				pktmbuf_pools[get_port_socket_id(port_id)],
+				ports->queue_info[count].rxq,
+				ports->queue_info[count].txq);
+		if (ret != 0)
+			rte_exit(EXIT_FAILURE, "Cannot initialise port %d\n",
+					port_id);
+	}
+}
+
 /**
  * Main init function for the multi-process server app,
  * calls subfunctions to do each stage of the initialisation.
@@ -109,7 +299,7 @@ init(int argc, char *argv[])
 	int retval;
 	int lcore_id;
 	const struct rte_memzone *mz;
-	uint16_t count, total_ports;
+	uint16_t total_ports;
 	char log_msg[1024] = { '\0' };  /* temporary log message */
 	int i;
 
@@ -158,17 +348,11 @@ init(int argc, char *argv[])
 		rte_exit(EXIT_FAILURE, "Cannot create needed mbuf pools\n");
 
 	/* now initialise the ports we will use */
-	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
-		for (count = 0; count < ports->num_ports; count++) {
-			retval = init_port(ports->id[count], pktmbuf_pool,
-				ports->queue_info[count].rxq,
-				ports->queue_info[count].txq);
-			if (retval != 0)
-				rte_exit(EXIT_FAILURE,
-					"Cannot initialise port %d\n", count);
-		}
-	}
-	check_all_ports_link_status(ports, ports->num_ports, (~0x0));
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY)
+		init_all_ports();
+
+	/* Links are still coming up while accepting commands. */
+	start_link_monitor();
 
 	/* Initialise the ring_port. */
 	init_shm_rings();
@@ -187,71 +371,82 @@ init(int argc, char *argv[])
 	return 0;
 }
 
-/* Check the link status of all ports in up to 9s, and print them finally */
-void
-check_all_ports_link_status(struct port_info *ports, uint16_t port_num,
-		uint32_t port_mask)
-{
-#define CHECK_INTERVAL 100 /* 100ms */
-#define MAX_CHECK_TIME 90 /* 9s (90 * 100ms) in total */
-	uint8_t count, all_ports_up;
-	uint16_t portid;
-	struct rte_eth_link link;
-
-	RTE_LOG(INFO, PRIMARY, "Checking link status ");
-	fflush(stdout);
-	for (count = 0; count <= MAX_CHECK_TIME; count++) {
-		all_ports_up = 1;
-		for (portid = 0; portid < port_num; portid++) {
-			if ((port_mask & (1 << ports->id[portid])) == 0)
-				continue;
-
-			memset(&link, 0, sizeof(link));
-			rte_eth_link_get_nowait(ports->id[portid], &link);
+/*
+ * Offloads enabled for each of phy ports after checking capabilities,
+ * referred from `status` command.
+ */
+static struct offload_conf port_offloads[RTE_MAX_ETHPORTS];
 
-			/* clear all_ports_up flag if any link down */
-			if (link.link_status == 0) {
-				all_ports_up = 0;
-				break;
-			}
-		}
+const struct offload_conf *
+get_port_offload(uint16_t port_id)
+{
+	return &port_offloads[port_id];
+}
 
-		if (all_ports_up == 0) {
-			printf(".");
-			fflush(stdout);
-			rte_delay_ms(CHECK_INTERVAL);
+/*
+ * Check offloads requested with `--offload` option with capabilities of
+ * the device, and set supported ones to `conf`. Unsupported ones are
+ * just ignored with a warning, not to fail to launch.
+ */
+static void
+negotiate_offloads(uint16_t port_id, const struct rte_eth_dev_info *dev_info,
+		struct offload_conf *conf)
+{
+	const struct offload_conf *req = get_offload_opt(port_id);
+	uint32_t frame_len;
+
+	*conf = *req;
+
+	/* Frames longer than data room of mbuf are received as segments. */
+	if (conf->mtu > RTE_ETHER_MTU) {
+		frame_len = conf->mtu + RTE_ETHER_HDR_LEN + RTE_ETHER_CRC_LEN;
+		if (frame_len > dev_info->max_rx_pktlen) {
+			RTE_LOG(WARNING, PRIMARY,
+				"Port %u does not support MTU %u\n",
+				port_id, conf->mtu);
+			conf->mtu = 0;
 		} else {
-			printf("done\n");
-			break;
+			conf->rx_offloads |= DEV_RX_OFFLOAD_JUMBO_FRAME;
+			if (frame_len > RX_MBUF_DATA_SIZE)
+				conf->rx_offloads |= DEV_RX_OFFLOAD_SCATTER;
 		}
 	}
-	printf("\n");
 
-	/* all ports up or timed out */
-	for (portid = 0; portid < port_num; portid++) {
-		if ((port_mask & (1 << ports->id[portid])) == 0)
-			continue;
+	if (conf->rx_offloads & ~dev_info->rx_offload_capa) {
+		RTE_LOG(WARNING, PRIMARY,
+			"Port %u does not support RX offloads 0x%"PRIx64"\n",
+			port_id, conf->rx_offloads & ~dev_info->rx_offload_capa);
+		conf->rx_offloads &= dev_info->rx_offload_capa;
+	}
 
-		memset(&link, 0, sizeof(link));
-		rte_eth_link_get_nowait(ports->id[portid], &link);
-
-		/* print link status */
-		if (link.link_status)
-			RTE_LOG(INFO, PRIMARY,
-				"Port %d Link Up - speed %u Mbps - %s\n",
-				ports->id[portid], link.link_speed,
-				(link.link_duplex == ETH_LINK_FULL_DUPLEX) ?
-					"full-duplex\n" : "half-duplex\n");
-		else
-			RTE_LOG(INFO, PRIMARY,
-				"Port %d Link Down\n", ports->id[portid]);
+	if (conf->tx_offloads & ~dev_info->tx_offload_capa) {
+		RTE_LOG(WARNING, PRIMARY,
+			"Port %u does not support TX offloads 0x%"PRIx64"\n",
+			port_id, conf->tx_offloads & ~dev_info->tx_offload_capa);
+		conf->tx_offloads &= dev_info->tx_offload_capa;
+	}
+
+	if (conf->rss_hf & ~dev_info->flow_type_rss_offloads) {
+		RTE_LOG(WARNING, PRIMARY,
+			"Port %u does not support RSS types 0x%"PRIx64"\n",
+			port_id,
+			conf->rss_hf & ~dev_info->flow_type_rss_offloads);
+		conf->rss_hf &= dev_info->flow_type_rss_offloads;
+	}
+
+	if (conf->rss_key_len != 0 &&
+			conf->rss_key_len != dev_info->hash_key_size) {
+		RTE_LOG(WARNING, PRIMARY,
+			"Port %u requires RSS key of %u bytes, not %u\n",
+			port_id, dev_info->hash_key_size, conf->rss_key_len);
+		conf->rss_key_len = 0;
 	}
 }
 
 /**
  * Initialise an individual port:
- * - configure number of rx and tx rings
- * - set up each rx ring, to pull from the main mbuf pool
+ * - configure number of rx and tx rings, and offloads
+ * - set up each rx ring, to pull from the mbuf pool on the port's socket
  * - set up each tx ring
  * - start the port and report its status to stdout
  */
@@ -265,21 +460,46 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool,
 			.mq_mode = ETH_MQ_RX_RSS,
 		},
 	};
-	const uint16_t rx_ring_size = RTE_MP_RX_DESC_DEFAULT;
-	const uint16_t tx_ring_size = RTE_MP_TX_DESC_DEFAULT;
+	uint16_t rx_ring_size = get_size_opt(&rxd_opt, port_num);
+	uint16_t tx_ring_size = get_size_opt(&txd_opt, port_num);
 	uint16_t q;
 	int retval;
 	struct rte_eth_dev_info dev_info;
 	struct rte_eth_conf local_port_conf = port_conf;
+	struct offload_conf *offload = &port_offloads[port_num];
+	struct rte_eth_rxconf rxq_conf;
 	struct rte_eth_txconf txq_conf;
 
 	RTE_LOG(INFO, PRIMARY, "Port %u init ...\n", port_num);
 	fflush(stdout);
 
 	rte_eth_dev_info_get(port_num, &dev_info);
-	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
-		local_port_conf.txmode.offloads |=
-			DEV_TX_OFFLOAD_MBUF_FAST_FREE;
+	negotiate_offloads(port_num, &dev_info, offload);
+
+	local_port_conf.rxmode.offloads = offload->rx_offloads;
+	local_port_conf.txmode.offloads = offload->tx_offloads;
+	local_port_conf.rx_adv_conf.rss_conf.rss_hf = offload->rss_hf;
+	if (offload->rss_key_len != 0) {
+		local_port_conf.rx_adv_conf.rss_conf.rss_key =
+			offload->rss_key;
+		local_port_conf.rx_adv_conf.rss_conf.rss_key_len =
+			offload->rss_key_len;
+	}
+	if (offload->rx_offloads & DEV_RX_OFFLOAD_JUMBO_FRAME)
+		local_port_conf.rxmode.max_rx_pkt_len = offload->mtu +
+			RTE_ETHER_HDR_LEN + RTE_ETHER_CRC_LEN;
+
+	/* Link status is notified with LSC interrupt if supported. */
+	if (rte_eth_devices[port_num].data->dev_flags & RTE_ETH_DEV_INTR_LSC) {
+		local_port_conf.intr_conf.lsc = 1;
+		retval = rte_eth_dev_callback_register(port_num,
+				RTE_ETH_EVENT_INTR_LSC, lsc_event_callback, NULL);
+		if (retval != 0)
+			local_port_conf.intr_conf.lsc = 0;
+	}
+
+	rxq_conf = dev_info.default_rxconf;
+	rxq_conf.offloads = local_port_conf.rxmode.offloads;
 	txq_conf = dev_info.default_txconf;
 	txq_conf.offloads = local_port_conf.txmode.offloads;
 
@@ -288,13 +508,31 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool,
 	 * rx and tx rings
 	 */
 	retval = rte_eth_dev_configure(port_num, rx_rings, tx_rings,
-		&port_conf);
+		&local_port_conf);
+	if (retval != 0)
+		return retval;
+
+	if (offload->mtu != 0) {
+		retval = rte_eth_dev_set_mtu(port_num, offload->mtu);
+		if (retval != 0) {
+			RTE_LOG(ERR, PRIMARY, "Cannot set MTU %u of port %u\n",
+				offload->mtu, port_num);
+			return retval;
+		}
+	}
+
+	/* Fit num of descriptors to the limits of the device. */
+	retval = rte_eth_dev_adjust_nb_rx_tx_desc(port_num, &rx_ring_size,
+		&tx_ring_size);
 	if (retval != 0)
 		return retval;
+	RTE_LOG(DEBUG, PRIMARY, "Port %u has %u RX and %u TX descriptors\n",
+		port_num, rx_ring_size, tx_ring_size);
 
 	for (q = 0; q < rx_rings; q++) {
 		retval = rte_eth_rx_queue_setup(port_num, q, rx_ring_size,
-			rte_eth_dev_socket_id(port_num), NULL, pktmbuf_pool);
+			rte_eth_dev_socket_id(port_num), &rxq_conf,
+			pktmbuf_pool);
 		if (retval < 0)
 			return retval;
 	}
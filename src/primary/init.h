@@ -47,10 +47,10 @@ extern struct port_info *ports;
 
 int init(int argc, char *argv[]);
 
-void check_all_ports_link_status(struct port_info *ports, uint16_t port_num,
-		uint32_t port_mask);
-
 int init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool,
 		uint16_t rx_rings, uint16_t tx_rings);
 
+/* Get offloads enabled for phy port of `port_id` in init_port(). */
+const struct offload_conf *get_port_offload(uint16_t port_id);
+
 #endif /* ifndef _PRIMARY_INIT_H_ */
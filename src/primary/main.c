@@ -3,6 +3,7 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <errno.h>
 #include <signal.h>
 #include <arpa/inet.h>
 #include <inttypes.h>
@@ -15,21 +16,15 @@
 #include "shared/common.h"
 #include "args.h"
 #include "init.h"
+#include "metrics.h"
 #include "primary.h"
 #include "primary/flow/flow.h"
 
+#include "shared/json_writer.h"
 #include "shared/port_manager.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
 
-/*
- * Buffer sizes of status message of primary. Total number of size
- * must be equal to MSG_SIZE 32768 defined in `shared/common.h`.
- */
-#define PRI_BUF_SIZE_LCORE 128
-#define PRI_BUF_SIZE_PHY 30720
-#define PRI_BUF_SIZE_RING (MSG_SIZE - PRI_BUF_SIZE_LCORE - PRI_BUF_SIZE_PHY)
-
 #define SPP_PATH_LEN 1024  /* seems enough for path of spp procs */
 #define NOF_TOKENS 48  /* seems enough to contain tokens */
 /* should be contain extra two tokens for `python` and path of launcher */
@@ -43,19 +38,8 @@
 
 #define POLL_TIMEOUT_MS 100
 
-/**
- * Set of port id and type of resource UID, such as `vhost:1`. It is intended
- * to be used for mapping to ethdev ID. as port_id_list.
- */
-struct port_id_map {
-	int port_id;
-	enum port_type type;
-};
-
-struct port_id_map port_id_list[RTE_MAX_ETHPORTS];
-
 static sig_atomic_t on = 1;
-static enum cmd_type cmd = STOP;
+static volatile enum cmd_type cmd = STOP;
 static struct pollfd pfd;
 
 /* global var - extern in header */
@@ -104,6 +88,7 @@ do_stats_display(void)
 	const char topLeft[] = { 27, '[', '1', ';', '1', 'H', '\0' };
 	const char clr[] = { 27, '[', '2', 'J', '\0' };
 	unsigned int i;
+	struct stats st;
 
 	/* Clear screen and move to top left */
 	printf("%s%s", clr, topLeft);
@@ -115,22 +100,19 @@ do_stats_display(void)
 			get_printable_mac_addr(ports->id[i]));
 	printf("\n\n");
 	for (i = 0; i < ports->num_ports; i++) {
+		sum_port_stats(ports, i, &st);
 		printf("Port %u - rx: %9"PRIu64"\t tx: %9"PRIu64"\t"
 			" tx_drop: %9"PRIu64"\n",
-			ports->id[i], ports->port_stats[i].rx,
-			ports->port_stats[i].tx,
-			ports->port_stats[i].tx_drop);
+			ports->id[i], st.rx, st.tx, st.tx_drop);
 	}
 
 	printf("\nCLIENTS\n");
 	printf("-------\n");
 	for (i = 0; i < num_rings; i++) {
+		sum_client_stats(ports, i, &st);
 		printf("Client %2u - rx: %9"PRIu64", rx_drop: %9"PRIu64"\n"
 			"            tx: %9"PRIu64", tx_drop: %9"PRIu64"\n",
-			i, ports->client_stats[i].rx,
-			ports->client_stats[i].rx_drop,
-			ports->client_stats[i].tx,
-			ports->client_stats[i].tx_drop);
+			i, st.rx, st.rx_drop, st.tx, st.tx_drop);
 	}
 
 	printf("\n");
@@ -174,14 +156,7 @@ forward_loop(void)
 
 	RTE_LOG(INFO, PRIMARY, "entering main loop on lcore %u\n", lcore_id);
 
-	while (1) {
-		if (unlikely(cmd == STOP)) {
-			sleep(1);
-			continue;
-		} else if (cmd == FORWARD) {
-			forward();
-		}
-	}
+	fwd_lcore_loop(&cmd);
 }
 
 /* leading to forward loop. */
@@ -199,23 +174,37 @@ main_loop(void *dummy __rte_unused)
 static void
 clear_stats(void)
 {
-	memset(ports->port_stats, 0, sizeof(struct stats) * RTE_MAX_ETHPORTS);
-	memset(ports->client_stats, 0, sizeof(struct stats) * MAX_CLIENT);
+	clear_lcore_stats(ports);
 }
 
 static int
-do_send(int *connected, int *sock, char *str)
+do_send(int *connected, int *sock, const struct json_writer *res)
 {
-	int ret;
-
-	ret = send(*sock, str, MSG_SIZE, 0);
-	if (ret == -1) {
-		RTE_LOG(ERR, PRIMARY, "Failed to send\n");
-		*connected = 0;
-		return -1;
+	/* Reply even if no message is made not to block spp-ctl. */
+	static const char err_msg[] = "{\"result\":\"failed\"}";
+	const char *msg = err_msg;
+	size_t len = sizeof(err_msg) - 1;
+	ssize_t ret;
+
+	if (jw_error(res) == 0 && res->len > 0) {
+		msg = res->str;
+		len = res->len;
 	}
 
-	RTE_LOG(INFO, PRIMARY, "To Server: %s\n", str);
+	RTE_LOG(INFO, PRIMARY, "To Server: %s\n", msg);
+
+	while (len > 0) {
+		ret = send(*sock, msg, len, 0);
+		if (ret == -1) {
+			if (errno == EINTR)
+				continue;
+			RTE_LOG(ERR, PRIMARY, "Failed to send\n");
+			*connected = 0;
+			return -1;
+		}
+		msg += ret;
+		len -= ret;
+	}
 
 	return 0;
 }
@@ -374,370 +363,201 @@ launch_sec_proc(char *sec_name, int sec_id, char **sec_args)
 	return 0;
 }
 
+/* Append port such as `"phy:0"` as a resource UID. */
+static void
+append_port_uid_json(struct json_writer *jw, const char *key,
+		uint16_t port_id)
+{
+	/* TODO(yasufum) Need to remove print for undefined ? */
+	if (port_map[port_id].port_type == UNDEF)
+		jw_str(jw, key, "udf");
+	else
+		jw_strf(jw, key, "%s:%u",
+				get_port_type_name(port_map[port_id].port_type),
+				port_map[port_id].id);
+}
+
 /* TODO(yasufum): change to use shared */
-static int
-append_lcore_info_json(char *str,
+static void
+append_lcore_info_json(struct json_writer *jw,
 		uint8_t lcore_id_used[RTE_MAX_LCORE])
 {
 	int i;
-	sprintf(str + strlen(str), "\"master-lcore\":%d,",
-			rte_get_master_lcore());
-	sprintf(str + strlen(str), "\"lcores\":[");
+
+	jw_int(jw, "master-lcore", rte_get_master_lcore());
+	jw_arr_begin(jw, "lcores");
 	for (i = 0; i < RTE_MAX_LCORE; i++) {
 		if (lcore_id_used[i] == 1)
-			sprintf(str + strlen(str), "%d,", i);
+			jw_int(jw, NULL, i);
 	}
-
-	/* Remove last ','. */
-	sprintf(str + strlen(str) - 1, "%s", "]");
-	return 0;
+	jw_arr_end(jw);
 }
 
 /* TODO(yasufum): change to use shared */
-static int
-append_port_info_json(char *str)
+static void
+append_port_info_json(struct json_writer *jw)
 {
 	unsigned int i;
-	unsigned int has_port = 0;  // for checking having port at last
 
-	sprintf(str + strlen(str), "\"ports\":[");
+	jw_arr_begin(jw, "ports");
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
-
 		if (ports_fwd_array[i][0].in_port_id == PORT_RESET)
 			continue;
-
-		has_port = 1;
-		switch (port_map[i].port_type) {
-		case PHY:
-			sprintf(str + strlen(str), "\"phy:%u\",",
-					port_map[i].id);
-			break;
-		case RING:
-			sprintf(str + strlen(str), "\"ring:%u\",",
-				port_map[i].id);
-			break;
-		case VHOST:
-			sprintf(str + strlen(str), "\"vhost:%u\",",
-				port_map[i].id);
-			break;
-		case PCAP:
-			sprintf(str + strlen(str), "\"pcap:%u\",",
-					port_map[i].id);
-			break;
-		case NULLPMD:
-			sprintf(str + strlen(str), "\"nullpmd:%u\",",
-					port_map[i].id);
-			break;
-		case TAP:
-			sprintf(str + strlen(str), "\"tap:%u\",",
-					port_map[i].id);
-			break;
-		case MEMIF:
-			sprintf(str + strlen(str), "\"memif:%u\",",
-					port_map[i].id);
-			break;
-		case UNDEF:
-			/* TODO(yasufum) Need to remove print for undefined ? */
-			sprintf(str + strlen(str), "\"udf\",");
-			break;
-		}
-	}
-
-	/* Check if it has at least one port to remove ",". */
-	if (has_port == 0) {
-		sprintf(str + strlen(str), "]");
-	} else {  /* Remove last ',' .*/
-		sprintf(str + strlen(str) - 1, "]");
+		append_port_uid_json(jw, NULL, i);
 	}
-
-	return 0;
+	jw_arr_end(jw);
 }
 
 /* TODO(yasufum): change to use shared */
-static int
-append_patch_info_json(char *str)
+static void
+append_patch_info_json(struct json_writer *jw)
 {
 	unsigned int i;
-	unsigned int has_patch = 0;  // for checking having patch at last
 
-	char patch_str[128];
-	sprintf(str + strlen(str), "\"patches\":[");
+	jw_arr_begin(jw, "patches");
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
-
-		if (ports_fwd_array[i][0].in_port_id == PORT_RESET)
+		if (ports_fwd_array[i][0].in_port_id == PORT_RESET ||
+				ports_fwd_array[i][0].out_port_id == PORT_RESET)
 			continue;
 
-		RTE_LOG(INFO, PRIMARY, "Port ID %d\n", i);
-		RTE_LOG(INFO, PRIMARY, "Status %d\n",
-			ports_fwd_array[i][0].in_port_id);
-
-		memset(patch_str, '\0', sizeof(patch_str));
-
-		sprintf(patch_str, "{\"src\":");
-
-		switch (port_map[i].port_type) {
-		case PHY:
-			RTE_LOG(INFO, PRIMARY, "Type: PHY\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"phy:%u\",",
-					port_map[i].id);
-			break;
-		case RING:
-			RTE_LOG(INFO, PRIMARY, "Type: RING\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"ring:%u\",",
-					port_map[i].id);
-			break;
-		case VHOST:
-			RTE_LOG(INFO, PRIMARY, "Type: VHOST\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"vhost:%u\",",
-					port_map[i].id);
-			break;
-		case PCAP:
-			RTE_LOG(INFO, PRIMARY, "Type: PCAP\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"pcap:%u\",",
-					port_map[i].id);
-			break;
-		case NULLPMD:
-			RTE_LOG(INFO, PRIMARY, "Type: NULLPMD\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"nullpmd:%u\",",
-					port_map[i].id);
-			break;
-		case TAP:
-			RTE_LOG(INFO, PRIMARY, "Type: TAP\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"tap:%u\",",
-					port_map[i].id);
-			break;
-		case MEMIF:
-			RTE_LOG(INFO, PRIMARY, "Type: MEMIF\n");
-			sprintf(patch_str + strlen(patch_str),
-					"\"memif:%u\",",
-					port_map[i].id);
-			break;
-		case UNDEF:
-			RTE_LOG(INFO, PRIMARY, "Type: UDF\n");
-			/* TODO(yasufum) Need to remove print for undefined ? */
-			sprintf(patch_str + strlen(patch_str),
-					"\"udf\",");
-			break;
-		}
-
-		sprintf(patch_str + strlen(patch_str), "\"dst\":");
-
-		RTE_LOG(INFO, PRIMARY, "Out Port ID %d\n",
+		jw_obj_begin(jw, NULL);
+		append_port_uid_json(jw, "src", i);
+		append_port_uid_json(jw, "dst",
 				ports_fwd_array[i][0].out_port_id);
-
-		if (ports_fwd_array[i][0].out_port_id == PORT_RESET) {
-			//sprintf(patch_str + strlen(patch_str), "%s", "\"\"");
-			continue;
-		} else {
-			has_patch = 1;
-			unsigned int j = ports_fwd_array[i][0].out_port_id;
-			switch (port_map[j].port_type) {
-			case PHY:
-				RTE_LOG(INFO, PRIMARY, "Type: PHY\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"phy:%u\"",
-						port_map[j].id);
-				break;
-			case RING:
-				RTE_LOG(INFO, PRIMARY, "Type: RING\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"ring:%u\"",
-						port_map[j].id);
-				break;
-			case VHOST:
-				RTE_LOG(INFO, PRIMARY, "Type: VHOST\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"vhost:%u\"",
-						port_map[j].id);
-				break;
-			case PCAP:
-				RTE_LOG(INFO, PRIMARY, "Type: PCAP\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"pcap:%u\"",
-						port_map[j].id);
-				break;
-			case NULLPMD:
-				RTE_LOG(INFO, PRIMARY, "Type: NULLPMD\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"nullpmd:%u\"",
-						port_map[j].id);
-				break;
-			case TAP:
-				RTE_LOG(INFO, PRIMARY, "Type: TAP\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"tap:%u\"",
-						port_map[j].id);
-				break;
-			case MEMIF:
-				RTE_LOG(INFO, PRIMARY, "Type: MEMIF\n");
-				sprintf(patch_str + strlen(patch_str),
-						"\"memif:%u\"",
-						port_map[j].id);
-				break;
-			case UNDEF:
-				RTE_LOG(INFO, PRIMARY, "Type: UDF\n");
-				/*
-				 * TODO(yasufum) Need to remove print for
-				 * undefined ?
-				 */
-				sprintf(patch_str + strlen(patch_str),
-						"\"udf\"");
-				break;
-			}
-		}
-
-		sprintf(patch_str + strlen(patch_str), "},");
-
-		if (has_patch != 0)
-			sprintf(str + strlen(str), "%s", patch_str);
-	}
-
-
-	/* Check if it has at least one patch to remove ",". */
-	if (has_patch == 0) {
-		sprintf(str + strlen(str), "]");
-	} else {  /* Remove last ','. */
-		sprintf(str + strlen(str) - 1, "]");
+		jw_obj_end(jw);
 	}
+	jw_arr_end(jw);
+}
 
-	return 0;
+static void
+forwarder_status_json(struct json_writer *jw)
+{
+	jw_obj_begin(jw, "forwarder");
+	jw_str(jw, "status", cmd == FORWARD ? "running" : "idling");
+	append_port_info_json(jw);
+	append_patch_info_json(jw);
+	jw_obj_end(jw);
 }
 
-static int
-forwarder_status_json(char *str)
+/* Append names of offloads such as `"vlan_strip","tcp_cksum"` to `jw`. */
+static void
+append_offload_names(struct json_writer *jw, uint64_t offloads,
+		const char *(*get_name)(uint64_t))
 {
-	char buf_running[64];
-	char buf_ports[256];
-	char buf_patches[256];
-	memset(buf_running, '\0', sizeof(buf_running));
-	memset(buf_ports, '\0', sizeof(buf_ports));
-	memset(buf_patches, '\0', sizeof(buf_patches));
-
-	sprintf(buf_running + strlen(buf_running), "\"status\":");
-	if (cmd == FORWARD)
-		sprintf(buf_running + strlen(buf_running), "\"%s\"", "running");
-	else
-		sprintf(buf_running + strlen(buf_running), "\"%s\"", "idling");
+	uint64_t bit;
 
-	append_port_info_json(buf_ports);
-	append_patch_info_json(buf_patches);
+	for (bit = 1; bit != 0; bit <<= 1) {
+		if ((offloads & bit) == 0)
+			continue;
+		jw_str(jw, NULL, get_name(bit));
+	}
+}
 
-	sprintf(str, "\"forwarder\":{%s,%s,%s}", buf_running, buf_ports,
-			buf_patches);
-	return 0;
+/* Offloads enabled for the phy port as JSON. */
+static void
+append_offload_json(struct json_writer *jw, uint16_t port_id)
+{
+	const struct offload_conf *offload = get_port_offload(port_id);
+	uint16_t mtu = 0;
+
+	rte_eth_dev_get_mtu(port_id, &mtu);
+
+	jw_obj_begin(jw, "offload");
+	jw_arr_begin(jw, "rx");
+	append_offload_names(jw, offload->rx_offloads,
+			rte_eth_dev_rx_offload_name);
+	jw_arr_end(jw);
+	jw_arr_begin(jw, "tx");
+	append_offload_names(jw, offload->tx_offloads,
+			rte_eth_dev_tx_offload_name);
+	jw_arr_end(jw);
+	jw_uint(jw, "rss_hf", offload->rss_hf);
+	jw_uint(jw, "mtu", mtu);
+	jw_obj_end(jw);
 }
 
-static int
-phy_port_stats_json(char *str)
+static void
+phy_port_stats_json(struct json_writer *jw)
 {
-	int i, ret;
-	int buf_size = PRI_BUF_SIZE_PHY - 512;  /* size of temp buffer */
-	char phy_port[PRI_BUF_SIZE_PHY];
-	char flow[buf_size];
-	char buf_phy_ports[PRI_BUF_SIZE_PHY];
-	memset(phy_port, '\0', sizeof(phy_port));
-	memset(buf_phy_ports, '\0', sizeof(buf_phy_ports));
+	struct stats st;
+	int i;
 
+	jw_arr_begin(jw, "phy_ports");
 	for (i = 0; i < ports->num_ports; i++) {
-
-		RTE_LOG(DEBUG, PRIMARY, "Size of buf_phy_ports str: %d\n",
-				(int)strlen(buf_phy_ports));
-
-		memset(phy_port, '\0', PRI_BUF_SIZE_PHY);
-		memset(flow, '\0', buf_size);
-
-		ret = append_flow_json(i, buf_size, flow);
-		if (ret != 0) {
-			sprintf(buf_phy_ports + strlen(buf_phy_ports) - 1,
-					"%s", "");
-			break;
-		}
-
-		sprintf(phy_port, "{\"id\":%u,\"eth\":\"%s\","
-				"\"rx\":%"PRIu64",\"tx\":%"PRIu64","
-				"\"tx_drop\":%"PRIu64","
-				"\"nof_queues\":{\"rx\":%d,\"tx\":%d},"
-				"\"flow\":%s}",
-				ports->id[i],
-				get_printable_mac_addr(ports->id[i]),
-				ports->port_stats[i].rx,
-				ports->port_stats[i].tx,
-				ports->port_stats[i].tx_drop,
-				ports->queue_info[i].rxq,
-				ports->queue_info[i].txq,
-				flow);
-
-		int cur_buf_size = (int)strlen(buf_phy_ports) +
-			(int)strlen(phy_port);
-		if (cur_buf_size > PRI_BUF_SIZE_PHY - 1) {
-			RTE_LOG(ERR, PRIMARY,
-				"Cannot send all of phy_port stats (%d/%d)\n",
-				i, ports->num_ports);
-			sprintf(buf_phy_ports + strlen(buf_phy_ports) - 1,
-					"%s", "");
-			break;
-		}
-
-		sprintf(buf_phy_ports + strlen(buf_phy_ports), "%s", phy_port);
-
-		if (i < ports->num_ports - 1)
-			sprintf(buf_phy_ports, "%s,", buf_phy_ports);
+		sum_port_stats(ports, i, &st);
+
+		jw_obj_begin(jw, NULL);
+		jw_uint(jw, "id", ports->id[i]);
+		jw_str(jw, "eth", get_printable_mac_addr(ports->id[i]));
+		jw_uint(jw, "rx", st.rx);
+		jw_uint(jw, "tx", st.tx);
+		jw_uint(jw, "tx_drop", st.tx_drop);
+		jw_obj_begin(jw, "nof_queues");
+		jw_int(jw, "rx", ports->queue_info[i].rxq);
+		jw_int(jw, "tx", ports->queue_info[i].txq);
+		jw_obj_end(jw);
+		append_offload_json(jw, ports->id[i]);
+		append_eth_stats_json(jw, "hw", ports->id[i]);
+		jw_uint(jw, "nof_flow_rules",
+				get_nof_flow_rules(ports->id[i]));
+		append_flow_json(jw, "flow", ports->id[i]);
+		jw_obj_end(jw);
 	}
-	sprintf(str, "\"phy_ports\":[%s]", buf_phy_ports);
-	return 0;
+	jw_arr_end(jw);
 }
 
-static int
-ring_port_stats_json(char *str)
+static void
+ring_port_stats_json(struct json_writer *jw)
 {
+	struct stats st;
 	int i;
-	int buf_size = 256;  /* size of temp buffer */
-	char buf_ring_ports[PRI_BUF_SIZE_RING];
-	char ring_port[buf_size];
-	memset(ring_port, '\0', sizeof(ring_port));
-	memset(buf_ring_ports, '\0', sizeof(buf_ring_ports));
 
+	jw_arr_begin(jw, "ring_ports");
 	for (i = 0; i < num_rings; i++) {
+		sum_client_stats(ports, i, &st);
+
+		jw_obj_begin(jw, NULL);
+		jw_uint(jw, "id", i);
+		jw_uint(jw, "rx", st.rx);
+		jw_uint(jw, "rx_drop", st.rx_drop);
+		jw_uint(jw, "tx", st.tx);
+		jw_uint(jw, "tx_drop", st.tx_drop);
+		jw_obj_end(jw);
+	}
+	jw_arr_end(jw);
+}
 
-		RTE_LOG(DEBUG, PRIMARY, "Size of buf_ring_ports str: %d\n",
-				(int)strlen(buf_ring_ports));
-
-		memset(ring_port, '\0', buf_size);
+/*
+ * Fill counters of phy and ring ports, and forwarding lcores to the stats
+ * segment. Counters of ring ports include ones of secondaries.
+ */
+static void
+collect_primary_stats(struct shm_stats *st)
+{
+	struct shm_port_stats *port_st;
+	uint16_t i;
 
-		sprintf(ring_port, "{\"id\":%u,\"rx\":%"PRIu64","
-			"\"rx_drop\":%"PRIu64","
-			"\"tx\":%"PRIu64",\"tx_drop\":%"PRIu64"}",
-			i,
-			ports->client_stats[i].rx,
-			ports->client_stats[i].rx_drop,
-			ports->client_stats[i].tx,
-			ports->client_stats[i].tx_drop);
+	for (i = 0; i < ports->num_ports; i++) {
+		port_st = &st->ports[st->nof_ports++];
+		port_st->port_type = PHY;
+		port_st->port_id = ports->id[i];
+		sum_port_stats(ports, i, &port_st->stats);
+	}
 
-		int cur_buf_size = (int)strlen(buf_ring_ports) +
-			(int)strlen(ring_port);
-		if (cur_buf_size >  PRI_BUF_SIZE_RING - 1) {
-			RTE_LOG(ERR, PRIMARY,
-				"Cannot send all of ring_port stats (%d/%d)\n",
-				i, num_rings);
-			sprintf(buf_ring_ports + strlen(buf_ring_ports) - 1,
-					"%s", "");
-			break;
-		}
+	for (i = 0; i < num_rings && i < MAX_CLIENT; i++) {
+		port_st = &st->ports[st->nof_ports++];
+		port_st->port_type = RING;
+		port_st->port_id = i;
+		sum_client_stats(ports, i, &port_st->stats);
+	}
 
-		sprintf(buf_ring_ports + strlen(buf_ring_ports),
-				"%s", ring_port);
+	if (get_forwarding_flg() == 1)
+		collect_fwd_lcore_stats(st);
 
-		if (i < num_rings - 1)
-			sprintf(buf_ring_ports, "%s,", buf_ring_ports);
+	if (shm_stats_eth_due(st)) {
+		for (i = 0; i < ports->num_ports; i++)
+			collect_eth_stats(st, ports->id[i]);
 	}
-	sprintf(str, "\"ring_ports\":[%s]", buf_ring_ports);
-	return 0;
 }
 
 /**
@@ -769,43 +589,26 @@ ring_port_stats_json(char *str)
  *         "id": 0,
  *         "rx": 0,
  *         "tx": 0,
- *         "tx_drop": 0
+ *         "tx_drop": 0,
+ *         "offload": {"rx": [], "tx": [], "rss_hf": 0, "mtu": 1500}
  *     },
  *     ...
  *     ]
  * }
  */
-static int
-get_status_json(char *str)
+static void
+get_status_json(struct json_writer *jw)
 {
-	char buf_lcores[PRI_BUF_SIZE_LCORE];
-	char buf_phy_ports[PRI_BUF_SIZE_PHY];
-	char buf_ring_ports[PRI_BUF_SIZE_RING];
-	memset(buf_phy_ports, '\0', PRI_BUF_SIZE_PHY);
-	memset(buf_ring_ports, '\0', PRI_BUF_SIZE_RING);
-	memset(buf_lcores, '\0', PRI_BUF_SIZE_LCORE);
-
-	append_lcore_info_json(buf_lcores, lcore_id_used);
-	phy_port_stats_json(buf_phy_ports);
-	ring_port_stats_json(buf_ring_ports);
-
-	RTE_LOG(INFO, PRIMARY, "%s, %s\n", buf_phy_ports, buf_ring_ports);
-
-	if (get_forwarding_flg() == 1) {
-		char tmp_buf[512];
-		memset(tmp_buf, '\0', sizeof(tmp_buf));
-		forwarder_status_json(tmp_buf);
-
-		sprintf(str, "{%s,%s,%s,%s}",
-				buf_lcores, tmp_buf, buf_phy_ports,
-				buf_ring_ports);
-
-	} else {
-		sprintf(str, "{%s,%s,%s}",
-				buf_lcores, buf_phy_ports, buf_ring_ports);
-	}
-
-	return 0;
+	jw_obj_begin(jw, NULL);
+	append_lcore_info_json(jw, lcore_id_used);
+	if (get_forwarding_flg() == 1)
+		forwarder_status_json(jw);
+	phy_port_stats_json(jw);
+	ring_port_stats_json(jw);
+	jw_obj_end(jw);
+
+	if (jw_error(jw) < 0)
+		RTE_LOG(ERR, PRIMARY, "Failed to make status message\n");
 }
 
 /**
@@ -816,54 +619,42 @@ get_status_json(char *str)
 static int
 add_port(char *p_type, int p_id)
 {
-	uint16_t dev_id;
+	enum port_type type = UNDEF;
 	uint16_t port_id;
 	int res = 0;
-	uint16_t cnt = 0;
-
-	for (dev_id = 0; dev_id < RTE_MAX_ETHPORTS; dev_id++) {
-		if (port_id_list[dev_id].port_id == PORT_RESET)
-			break;
-		cnt += 1;
-	}
 
 	if (!strcmp(p_type, "vhost")) {
+		type = VHOST;
 		res = add_vhost_pmd(p_id);
-		port_id_list[cnt].port_id = p_id;
-		port_id_list[cnt].type = VHOST;
 
 	} else if (!strcmp(p_type, "ring")) {
+		type = RING;
 		res = add_ring_pmd(p_id);
-		port_id_list[cnt].port_id = p_id;
-		port_id_list[cnt].type = RING;
 
 	} else if (!strcmp(p_type, "pcap")) {
+		type = PCAP;
 		res = add_pcap_pmd(p_id);
-		port_id_list[cnt].port_id = p_id;
-		port_id_list[cnt].type = PCAP;
 
 	} else if (!strcmp(p_type, "memif")) {
+		type = MEMIF;
 		res = add_memif_pmd(p_id);
-		port_id_list[cnt].port_id = p_id;
-		port_id_list[cnt].type = MEMIF;
 
 	} else if (!strcmp(p_type, "nullpmd")) {
+		type = NULLPMD;
 		res = add_null_pmd(p_id);
-		port_id_list[cnt].port_id = p_id;
-		port_id_list[cnt].type = NULLPMD;
 	}
 
 	if (res < 0)
 		return -1;
 
 	port_id = (uint16_t) res;
-	port_map[port_id].id = p_id;
-	port_map[port_id].port_type = port_id_list[cnt].type;
-	if (port_map[port_id].port_type == RING)
-		port_map[port_id].stats = &ports->client_stats[p_id];
-	/* NOTE: port_map[].stats points to &port_map[].default_stats
-	 * other than RING. There is no support to show/clear this stats
-	 * at the moment.
+	set_port_map_id(port_id, type, p_id);
+	if (type == RING) {
+		port_map[port_id].stats_type = STATS_CLIENT;
+		port_map[port_id].stats_idx = p_id;
+	}
+	/* NOTE: Counters of ports other than RING are not shared, and
+	 * there is no support to show/clear this stats at the moment.
 	 */
 
 	/* Update ports_fwd_array with port id */
@@ -871,81 +662,53 @@ add_port(char *p_type, int p_id)
 	return 0;
 }
 
-/* Find ethdev ID from resource UID to delete. */
-static uint16_t
-find_ethdev_id(int p_id, enum port_type ptype)
-{
-	int cnt;
-	struct port_id_map *p_map;
-
-	RTE_LOG(DEBUG, PRIMARY, "Finding ethdev_id, p_id: %d, ptype: %d\n",
-			p_id, ptype);
-
-	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		p_map = &port_id_list[cnt];
-		if (p_map == NULL)
-			RTE_LOG(ERR, PRIMARY, "Failed to find port_id.\n");
-		else {
-			if (p_map->port_id == p_id &&
-					p_map->type == ptype)
-				return cnt;
-		}
-	}
-
-	return PORT_RESET;
-}
-
 /* Delete port. */
 /* TODO(yasufum) consider to merge do_del in nfv/commands.h */
 static int
 del_port(char *p_type, int p_id)
 {
-	uint16_t dev_id = 0;
+	enum port_type type = get_port_type(p_type);
+	uint16_t dev_id;
 
-	if (!strcmp(p_type, "vhost")) {
-		dev_id = find_ethdev_id(p_id, VHOST);
-		if (dev_id == PORT_RESET)
-			return -1;
-		rte_eth_dev_stop(dev_id);
-		dev_detach_by_port_id(dev_id);
+	switch (type) {
+	case VHOST:
+	case RING:
+	case PCAP:
+	case MEMIF:
+	case NULLPMD:
+		break;
+	default:
+		return -1;
+	}
 
-	} else if (!strcmp(p_type, "ring")) {
-		dev_id = find_ethdev_id(p_id, RING);
-		if (dev_id == PORT_RESET)
-			return -1;
-		rte_eth_dev_stop(dev_id);
-		rte_eth_dev_close(dev_id);
+	dev_id = find_port_id(p_id, type);
+	if (dev_id == PORT_RESET)
+		return -1;
 
-	} else if (!strcmp(p_type, "pcap")) {
-		dev_id = find_ethdev_id(p_id, PCAP);
-		if (dev_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(dev_id);
+	/* Remove patches of the port before stopping it. */
+	forward_array_remove(dev_id, 0);
 
-	} else if (!strcmp(p_type, "memif")) {
-		dev_id = find_ethdev_id(p_id, MEMIF);
-		if (dev_id == PORT_RESET)
-			return -1;
+	switch (type) {
+	case VHOST:
+		rte_eth_dev_stop(dev_id);
 		dev_detach_by_port_id(dev_id);
-
-	} else if (!strcmp(p_type, "nullpmd")) {
-		dev_id = find_ethdev_id(p_id, NULLPMD);
-		if (dev_id == PORT_RESET)
-			return -1;
+		break;
+	case RING:
+		rte_eth_dev_stop(dev_id);
+		rte_eth_dev_close(dev_id);
+		break;
+	default:
 		dev_detach_by_port_id(dev_id);
+		break;
 	}
 
-	port_id_list[dev_id].port_id = PORT_RESET;
-	port_id_list[dev_id].type = UNDEF;
-
-	forward_array_remove(dev_id, 0);
 	port_map_init_one(dev_id);
 
 	return 0;
 }
 
 static int
-parse_command(char *str)
+parse_command(char *str, struct json_writer *res)
 {
 	char *token_list[MAX_PARAMETER] = {NULL};
 	char sec_name[16];
@@ -954,16 +717,19 @@ parse_command(char *str)
 	int max_token = 0;
 	uint16_t dev_id;
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
-	char result[16] = { 0 };  /* "succeeded" or "failed". */
-	char port_uid[20] = { 0 };  /* "\"%s:%d\"" */
-	char patch_set[64] = { 0 };  /* "{\"src\":\"%s:%d\",\"dst\":...}" */
+	const char *result;  /* "succeeded" or "failed". */
 	char *p_type;
 	int p_id;
-	char tmp_response[MSG_SIZE];
 	uint16_t queue_id;
 
 	memset(sec_name, '\0', 16);
-	memset(tmp_response, '\0', MSG_SIZE);
+	jw_reset(res);
+
+	/* Flow command is tokenized by itself for rules given in bulk. */
+	if (!strncmp(str, "flow ", 5)) {
+		RTE_LOG(DEBUG, PRIMARY, "'flow' command received.\n");
+		return parse_flow(str, res);
+	}
 
 	/* tokenize the user commands from controller */
 	token_list[max_token] = strtok(str, " ");
@@ -982,9 +748,7 @@ parse_command(char *str)
 	if (!strcmp(token_list[0], "status")) {
 		RTE_LOG(DEBUG, PRIMARY, "'status' command received.\n");
 
-		/* Clear str and token_list nouse already */
-		memset(str, '\0', MSG_SIZE);
-		ret = get_status_json(str);
+		get_status_json(res);
 
 		/* Output all of ports under management for debugging. */
 		RTE_ETH_FOREACH_DEV(dev_id) {
@@ -1003,28 +767,40 @@ parse_command(char *str)
 
 		if (ret < 0) {
 			RTE_LOG(ERR, PRIMARY, "Failed to launch secondary.\n");
-			sprintf(result, "%s", "\"failed\"");
+			result = "failed";
 		} else
-			sprintf(result, "%s", "\"succeeded\"");
+			result = "succeeded";
 
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"launch\"");
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "launch");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "stop")) {
 		RTE_LOG(DEBUG, PRIMARY, "stop\n");
 		cmd = STOP;
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"stop\"");
+		if (wait_fwd_lcores(STOP) < 0)
+			result = "failed";
+		else
+			result = "succeeded";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "stop");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "forward")) {
 		RTE_LOG(DEBUG, PRIMARY, "forward\n");
 		cmd = FORWARD;
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"forward\"");
+		if (wait_fwd_lcores(FORWARD) < 0)
+			result = "failed";
+		else
+			result = "succeeded";
+
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "forward");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "add")) {
 		RTE_LOG(DEBUG, PRIMARY, "'%s' command received.\n",
@@ -1039,16 +815,15 @@ parse_command(char *str)
 
 		if (add_port(p_type, p_id) < 0) {
 			RTE_LOG(ERR, PRIMARY, "Failed to add_port()\n");
-			sprintf(result, "%s", "\"failed\"");
+			result = "failed";
 		} else
-			sprintf(result, "%s", "\"succeeded\"");
+			result = "succeeded";
 
-		sprintf(port_uid, "\"%s:%d\"", p_type, p_id);
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"add\"",
-				"\"port\"", port_uid);
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "add");
+		jw_strf(res, "port", "%s:%d", p_type, p_id);
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "del")) {
 		RTE_LOG(DEBUG, PRIMARY, "Received del command\n");
@@ -1062,16 +837,15 @@ parse_command(char *str)
 
 		if (del_port(p_type, p_id) < 0) {
 			RTE_LOG(ERR, PRIMARY, "Failed to del_port()\n");
-			sprintf(result, "%s", "\"failed\"");
+			result = "failed";
 		} else
-			sprintf(result, "%s", "\"succeeded\"");
+			result = "succeeded";
 
-		sprintf(port_uid, "\"%s:%d\"", p_type, p_id);
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-				"\"result\"", result,
-				"\"command\"", "\"del\"",
-				"\"port\"", port_uid);
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", result);
+		jw_str(res, "command", "del");
+		jw_strf(res, "port", "%s:%d", p_type, p_id);
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "patch")) {
 		RTE_LOG(DEBUG, PRIMARY, "patch\n");
@@ -1082,6 +856,11 @@ parse_command(char *str)
 		if (strncmp(token_list[1], "reset", 5) == 0) {
 			/* reset forward array*/
 			forward_array_reset();
+
+			jw_obj_begin(res, NULL);
+			jw_str(res, "result", "succeeded");
+			jw_str(res, "command", "patch");
+			jw_obj_end(res);
 		} else {
 			uint16_t in_port;
 			uint16_t out_port;
@@ -1135,21 +914,20 @@ parse_command(char *str)
 					"Patched '%s:%d' and '%s:%d'\n",
 					in_p_type, in_p_id,
 					out_p_type, out_p_id);
-				sprintf(result, "%s", "\"succeeded\"");
+				result = "succeeded";
 			} else {
 				RTE_LOG(ERR, PRIMARY, "Failed to patch\n");
-				sprintf(result, "%s", "\"failed\"");
+				result = "failed";
 			}
 
-			sprintf(patch_set,
-				"{\"src\":\"%s:%d\",\"dst\":\"%s:%d\"}",
-				in_p_type, in_p_id, out_p_type, out_p_id);
-
-			memset(str, '\0', MSG_SIZE);
-			sprintf(str, "{%s:%s,%s:%s,%s:%s}",
-					"\"result\"", result,
-					"\"command\"", "\"patch\"",
-					"\"ports\"", patch_set);
+			jw_obj_begin(res, NULL);
+			jw_str(res, "result", result);
+			jw_str(res, "command", "patch");
+			jw_obj_begin(res, "ports");
+			jw_strf(res, "src", "%s:%d", in_p_type, in_p_id);
+			jw_strf(res, "dst", "%s:%d", out_p_type, out_p_id);
+			jw_obj_end(res);
+			jw_obj_end(res);
 
 			ret = 0;
 		}
@@ -1158,32 +936,32 @@ parse_command(char *str)
 		RTE_LOG(DEBUG, PRIMARY, "'exit' command received.\n");
 		cmd = STOP;
 		ret = -1;
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"exit\"");
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", "succeeded");
+		jw_str(res, "command", "exit");
+		jw_obj_end(res);
 
 	} else if (!strcmp(token_list[0], "clear")) {
 		clear_stats();
-		memset(str, '\0', MSG_SIZE);
-		sprintf(str, "{%s:%s,%s:%s}",
-				"\"result\"", "\"succeeded\"",
-				"\"command\"", "\"clear\"");
+		jw_obj_begin(res, NULL);
+		jw_str(res, "result", "succeeded");
+		jw_str(res, "command", "clear");
+		jw_obj_end(res);
 
-	} else if (!strcmp(token_list[0], "flow")) {
-		RTE_LOG(DEBUG, PRIMARY, "'%s' command received.\n",
-				token_list[0]);
-		ret = parse_flow(token_list, tmp_response);
-		memset(str, '\0', MSG_SIZE);
-		strncpy(str, tmp_response, MSG_SIZE-1);
 	}
 
 	return ret;
 }
 
+/*
+ * Receive a command terminated with '\0' from spp-ctl. A large command,
+ * such as bulk flow rules, can be split into several segments, so that it
+ * is received until the terminator.
+ */
 static int
 do_receive(int *connected, int *sock, char *str)
 {
+	size_t len = 0;
 	int ret;
 
 	memset(str, '\0', MSG_SIZE);
@@ -1198,23 +976,38 @@ do_receive(int *connected, int *sock, char *str)
 		return -1;
 	}
 
-	ret = recv(*sock, str, MSG_SIZE, 0);
-	if (ret <= 0) {
-		RTE_LOG(DEBUG, PRIMARY, "Receive count: %d\n", ret);
+	while (1) {
+		/* Keep the last byte for '\0' not to overrun. */
+		ret = recv(*sock, str + len, MSG_SIZE - 1 - len, 0);
+		if (ret <= 0) {
+			RTE_LOG(DEBUG, PRIMARY, "Receive count: %d\n", ret);
 
-		if (ret < 0)
-			RTE_LOG(ERR, PRIMARY, "Receive Fail");
-		else
-			RTE_LOG(INFO, PRIMARY, "Receive 0\n");
+			if (ret < 0)
+				RTE_LOG(ERR, PRIMARY, "Receive Fail");
+			else
+				RTE_LOG(INFO, PRIMARY, "Receive 0\n");
 
-		RTE_LOG(INFO, PRIMARY, "Assume Server closed connection\n");
-		close(*sock);
-		*sock = SOCK_RESET;
-		*connected = 0;
-		return -1;
+			RTE_LOG(INFO, PRIMARY,
+				"Assume Server closed connection\n");
+			break;
+		}
+
+		if (memchr(str + len, '\0', ret) != NULL)
+			return 0;
+
+		len += ret;
+		if (len >= MSG_SIZE - 1) {
+			RTE_LOG(ERR, PRIMARY,
+				"Command exceeds %d bytes\n", MSG_SIZE - 1);
+			break;
+		}
 	}
 
-	return 0;
+	/* Reset connection because rest of the command cannot be known. */
+	close(*sock);
+	*sock = SOCK_RESET;
+	*connected = 0;
+	return -1;
 }
 
 static int
@@ -1260,11 +1053,11 @@ int
 main(int argc, char *argv[])
 {
 	int sock = SOCK_RESET;
-	uint16_t dev_id;
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
 	unsigned int nb_ports;
 	int connected = 0;
 	char str[MSG_SIZE];
+	struct json_writer res;
 	int flg_exit;  // used as res of parse_command() to exit if -1
 	int ret;
 	int port_type;
@@ -1285,23 +1078,14 @@ main(int argc, char *argv[])
 	/* clear statistics */
 	clear_stats();
 
-	memset(port_id_list, 0x00,
-			sizeof(struct port_id_map) * RTE_MAX_ETHPORTS);
-	for (dev_id = 0; dev_id < RTE_MAX_ETHPORTS; dev_id++) {
-		ret = rte_eth_dev_get_name_by_port(dev_id, dev_name);
-		if (ret > -1) {
-			port_id_list[dev_id].port_id = dev_id;
-			port_id_list[dev_id].type = PHY;
-		} else {
-			port_id_list[dev_id].port_id = PORT_RESET;
-			port_id_list[dev_id].type = UNDEF;
-		}
-	}
-
 	if (get_forwarding_flg() == 1) {
 		/* initialize port forward array*/
 		forward_array_init();
 		port_map_init();
+		fwd_lcores_init();
+		if (init_lcore_patches() < 0)
+			rte_exit(EXIT_FAILURE,
+				"Cannot allocate patches of lcores\n");
 
 		/* Check an even number of ports to send/receive on. */
 		nb_ports = rte_eth_dev_count_avail();
@@ -1327,9 +1111,9 @@ main(int argc, char *argv[])
 			/* Update ports_fwd_array with phy port. */
 			ports_fwd_array[i][0].in_port_id = i;
 			ports_fwd_array[i][0].in_queue_id = 0;
-			port_map[i].port_type = port_type;
-			port_map[i].id = port_id;
-			port_map[i].stats = &ports->port_stats[i];
+			set_port_map_id(i, port_type, port_id);
+			port_map[i].stats_type = STATS_PORT;
+			port_map[i].stats_idx = i;
 			port_map[i].queue_info = NULL;
 
 			/* TODO(yasufum) convert type of port_type to char */
@@ -1344,6 +1128,15 @@ main(int argc, char *argv[])
 		/* put all other cores to sleep bar master */
 		rte_eal_mp_remote_launch(sleep_lcore, NULL, SKIP_MASTER);
 
+	/* Publish counters to be read without `status` command. */
+	if (shm_stats_init("primary", 0, collect_primary_stats) == 0)
+		shm_stats_start_thread();
+
+	if (metrics_addr != NULL && metrics_start(metrics_addr) < 0)
+		rte_exit(EXIT_FAILURE, "Cannot start metrics exporter\n");
+
+	jw_init(&res);
+
 	while (on) {
 		ret = do_connection(&connected, &sock);
 		if (ret < 0) {
@@ -1357,10 +1150,10 @@ main(int argc, char *argv[])
 
 		RTE_LOG(DEBUG, PRIMARY, "Received string: %s\n", str);
 
-		flg_exit = parse_command(str);
+		flg_exit = parse_command(str, &res);
 
 		/* Send the message back to client */
-		ret = do_send(&connected, &sock, str);
+		ret = do_send(&connected, &sock, &res);
 
 		if (flg_exit < 0)  /* terminate process if exit is called */
 			break;
@@ -1369,6 +1162,7 @@ main(int argc, char *argv[])
 	}
 
 	/* exit */
+	jw_free(&res);
 	close(sock);
 	sock = SOCK_RESET;
 	RTE_LOG(INFO, PRIMARY, "spp_primary exit.\n");
@@ -0,0 +1,743 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+
+#include "shared/common.h"
+#include "shared/port_manager.h"
+#include "shared/shm_stats.h"
+#include "metrics.h"
+#include "primary.h"
+
+#define METRICS_MAX_PROCS (MAX_CLIENT + 1)  /* Secondaries and primary. */
+#define METRICS_REQ_SIZE 1024
+#define METRICS_BUF_INIT_SIZE 65536
+#define METRICS_BACKLOG 8
+#define METRICS_RECV_TIMEOUT_S 1
+
+/* Text of metrics served for each of requests, extended if it is full. */
+struct metrics_buf {
+	char *str;
+	size_t len;
+	size_t size;
+};
+
+/* Counter in struct stats or struct rte_eth_stats, or its rate. */
+struct metric_def {
+	const char *name;
+	const char *help;
+	size_t offset;  /* Offset of uint64_t counter in the struct. */
+	unsigned int rate_scale;  /* 0 for the counter, or scale of rate. */
+};
+
+/* Snapshots of stats segment of a process for calculating rates. */
+struct metrics_proc {
+	char proc_name[SHM_STATS_NAME_LEN];
+	int client_id;
+	int is_found;  /* Found in the latest sampling. */
+	int has_prev;  /* Previous snapshot is of the same process. */
+	struct shm_stats *cur;
+	struct shm_stats *prev;
+};
+
+/* Snapshot of counters of ethdev ports. */
+struct metrics_eth {
+	int is_valid;
+	struct rte_eth_stats stats;
+};
+
+static const struct metric_def port_metrics[] = {
+	{ "spp_port_rx_packets_total", "Packets received on the port.",
+		offsetof(struct stats, rx), 0 },
+	{ "spp_port_tx_packets_total", "Packets sent to the port.",
+		offsetof(struct stats, tx), 0 },
+	{ "spp_port_rx_dropped_total", "Packets dropped in RX.",
+		offsetof(struct stats, rx_drop), 0 },
+	{ "spp_port_tx_dropped_total", "Packets dropped in TX.",
+		offsetof(struct stats, tx_drop), 0 },
+	{ "spp_port_rx_pps", "Packets received per second.",
+		offsetof(struct stats, rx), 1 },
+	{ "spp_port_tx_pps", "Packets sent per second.",
+		offsetof(struct stats, tx), 1 },
+	{ "spp_port_rx_drop_pps", "Packets dropped in RX per second.",
+		offsetof(struct stats, rx_drop), 1 },
+	{ "spp_port_tx_drop_pps", "Packets dropped in TX per second.",
+		offsetof(struct stats, tx_drop), 1 },
+};
+
+static const struct metric_def comp_metrics[] = {
+	{ "spp_component_rx_packets_total", "Packets received by component.",
+		offsetof(struct stats, rx), 0 },
+	{ "spp_component_tx_packets_total", "Packets sent by component.",
+		offsetof(struct stats, tx), 0 },
+	{ "spp_component_tx_dropped_total", "Packets dropped in TX.",
+		offsetof(struct stats, tx_drop), 0 },
+	{ "spp_component_rx_pps", "Packets received per second.",
+		offsetof(struct stats, rx), 1 },
+	{ "spp_component_tx_pps", "Packets sent per second.",
+		offsetof(struct stats, tx), 1 },
+	{ "spp_component_tx_drop_pps", "Packets dropped in TX per second.",
+		offsetof(struct stats, tx_drop), 1 },
+};
+
+static const struct metric_def eth_metrics[] = {
+	{ "spp_ethdev_rx_packets_total", "Packets received by the NIC.",
+		offsetof(struct rte_eth_stats, ipackets), 0 },
+	{ "spp_ethdev_tx_packets_total", "Packets sent by the NIC.",
+		offsetof(struct rte_eth_stats, opackets), 0 },
+	{ "spp_ethdev_rx_bytes_total", "Bytes received by the NIC.",
+		offsetof(struct rte_eth_stats, ibytes), 0 },
+	{ "spp_ethdev_tx_bytes_total", "Bytes sent by the NIC.",
+		offsetof(struct rte_eth_stats, obytes), 0 },
+	{ "spp_ethdev_rx_missed_total", "Packets dropped by the NIC.",
+		offsetof(struct rte_eth_stats, imissed), 0 },
+	{ "spp_ethdev_rx_errors_total", "Erroneous packets received.",
+		offsetof(struct rte_eth_stats, ierrors), 0 },
+	{ "spp_ethdev_tx_errors_total", "Packets failed to be sent.",
+		offsetof(struct rte_eth_stats, oerrors), 0 },
+	{ "spp_ethdev_rx_nombuf_total", "RX failures for no mbufs.",
+		offsetof(struct rte_eth_stats, rx_nombuf), 0 },
+	{ "spp_ethdev_rx_pps", "Packets received per second.",
+		offsetof(struct rte_eth_stats, ipackets), 1 },
+	{ "spp_ethdev_tx_pps", "Packets sent per second.",
+		offsetof(struct rte_eth_stats, opackets), 1 },
+	{ "spp_ethdev_rx_bps", "Bits received per second.",
+		offsetof(struct rte_eth_stats, ibytes), 8 },
+	{ "spp_ethdev_tx_bps", "Bits sent per second.",
+		offsetof(struct rte_eth_stats, obytes), 8 },
+	{ "spp_ethdev_rx_missed_pps", "Packets dropped by the NIC per second.",
+		offsetof(struct rte_eth_stats, imissed), 1 },
+};
+
+static int listen_fd = -1;
+static struct metrics_buf metrics_out;
+
+static struct metrics_proc metrics_procs[METRICS_MAX_PROCS];
+static int nof_metrics_procs;
+
+static struct metrics_eth eth_snaps[2][RTE_MAX_ETHPORTS];
+static struct metrics_eth *eth_cur = eth_snaps[0];
+static struct metrics_eth *eth_prev = eth_snaps[1];
+static uint64_t eth_cur_tsc, eth_prev_tsc;
+
+/* Append formatted string to the buffer, and extend it if it is full. */
+static void
+metrics_printf(struct metrics_buf *buf, const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+	char *str;
+
+	while (1) {
+		va_start(ap, fmt);
+		len = vsnprintf(buf->str + buf->len, buf->size - buf->len,
+				fmt, ap);
+		va_end(ap);
+		if (len < 0)
+			return;
+		if (buf->len + len < buf->size)
+			break;
+
+		str = realloc(buf->str, buf->size * 2);
+		if (str == NULL) {
+			buf->str[buf->len] = '\0';
+			return;
+		}
+		buf->str = str;
+		buf->size *= 2;
+	}
+	buf->len += len;
+}
+
+static void
+print_header(struct metrics_buf *buf, const char *name, const char *help,
+		int is_counter)
+{
+	metrics_printf(buf, "# HELP %s %s\n# TYPE %s %s\n", name, help,
+			name, is_counter ? "counter" : "gauge");
+}
+
+static inline uint64_t
+get_counter(const void *base, size_t offset)
+{
+	return *(const uint64_t *)((const char *)base + offset);
+}
+
+/*
+ * Print value of the metric, or its rate from `prev` sampled `diff_tsc`
+ * before. The rate is 0 if there is no previous one or it is reset.
+ */
+static void
+print_value(struct metrics_buf *buf, const struct metric_def *def,
+		const void *cur, const void *prev, uint64_t diff_tsc,
+		uint64_t tsc_hz)
+{
+	uint64_t cur_val = get_counter(cur, def->offset);
+	uint64_t prev_val;
+	double rate = 0;
+
+	if (def->rate_scale == 0) {
+		metrics_printf(buf, " %"PRIu64"\n", cur_val);
+		return;
+	}
+
+	if (prev != NULL && diff_tsc > 0) {
+		prev_val = get_counter(prev, def->offset);
+		if (cur_val >= prev_val)
+			rate = (double)(cur_val - prev_val) * def->rate_scale *
+				tsc_hz / diff_tsc;
+	}
+	metrics_printf(buf, " %.1f\n", rate);
+}
+
+static const struct shm_port_stats *
+find_prev_port(const struct shm_stats *prev, const struct shm_port_stats *p)
+{
+	unsigned int i;
+
+	for (i = 0; i < prev->nof_ports; i++) {
+		if (prev->ports[i].port_type == p->port_type &&
+				prev->ports[i].port_id == p->port_id)
+			return &prev->ports[i];
+	}
+	return NULL;
+}
+
+static const struct shm_lcore_stats *
+find_prev_lcore(const struct shm_stats *prev, unsigned int lcore_id)
+{
+	unsigned int i;
+
+	for (i = 0; i < prev->nof_lcores; i++) {
+		if (prev->lcores[i].lcore_id == lcore_id)
+			return &prev->lcores[i];
+	}
+	return NULL;
+}
+
+static const struct shm_comp_stats *
+find_prev_comp(const struct shm_stats *prev, const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < prev->nof_comps; i++) {
+		if (strcmp(prev->comps[i].name, name) == 0)
+			return &prev->comps[i];
+	}
+	return NULL;
+}
+
+/* Get snapshot of the process from its stats segment found by walking. */
+static void
+sample_proc(const struct shm_stats *st, void *arg __rte_unused)
+{
+	struct metrics_proc *proc = NULL;
+	struct shm_stats *tmp;
+	int i;
+
+	for (i = 0; i < nof_metrics_procs; i++) {
+		if (strcmp(metrics_procs[i].proc_name, st->proc_name) == 0 &&
+				metrics_procs[i].client_id == st->client_id) {
+			proc = &metrics_procs[i];
+			break;
+		}
+	}
+
+	if (proc == NULL) {
+		if (nof_metrics_procs >= METRICS_MAX_PROCS)
+			return;
+		proc = &metrics_procs[nof_metrics_procs];
+		proc->cur = calloc(1, sizeof(struct shm_stats));
+		proc->prev = calloc(1, sizeof(struct shm_stats));
+		if (proc->cur == NULL || proc->prev == NULL) {
+			free(proc->cur);
+			free(proc->prev);
+			proc->cur = proc->prev = NULL;
+			return;
+		}
+		snprintf(proc->proc_name, sizeof(proc->proc_name), "%s",
+				st->proc_name);
+		proc->client_id = st->client_id;
+		nof_metrics_procs++;
+	} else if (proc->is_found) {
+		return;  /* Duplicated, it should not be happened. */
+	}
+
+	/* Keep the previous one if succeeded to get a new one. */
+	tmp = proc->prev;
+	proc->prev = proc->cur;
+	proc->cur = tmp;
+	if (shm_stats_read(st, proc->cur) < 0) {
+		proc->cur = proc->prev;
+		proc->prev = tmp;
+		proc->has_prev = 0;
+		return;
+	}
+
+	/* Previous one is of another process if it is restarted. */
+	proc->has_prev = proc->prev->magic == SHM_STATS_MAGIC &&
+		proc->prev->pid == proc->cur->pid;
+	proc->is_found = 1;
+}
+
+static void
+sample_eth_stats(void)
+{
+	struct metrics_eth *tmp;
+	uint16_t port_id;
+
+	tmp = eth_prev;
+	eth_prev = eth_cur;
+	eth_cur = tmp;
+	eth_prev_tsc = eth_cur_tsc;
+	eth_cur_tsc = rte_rdtsc();
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		eth_cur[port_id].is_valid =
+			rte_eth_dev_is_valid_port(port_id) &&
+			rte_eth_stats_get(port_id,
+					&eth_cur[port_id].stats) == 0;
+	}
+}
+
+static void
+print_proc_labels(struct metrics_buf *buf, const char *name,
+		const struct metrics_proc *proc)
+{
+	metrics_printf(buf, "%s{proc=\"%s\",client_id=\"%d\"", name,
+			proc->proc_name, proc->client_id);
+}
+
+static void
+print_port_metrics(struct metrics_buf *buf)
+{
+	const struct metric_def *def;
+	const struct metrics_proc *proc;
+	const struct shm_port_stats *port, *prev;
+	const char *type;
+	unsigned int i;
+	int j, k;
+
+	for (i = 0; i < RTE_DIM(port_metrics); i++) {
+		def = &port_metrics[i];
+		print_header(buf, def->name, def->help, def->rate_scale == 0);
+		for (j = 0; j < nof_metrics_procs; j++) {
+			proc = &metrics_procs[j];
+			if (!proc->is_found)
+				continue;
+			for (k = 0; k < (int)proc->cur->nof_ports; k++) {
+				port = &proc->cur->ports[k];
+				prev = proc->has_prev ?
+					find_prev_port(proc->prev, port) :
+					NULL;
+				type = get_port_type_name(port->port_type);
+				print_proc_labels(buf, def->name, proc);
+				metrics_printf(buf, ",port=\"%s:%d\"}", type,
+						port->port_id);
+				print_value(buf, def, &port->stats,
+						prev ? &prev->stats : NULL,
+						proc->cur->update_tsc -
+						proc->prev->update_tsc,
+						proc->cur->tsc_hz);
+			}
+		}
+	}
+}
+
+static void
+print_comp_metrics(struct metrics_buf *buf)
+{
+	const struct metric_def *def;
+	const struct metrics_proc *proc;
+	const struct shm_comp_stats *comp, *prev;
+	unsigned int i;
+	int j, k;
+
+	for (i = 0; i < RTE_DIM(comp_metrics); i++) {
+		def = &comp_metrics[i];
+		print_header(buf, def->name, def->help, def->rate_scale == 0);
+		for (j = 0; j < nof_metrics_procs; j++) {
+			proc = &metrics_procs[j];
+			if (!proc->is_found)
+				continue;
+			for (k = 0; k < (int)proc->cur->nof_comps; k++) {
+				comp = &proc->cur->comps[k];
+				prev = proc->has_prev ?
+					find_prev_comp(proc->prev,
+							comp->name) :
+					NULL;
+				print_proc_labels(buf, def->name, proc);
+				metrics_printf(buf,
+						",component=\"%s\",type=\"%s\""
+						",lcore=\"%u\"}",
+						comp->name, comp->type,
+						comp->lcore_id);
+				print_value(buf, def, &comp->stats,
+						prev ? &prev->stats : NULL,
+						proc->cur->update_tsc -
+						proc->prev->update_tsc,
+						proc->cur->tsc_hz);
+			}
+		}
+	}
+}
+
+/* Print ratio of polls received any packets on each of lcores. */
+static void
+print_lcore_metrics(struct metrics_buf *buf)
+{
+	const char *name = "spp_lcore_busy_ratio";
+	const struct metrics_proc *proc;
+	const struct shm_lcore_stats *lcore, *prev;
+	uint64_t polls, busy_polls;
+	double ratio;
+	int j, k;
+
+	print_header(buf, name,
+			"Ratio of polls received any packets in the interval.",
+			0);
+	for (j = 0; j < nof_metrics_procs; j++) {
+		proc = &metrics_procs[j];
+		if (!proc->is_found)
+			continue;
+		for (k = 0; k < (int)proc->cur->nof_lcores; k++) {
+			lcore = &proc->cur->lcores[k];
+			if (lcore->polls == 0)
+				continue;  /* Polls are not counted. */
+
+			ratio = 0;
+			prev = proc->has_prev ?
+				find_prev_lcore(proc->prev, lcore->lcore_id) :
+				NULL;
+			if (prev != NULL && lcore->polls > prev->polls &&
+					lcore->busy_polls >= prev->busy_polls) {
+				polls = lcore->polls - prev->polls;
+				busy_polls = lcore->busy_polls -
+					prev->busy_polls;
+				ratio = (double)busy_polls / polls;
+			}
+			print_proc_labels(buf, name, proc);
+			metrics_printf(buf, ",lcore=\"%u\"} %.3f\n",
+					lcore->lcore_id, ratio);
+		}
+	}
+}
+
+/* Print seconds passed from the last update, to find stopped processes. */
+static void
+print_age_metrics(struct metrics_buf *buf)
+{
+	const char *name = "spp_stats_age_seconds";
+	const struct metrics_proc *proc;
+	uint64_t now = rte_rdtsc();
+	int j;
+
+	print_header(buf, name, "Seconds passed from the last update.", 0);
+	for (j = 0; j < nof_metrics_procs; j++) {
+		proc = &metrics_procs[j];
+		if (!proc->is_found || proc->cur->tsc_hz == 0)
+			continue;
+		print_proc_labels(buf, name, proc);
+		metrics_printf(buf, "} %.3f\n",
+				(double)(now - proc->cur->update_tsc) /
+				proc->cur->tsc_hz);
+	}
+}
+
+static void
+print_eth_metrics(struct metrics_buf *buf)
+{
+	const struct metric_def *def;
+	char dev_name[RTE_DEV_NAME_MAX_LEN];
+	uint16_t port_id;
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(eth_metrics); i++) {
+		def = &eth_metrics[i];
+		print_header(buf, def->name, def->help, def->rate_scale == 0);
+		for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+			if (!eth_cur[port_id].is_valid)
+				continue;
+			if (rte_eth_dev_get_name_by_port(port_id,
+						dev_name) != 0)
+				dev_name[0] = '\0';
+			metrics_printf(buf,
+					"%s{ethdev=\"%u\",name=\"%s\"}",
+					def->name, port_id, dev_name);
+			print_value(buf, def, &eth_cur[port_id].stats,
+					eth_prev[port_id].is_valid ?
+					&eth_prev[port_id].stats : NULL,
+					eth_cur_tsc - eth_prev_tsc,
+					rte_get_tsc_hz());
+		}
+	}
+}
+
+/* Type of values of mempools printed with print_mempool(). */
+enum mempool_metric {
+	MEMPOOL_SIZE,
+	MEMPOOL_IN_USE,
+	MEMPOOL_OCCUPANCY,
+};
+
+struct mempool_walk_arg {
+	struct metrics_buf *buf;
+	const char *name;
+	enum mempool_metric type;
+};
+
+static void
+print_mempool(struct rte_mempool *mp, void *arg)
+{
+	struct mempool_walk_arg *walk_arg = arg;
+	unsigned int in_use = rte_mempool_in_use_count(mp);
+
+	metrics_printf(walk_arg->buf, "%s{mempool=\"%s\"}", walk_arg->name,
+			mp->name);
+	switch (walk_arg->type) {
+	case MEMPOOL_SIZE:
+		metrics_printf(walk_arg->buf, " %u\n", mp->size);
+		break;
+	case MEMPOOL_IN_USE:
+		metrics_printf(walk_arg->buf, " %u\n", in_use);
+		break;
+	case MEMPOOL_OCCUPANCY:
+		metrics_printf(walk_arg->buf, " %.3f\n",
+				mp->size ? (double)in_use / mp->size : 0);
+		break;
+	}
+}
+
+static void
+print_mempool_metrics(struct metrics_buf *buf)
+{
+	static const struct {
+		const char *name;
+		const char *help;
+		enum mempool_metric type;
+	} defs[] = {
+		{ "spp_mempool_size", "Num of mbufs in the pool.",
+			MEMPOOL_SIZE },
+		{ "spp_mempool_in_use", "Num of mbufs in use, or cached.",
+			MEMPOOL_IN_USE },
+		{ "spp_mempool_occupancy_ratio", "Ratio of mbufs in use.",
+			MEMPOOL_OCCUPANCY },
+	};
+	struct mempool_walk_arg walk_arg = { .buf = buf };
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(defs); i++) {
+		print_header(buf, defs[i].name, defs[i].help, 0);
+		walk_arg.name = defs[i].name;
+		walk_arg.type = defs[i].type;
+		rte_mempool_walk(print_mempool, &walk_arg);
+	}
+}
+
+/* Sample counters and format them to be served until the next sampling. */
+static void
+sample_metrics(void)
+{
+	int i;
+
+	for (i = 0; i < nof_metrics_procs; i++)
+		metrics_procs[i].is_found = 0;
+	shm_stats_walk(sample_proc, NULL);
+	sample_eth_stats();
+
+	metrics_out.len = 0;
+	metrics_out.str[0] = '\0';
+	print_port_metrics(&metrics_out);
+	print_comp_metrics(&metrics_out);
+	print_lcore_metrics(&metrics_out);
+	print_age_metrics(&metrics_out);
+	print_eth_metrics(&metrics_out);
+	print_mempool_metrics(&metrics_out);
+}
+
+static int
+send_all(int fd, const char *str, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = send(fd, str, len, MSG_NOSIGNAL);
+		if (ret <= 0)
+			return -1;
+		str += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+/* Accept a request and respond metrics, which is only for `GET`. */
+static void
+serve_metrics(void)
+{
+	char req[METRICS_REQ_SIZE];
+	char header[256];
+	struct timeval tv = { .tv_sec = METRICS_RECV_TIMEOUT_S };
+	const char *status = "200 OK";
+	const char *body = metrics_out.str;
+	size_t body_len = metrics_out.len;
+	ssize_t len;
+	int fd;
+
+	fd = accept(listen_fd, NULL, NULL);
+	if (fd < 0)
+		return;
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	len = recv(fd, req, sizeof(req) - 1, 0);
+	if (len <= 0) {
+		close(fd);
+		return;
+	}
+	req[len] = '\0';
+
+	if (strncmp(req, "GET ", 4) != 0) {
+		status = "405 Method Not Allowed";
+		body = "";
+		body_len = 0;
+	} else if (strncmp(req + 4, "/metrics", 8) != 0 &&
+			strncmp(req + 4, "/ ", 2) != 0) {
+		status = "404 Not Found";
+		body = "";
+		body_len = 0;
+	}
+
+	snprintf(header, sizeof(header),
+			"HTTP/1.0 %s\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: %zu\r\n"
+			"Connection: close\r\n\r\n", status, body_len);
+	if (send_all(fd, header, strlen(header)) == 0)
+		send_all(fd, body, body_len);
+	close(fd);
+}
+
+static void *
+metrics_thread(void *arg __rte_unused)
+{
+	struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+	uint64_t interval_tsc = rte_get_tsc_hz() * METRICS_INTERVAL_S;
+	uint64_t next_tsc = 0;
+	uint64_t now;
+	int timeout_ms;
+
+	while (1) {
+		now = rte_rdtsc();
+		if (now >= next_tsc) {
+			sample_metrics();
+			next_tsc = now + interval_tsc;
+		}
+
+		timeout_ms = (next_tsc - now) * MS_PER_S / rte_get_tsc_hz();
+		if (poll(&pfd, 1, timeout_ms + 1) > 0)
+			serve_metrics();
+	}
+	return NULL;
+}
+
+/* Create socket listening on `[IP:]PORT` or path of UNIX socket. */
+static int
+create_listen_socket(const char *addr)
+{
+	struct sockaddr_un un_addr = { .sun_family = AF_UNIX };
+	struct sockaddr_in in_addr = { .sin_family = AF_INET };
+	char ip[INET_ADDRSTRLEN] = METRICS_DEFAULT_IP;
+	const char *port_str = addr;
+	const char *sep;
+	char *end = NULL;
+	unsigned long port;
+	int on = 1;
+	int fd, ret;
+
+	if (strchr(addr, '/') != NULL) {
+		if (strlen(addr) >= sizeof(un_addr.sun_path)) {
+			RTE_LOG(ERR, PRIMARY, "Too long path '%s'\n", addr);
+			return -1;
+		}
+		strcpy(un_addr.sun_path, addr);
+		unlink(addr);
+
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+		ret = bind(fd, (struct sockaddr *)&un_addr, sizeof(un_addr));
+	} else {
+		sep = strrchr(addr, ':');
+		if (sep != NULL) {
+			if (sep - addr >= (int)sizeof(ip))
+				return -1;
+			memcpy(ip, addr, sep - addr);
+			ip[sep - addr] = '\0';
+			port_str = sep + 1;
+		}
+		port = strtoul(port_str, &end, 10);
+		ret = inet_pton(AF_INET, ip, &in_addr.sin_addr);
+		if (*port_str == '\0' || *end != '\0' || port == 0 ||
+				port > UINT16_MAX || ret != 1) {
+			RTE_LOG(ERR, PRIMARY, "Invalid address '%s'\n", addr);
+			return -1;
+		}
+		in_addr.sin_port = htons(port);
+
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		ret = bind(fd, (struct sockaddr *)&in_addr, sizeof(in_addr));
+	}
+
+	if (ret < 0 || listen(fd, METRICS_BACKLOG) < 0) {
+		RTE_LOG(ERR, PRIMARY, "Cannot listen on '%s'\n", addr);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int
+metrics_start(const char *addr)
+{
+	pthread_t tid;
+	int ret;
+
+	metrics_out.str = malloc(METRICS_BUF_INIT_SIZE);
+	if (metrics_out.str == NULL)
+		return -1;
+	metrics_out.size = METRICS_BUF_INIT_SIZE;
+	metrics_out.str[0] = '\0';
+
+	listen_fd = create_listen_socket(addr);
+	if (listen_fd < 0)
+		return -1;
+
+	ret = rte_ctrl_thread_create(&tid, "spp-metrics", NULL,
+			metrics_thread, NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, PRIMARY, "Cannot create metrics thread\n");
+		close(listen_fd);
+		listen_fd = -1;
+		return -1;
+	}
+	pthread_detach(tid);
+
+	RTE_LOG(INFO, PRIMARY, "Serve metrics on '%s'\n", addr);
+	return 0;
+}
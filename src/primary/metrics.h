@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_METRICS_H_
+#define _PRIMARY_METRICS_H_
+
+/**
+ * @file
+ * Exporter of metrics of SPP processes in Prometheus text format.
+ *
+ * Counters are sampled every METRICS_INTERVAL_S from stats segments of all
+ * of SPP processes, ethdev ports and mempools, and served with per-second
+ * rates over HTTP on a TCP port or a UNIX socket.
+ */
+
+/* Interval of sampling counters to calculate rates. */
+#define METRICS_INTERVAL_S 1
+
+/* Default address of TCP port if only the port number is given. */
+#define METRICS_DEFAULT_IP "127.0.0.1"
+
+/**
+ * Start exporter on a control thread.
+ *
+ * @param addr Address to listen on, `[IP:]PORT` for TCP or path of UNIX
+ *   socket which must include `/`, such as `/tmp/spp_metrics.sock`.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int metrics_start(const char *addr);
+
+#endif
@@ -3,65 +3,644 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#include <netinet/in.h>
+#include <rte_cycles.h>
+#include <rte_pause.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_hash_crc.h>
+#include <rte_malloc.h>
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
 #include "shared/port_manager.h"
 
-void
-forward(void)
+struct lcore_patch_list *lcore_patches[RTE_MAX_LCORE];
+
+static struct fwd_idle_conf idle_conf = {
+	.pause_polls = DEFAULT_IDLE_PAUSE_POLLS,
+	.yield_polls = DEFAULT_IDLE_YIELD_POLLS,
+	.sleep_us = 0,
+};
+
+/*
+ * State of each of forwarding lcores acknowledging `cmd` of the process. It
+ * is START before the lcore enters fwd_lcore_loop().
+ */
+static volatile enum cmd_type fwd_lcore_states[RTE_MAX_LCORE] = {
+	[0 ... RTE_MAX_LCORE - 1] = START,
+};
+
+/* Updated only from each of forwarding lcores. */
+static struct fwd_lcore_polls fwd_lcore_polls[RTE_MAX_LCORE];
+
+/* Send packets, and retry to send the rest until `retry_tsc` is passed. */
+static inline uint16_t
+tx_burst_retry(uint16_t (*tx_func)(uint16_t, uint16_t, struct rte_mbuf **,
+			uint16_t),
+		uint16_t port, uint16_t queue, struct rte_mbuf **bufs,
+		uint16_t nb_pkts, uint64_t retry_tsc)
 {
-	uint16_t nb_rx;
 	uint16_t nb_tx;
-	int in_port;
-	int out_port;
+	uint64_t start_tsc;
+
+	nb_tx = tx_func(port, queue, bufs, nb_pkts);
+	if (likely(nb_tx == nb_pkts) || retry_tsc == 0)
+		return nb_tx;
+
+	start_tsc = rte_rdtsc();
+	do {
+		rte_pause();
+		nb_tx += tx_func(port, queue, &bufs[nb_tx], nb_pkts - nb_tx);
+	} while (nb_tx < nb_pkts && rte_rdtsc() - start_tsc < retry_tsc);
+
+	return nb_tx;
+}
+
+/* Free packets which cannot be sent and count them for the TX policy. */
+static inline void
+drop_packets(struct stats *stats, enum tx_policy tx_policy,
+		struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
 	uint16_t buf;
-	int i, j;
-	uint16_t max_queue, in_queue, out_queue;
 
-	/* Go through every possible port numbers*/
-	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+	count_tx_drop(stats, tx_policy, nb_pkts);
+	for (buf = 0; buf < nb_pkts; buf++)
+		rte_pktmbuf_free(bufs[buf]);
+}
 
-		max_queue = get_port_max_queues(i);
+/*
+ * Send packets in TX buffer. Packets which cannot be sent are kept in the
+ * buffer for TX_POLICY_HOLD, or dropped for other policies.
+ */
+static inline void
+flush_tx_buffer(struct tx_buffer *tx_buf)
+{
+	uint16_t nb_tx;
+	uint16_t nb_rest;
 
-		/* Checks the number of rxq declared for the port */
-		for (j = 0; j < max_queue; j++) {
+	nb_tx = tx_burst_retry(tx_buf->tx_func, tx_buf->port, tx_buf->queue,
+			tx_buf->pkts, tx_buf->nof_pkts, tx_buf->retry_tsc);
+	tx_buf->stats->tx += nb_tx;
 
-			struct rte_mbuf *bufs[MAX_PKT_BURST];
+	nb_rest = tx_buf->nof_pkts - nb_tx;
+	if (likely(nb_rest == 0)) {
+		tx_buf->nof_pkts = 0;
+		return;
+	}
 
-			if (ports_fwd_array[i][j].in_port_id == PORT_RESET)
-				continue;
+	if (tx_buf->tx_policy == TX_POLICY_HOLD) {
+		if (nb_tx > 0)
+			memmove(tx_buf->pkts, &tx_buf->pkts[nb_tx],
+					sizeof(struct rte_mbuf *) * nb_rest);
+		tx_buf->nof_pkts = nb_rest;
+		return;
+	}
+
+	drop_packets(tx_buf->stats, tx_buf->tx_policy, &tx_buf->pkts[nb_tx],
+			nb_rest);
+	tx_buf->nof_pkts = 0;
+}
+
+/* Send packets in TX buffer, and drop held ones which cannot be sent. */
+static inline void
+close_tx_buffer(struct tx_buffer *tx_buf)
+{
+	flush_tx_buffer(tx_buf);
+	if (unlikely(tx_buf->nof_pkts > 0)) {
+		drop_packets(tx_buf->stats, tx_buf->tx_policy, tx_buf->pkts,
+				tx_buf->nof_pkts);
+		tx_buf->nof_pkts = 0;
+	}
+}
+
+/*
+ * Add packets to TX buffer and send them if the num of packets reaches
+ * `tx_burst` of the patch. If the buffer is full of held packets, rest of
+ * packets are dropped.
+ */
+static inline void
+push_packets(struct tx_buffer *tx_buf, struct fwd_patch *patch,
+		struct fwd_dst *dst, struct rte_mbuf **bufs,
+		uint16_t nb_pkts, uint64_t cur_tsc)
+{
+	uint16_t i;
+
+	/* Destination can be changed if the patch is updated. */
+	if (unlikely(tx_buf->nof_pkts > 0 &&
+			(tx_buf->port != dst->out_port ||
+			tx_buf->queue != dst->out_queue)))
+		close_tx_buffer(tx_buf);
+
+	if (tx_buf->nof_pkts == 0) {
+		tx_buf->port = dst->out_port;
+		tx_buf->queue = dst->out_queue;
+		tx_buf->tx_policy = dst->tx_policy;
+		tx_buf->retry_tsc = dst->retry_tsc;
+		tx_buf->tx_func = dst->tx_func;
+		tx_buf->stats = dst->tx_stats;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (unlikely(tx_buf->nof_pkts == MAX_PKT_BURST)) {
+			flush_tx_buffer(tx_buf);
+			if (tx_buf->nof_pkts == MAX_PKT_BURST) {
+				drop_packets(tx_buf->stats, tx_buf->tx_policy,
+						&bufs[i], nb_pkts - i);
+				return;
+			}
+		}
+
+		if (tx_buf->nof_pkts == 0)
+			tx_buf->prev_tsc = cur_tsc;
+		tx_buf->pkts[tx_buf->nof_pkts++] = bufs[i];
+		if (patch->tx_burst > 1 &&
+				tx_buf->nof_pkts >= patch->tx_burst)
+			flush_tx_buffer(tx_buf);
+	}
+}
+
+/*
+ * Send packets to a destination of the patch, or buffer them if TX buffer
+ * is enabled or held packets remain.
+ */
+static inline void
+send_packets(struct tx_buffer *tx_buf, struct fwd_patch *patch,
+		struct fwd_dst *dst, struct rte_mbuf **bufs,
+		uint16_t nb_pkts, uint64_t cur_tsc)
+{
+	uint16_t nb_tx = 0;
+
+	if (patch->tx_burst <= 1 && tx_buf->nof_pkts == 0) {
+		nb_tx = tx_burst_retry(dst->tx_func, dst->out_port,
+				dst->out_queue, bufs, nb_pkts, dst->retry_tsc);
+		dst->tx_stats->tx += nb_tx;
+		if (likely(nb_tx == nb_pkts))
+			return;
+
+		if (dst->tx_policy != TX_POLICY_HOLD) {
+			drop_packets(dst->tx_stats, dst->tx_policy,
+					&bufs[nb_tx], nb_pkts - nb_tx);
+			return;
+		}
+	}
+
+	/* Buffer packets, or hold ones not sent to send them later. */
+	push_packets(tx_buf, patch, dst, &bufs[nb_tx], nb_pkts - nb_tx,
+			cur_tsc);
+}
+
+/*
+ * Add references of packets for each of destinations of fan-out patch, so
+ * that a packet is freed after sent to all of them. Refcnt is updated for
+ * all of segments because rte_pktmbuf_free() decrements each of them.
+ */
+static inline void
+ref_fanout_packets(struct rte_mbuf **bufs, uint16_t nb_pkts,
+		uint16_t nof_dsts)
+{
+	uint16_t i;
+	struct rte_mbuf *seg;
+
+	for (i = 0; i < nb_pkts; i++) {
+		for (seg = bufs[i]; seg != NULL; seg = seg->next)
+			rte_mbuf_refcnt_update(seg, (int16_t)(nof_dsts - 1));
+	}
+}
+
+/* Initial value of software hash of flows. */
+#define FLOW_HASH_INIT 0xffffffff
+
+/*
+ * Get hash of the flow of a packet. RSS hash is used if it is given by NIC,
+ * or calculated from 5-tuple of IPv4 or IPv6 packet. Ports are not included
+ * for fragmented packets to keep them in the same flow. Other packets are
+ * hashed with MAC addresses.
+ */
+static inline uint32_t
+get_flow_hash(struct rte_mbuf *pkt)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_vlan_hdr *vlan;
+	struct rte_ipv4_hdr *ipv4;
+	struct rte_ipv6_hdr *ipv6;
+	uint16_t ether_type;
+	uint16_t len = rte_pktmbuf_data_len(pkt);
+	uint16_t l3_off = sizeof(struct rte_ether_hdr);
+	uint16_t l4_off;
+	uint8_t proto;
+	uint32_t hash;
+
+	if (pkt->ol_flags & PKT_RX_RSS_HASH)
+		return pkt->hash.rss;
+
+	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (unlikely(len < l3_off))
+		return 0;
+
+	ether_type = eth->ether_type;
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) &&
+			len >= l3_off + sizeof(struct rte_vlan_hdr)) {
+		vlan = (struct rte_vlan_hdr *)(eth + 1);
+		ether_type = vlan->eth_proto;
+		l3_off += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) &&
+			len >= l3_off + sizeof(struct rte_ipv4_hdr)) {
+		ipv4 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv4_hdr *,
+				l3_off);
+		hash = rte_hash_crc_4byte(ipv4->src_addr, FLOW_HASH_INIT);
+		hash = rte_hash_crc_4byte(ipv4->dst_addr, hash);
+		proto = ipv4->next_proto_id;
+		if (ipv4->fragment_offset & rte_cpu_to_be_16(
+				RTE_IPV4_HDR_MF_FLAG |
+				RTE_IPV4_HDR_OFFSET_MASK))
+			return rte_hash_crc_4byte(proto, hash);
+		l4_off = l3_off + (ipv4->version_ihl &
+				RTE_IPV4_HDR_IHL_MASK) *
+				RTE_IPV4_IHL_MULTIPLIER;
+	} else if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) &&
+			len >= l3_off + sizeof(struct rte_ipv6_hdr)) {
+		ipv6 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv6_hdr *,
+				l3_off);
+		hash = rte_hash_crc(ipv6->src_addr,
+				sizeof(ipv6->src_addr) +
+				sizeof(ipv6->dst_addr), FLOW_HASH_INIT);
+		proto = ipv6->proto;
+		l4_off = l3_off + sizeof(struct rte_ipv6_hdr);
+	} else {
+		return rte_hash_crc(eth, 2 * sizeof(struct rte_ether_addr),
+				FLOW_HASH_INIT);
+	}
+
+	hash = rte_hash_crc_4byte(proto, hash);
+
+	/* Source and destination ports are first 4 bytes of L4 header. */
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP ||
+			proto == IPPROTO_SCTP) && len >= l4_off + 4)
+		hash = rte_hash_crc_4byte(*rte_pktmbuf_mtod_offset(pkt,
+				uint32_t *, l4_off), hash);
+
+	return hash;
+}
+
+/*
+ * Distribute packets to destinations of the patch by hash of flows. The
+ * same destination is selected for packets of a flow as long as the
+ * destinations are not changed.
+ */
+static inline void
+distribute_packets(struct tx_buffer *tx_bufs, struct fwd_patch *patch,
+		struct rte_mbuf **bufs, uint16_t nb_pkts, uint64_t cur_tsc)
+{
+	struct rte_mbuf *dst_bufs[MAX_PATCH_DSTS][MAX_PKT_BURST];
+	uint16_t nb_dst_pkts[MAX_PATCH_DSTS] = { 0 };
+	uint16_t i, d;
+
+	for (i = 0; i < nb_pkts; i++) {
+		/* Map hash to [0, nof_dsts) without division. */
+		d = (uint16_t)(((uint64_t)get_flow_hash(bufs[i]) *
+				patch->nof_dsts) >> 32);
+		dst_bufs[d][nb_dst_pkts[d]++] = bufs[i];
+	}
+
+	for (d = 0; d < patch->nof_dsts; d++) {
+		if (nb_dst_pkts[d] > 0)
+			send_packets(&tx_bufs[d], patch, &patch->dsts[d],
+					dst_bufs[d], nb_dst_pkts[d], cur_tsc);
+	}
+}
+
+uint16_t
+forward(void)
+{
+	uint16_t nb_rx;
+	uint16_t nb_rx_total = 0;
+	uint16_t i, d;
+	uint64_t cur_tsc;
+	struct fwd_patch *patch;
+	struct tx_buffer *tx_buf;
+	struct lcore_patch_list *patch_list = lcore_patches[rte_lcore_id()];
+	struct lcore_patch_table *table =
+			&patch_list->tables[patch_list->ref_index];
+	uint16_t nof_patches = table->nof_patches;
+
+	cur_tsc = rte_rdtsc();
+
+	/* Go through active patches assigned to this lcore. */
+	for (i = 0; i < nof_patches; i++) {
+		struct rte_mbuf *bufs[MAX_PKT_BURST];
 
-			if (ports_fwd_array[i][j].out_port_id == PORT_RESET)
+		patch = &table->patches[i];
+
+		/*
+		 * Send held packets, or buffered packets if drain interval
+		 * is passed.
+		 */
+		for (d = 0; d < patch->nof_dsts; d++) {
+			tx_buf = &patch_list->tx_bufs[i][d];
+			if (likely(tx_buf->nof_pkts == 0))
 				continue;
+			if (patch->tx_burst <= 1 ||
+					cur_tsc - tx_buf->prev_tsc >
+					patch->drain_tsc)
+				flush_tx_buffer(tx_buf);
+		}
+
+		/* Get burst of RX packets, from first port of pair. */
+		nb_rx = patch->rx_func(patch->in_port, patch->in_queue,
+				bufs, MAX_PKT_BURST);
+		if (unlikely(nb_rx == 0))
+			continue;
+
+		patch->rx_stats->rx += nb_rx;
+		nb_rx_total += nb_rx;
+		if (i >= patch_list->nof_tx_bufs)
+			patch_list->nof_tx_bufs = i + 1;
+
+		/* Send burst of TX packets, to second port of pair. */
+		if (likely(patch->nof_dsts == 1)) {
+			send_packets(&patch_list->tx_bufs[i][0], patch,
+					&patch->dsts[0], bufs, nb_rx, cur_tsc);
+			continue;
+		}
+
+		if (patch->mode == PATCH_MODE_HASH) {
+			distribute_packets(patch_list->tx_bufs[i], patch,
+					bufs, nb_rx, cur_tsc);
+			continue;
+		}
+
+		/* Refcnt must be updated before sent to any destination. */
+		ref_fanout_packets(bufs, nb_rx, patch->nof_dsts);
+		for (d = 0; d < patch->nof_dsts; d++)
+			send_packets(&patch_list->tx_bufs[i][d], patch,
+					&patch->dsts[d], bufs, nb_rx, cur_tsc);
+	}
+
+	return nb_rx_total;
+}
+
+/* Send or drop all of packets remained in TX buffers of the lcore. */
+static void
+close_lcore_tx_bufs(struct lcore_patch_list *patch_list)
+{
+	uint16_t i, d;
+
+	for (i = 0; i < patch_list->nof_tx_bufs; i++) {
+		for (d = 0; d < MAX_PATCH_DSTS; d++) {
+			if (patch_list->tx_bufs[i][d].nof_pkts > 0)
+				close_tx_buffer(&patch_list->tx_bufs[i][d]);
+		}
+	}
+	patch_list->nof_tx_bufs = 0;
+}
+
+/*
+ * Switch to the table of patches updated from main thread if it is
+ * published. Packets buffered for destinations which are not in the same
+ * position of the new table are sent or dropped before switching, because
+ * the ports might be removed after the switch.
+ */
+static inline void
+change_patch_index(struct lcore_patch_list *patch_list)
+{
+	struct lcore_patch_table *table;
+	struct tx_buffer *tx_buf;
+	struct fwd_dst *dst;
+	uint16_t i, d;
 
-			/* if status active, i count is in port*/
-			in_port = i;
-			in_queue = j;
-			out_port = ports_fwd_array[i][j].out_port_id;
-			out_queue = ports_fwd_array[i][j].out_queue_id;
-
-			/* Get burst of RX packets, from first port of pair. */
-			/*first port rx, second port tx*/
-			nb_rx = ports_fwd_array[in_port][in_queue].rx_func(
-				in_port, in_queue, bufs, MAX_PKT_BURST);
-			if (unlikely(nb_rx == 0))
+	if (likely(patch_list->ref_index != patch_list->upd_index))
+		return;
+
+	table = &patch_list->tables[(patch_list->upd_index + 1) %
+			NOF_PATCH_TABLES];
+	for (i = 0; i < patch_list->nof_tx_bufs; i++) {
+		for (d = 0; d < MAX_PATCH_DSTS; d++) {
+			tx_buf = &patch_list->tx_bufs[i][d];
+			if (tx_buf->nof_pkts == 0)
 				continue;
 
-			port_map[in_port].stats->rx += nb_rx;
+			dst = &table->patches[i].dsts[d];
+			if (i >= table->nof_patches ||
+					d >= table->patches[i].nof_dsts ||
+					tx_buf->port != dst->out_port ||
+					tx_buf->queue != dst->out_queue)
+				close_tx_buffer(tx_buf);
+		}
+	}
+	if (patch_list->nof_tx_bufs > table->nof_patches)
+		patch_list->nof_tx_bufs = table->nof_patches;
+
+	patch_list->ref_index = (patch_list->upd_index + 1) %
+			NOF_PATCH_TABLES;
+}
+
+/* Idle according to the num of polls without any packets. */
+static inline void
+fwd_lcore_idle(unsigned int nof_empty_polls)
+{
+	if (idle_conf.yield_polls > 0 &&
+			nof_empty_polls >= idle_conf.yield_polls) {
+		if (idle_conf.sleep_us > 0)
+			usleep(idle_conf.sleep_us);
+		else
+			sched_yield();
+	} else if (idle_conf.pause_polls > 0 &&
+			nof_empty_polls >= idle_conf.pause_polls) {
+		rte_pause();
+	}
+}
+
+/**
+ * Parse idle policy of forwarding lcores. It is given as comma separated
+ * num of empty polls before pausing and yielding, and sleep time instead of
+ * yielding in micro sec. Omitted ones are left disabled as default.
+ *
+ *   --idle 64,1024,10
+ */
+int
+parse_idle_opt(const char *opt)
+{
+	unsigned int vals[3];
+	unsigned int nof_vals = 0;
+	unsigned long val;
+	const char *p = opt;
+	char *endp;
+
+	while (nof_vals < RTE_DIM(vals)) {
+		val = strtoul(p, &endp, 10);
+		if (endp == p || val > UINT32_MAX ||
+				(*endp != ',' && *endp != '\0')) {
+			RTE_LOG(ERR, SHARED, "Invalid idle policy '%s'\n",
+					opt);
+			return -1;
+		}
+		vals[nof_vals++] = (unsigned int)val;
+		if (*endp == '\0')
+			break;
+		p = endp + 1;
+	}
+	if (*endp != '\0') {
+		RTE_LOG(ERR, SHARED, "Invalid idle policy '%s'\n", opt);
+		return -1;
+	}
+
+	idle_conf.pause_polls = vals[0];
+	if (nof_vals > 1)
+		idle_conf.yield_polls = vals[1];
+	if (nof_vals > 2)
+		idle_conf.sleep_us = vals[2];
+
+	RTE_LOG(INFO, SHARED, "Idle policy, pause %u yield %u sleep %u us\n",
+			idle_conf.pause_polls, idle_conf.yield_polls,
+			idle_conf.sleep_us);
+	return 0;
+}
+
+/*
+ * Main loop of forwarding lcores. The lcore acknowledges a change of `*cmd`
+ * by updating its own state, and TX buffers are flushed when stopped. It
+ * checks `*cmd` every FWD_STOP_POLL_US while stopped, so that forwarding is
+ * started in sub milli sec.
+ */
+void
+fwd_lcore_loop(volatile enum cmd_type *cmd)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	unsigned int nof_empty_polls = 0;
+	struct fwd_lcore_polls *polls = &fwd_lcore_polls[lcore_id];
+	enum cmd_type cur_cmd;
 
-			/* Send burst of TX packets, to second port of pair. */
-			nb_tx = ports_fwd_array[out_port][out_queue].tx_func(
-				out_port, out_queue, bufs, nb_rx);
+	fwd_lcore_states[lcore_id] = STOP;
 
-			port_map[out_port].stats->tx += nb_tx;
+	while (1) {
+		change_patch_index(lcore_patches[lcore_id]);
 
-			/* Free any unsent packets. */
-			if (unlikely(nb_tx < nb_rx)) {
-				port_map[out_port].stats->tx_drop += (nb_rx -
-					nb_tx);
-				for (buf = nb_tx; buf < nb_rx; buf++)
-					rte_pktmbuf_free(bufs[buf]);
+		cur_cmd = *cmd;
+		if (unlikely(cur_cmd != fwd_lcore_states[lcore_id])) {
+			if (cur_cmd != FORWARD)
+				close_lcore_tx_bufs(lcore_patches[lcore_id]);
+			nof_empty_polls = 0;
+			rte_smp_wmb();
+			fwd_lcore_states[lcore_id] = cur_cmd;
+		}
+
+		if (unlikely(cur_cmd != FORWARD)) {
+			usleep(FWD_STOP_POLL_US);
+			continue;
+		}
+
+		polls->polls++;
+		if (forward() > 0) {
+			polls->busy_polls++;
+			nof_empty_polls = 0;
+			continue;
+		}
+
+		if (nof_empty_polls < UINT32_MAX)
+			nof_empty_polls++;
+		fwd_lcore_idle(nof_empty_polls);
+	}
+}
+
+/*
+ * Wait for all of forwarding lcores which have entered fwd_lcore_loop() to
+ * acknowledge given state. Return -1 if it is timed out.
+ */
+int
+wait_fwd_lcores(enum cmd_type state)
+{
+	unsigned int lcore_id;
+	uint64_t start_tsc = rte_rdtsc();
+	const uint64_t timeout_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
+			US_PER_S * FWD_ACK_TIMEOUT_US;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		while (fwd_lcore_states[lcore_id] != START &&
+				fwd_lcore_states[lcore_id] != state) {
+			if (rte_rdtsc() - start_tsc > timeout_tsc) {
+				RTE_LOG(ERR, SHARED,
+					"lcore %u does not acknowledge "
+					"state %d\n", lcore_id, state);
+				return -1;
 			}
+			rte_pause();
 		}
 	}
+
+	return 0;
+}
+
+/*
+ * Allocate patches of each of slave lcores on its socket, because they are
+ * referred from the lcore on every poll.
+ */
+int
+init_lcore_patches(void)
+{
+	unsigned int lcore_id;
+	struct lcore_patch_list *patch_list;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (lcore_patches[lcore_id] != NULL)
+			continue;
+
+		patch_list = rte_zmalloc_socket("lcore_patches",
+				sizeof(*patch_list), RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+		if (patch_list == NULL) {
+			RTE_LOG(ERR, SHARED,
+				"Cannot allocate patches of lcore %u\n",
+				lcore_id);
+			return -1;
+		}
+		patch_list->ref_index = 0;
+		patch_list->upd_index = 1;
+		lcore_patches[lcore_id] = patch_list;
+	}
+
+	return 0;
+}
+
+/* Get the table of patches of given lcore to be updated. */
+struct lcore_patch_table *
+get_upd_patch_table(unsigned int lcore_id)
+{
+	struct lcore_patch_list *patch_list = lcore_patches[lcore_id];
+
+	return &patch_list->tables[patch_list->upd_index];
+}
+
+/*
+ * Publish the updated table of patches to given lcore, and wait for the lcore
+ * to refer it. After returned, the lcore does not refer the previous table
+ * and packets buffered for removed destinations are already sent. If the
+ * lcore is not forwarding, the table is switched here.
+ */
+void
+publish_patch_table(unsigned int lcore_id)
+{
+	struct lcore_patch_list *patch_list = lcore_patches[lcore_id];
+
+	rte_smp_wmb();
+	patch_list->upd_index = patch_list->ref_index;
+
+	if (fwd_lcore_states[lcore_id] == START) {
+		patch_list->ref_index = (patch_list->upd_index + 1) %
+				NOF_PATCH_TABLES;
+		return;
+	}
+
+	while (likely(patch_list->ref_index == patch_list->upd_index))
+		rte_pause();
+}
+
+const struct fwd_lcore_polls *
+get_fwd_lcore_polls(unsigned int lcore_id)
+{
+	return &fwd_lcore_polls[lcore_id];
 }
@@ -7,9 +7,139 @@
 
 #include "shared/common.h"
 
+/* Max num of patches forwarded on one lcore. */
+#define MAX_PATCHES_PER_LCORE 128
+
+/* Default interval of flushing TX buffer of a patch. */
+#define DEFAULT_DRAIN_US 100  /* micro sec */
+
+/*
+ * Default num of empty polls before forwarding lcore starts to idle. Both
+ * are 0 for busy polling, and idling is enabled with `--idle` option.
+ */
+#define DEFAULT_IDLE_PAUSE_POLLS 0
+#define DEFAULT_IDLE_YIELD_POLLS 0
+
+/* Interval of checking command of forwarding lcore while stopped. */
+#define FWD_STOP_POLL_US 100  /* micro sec */
+
+/* Time to wait for forwarding lcores to acknowledge command. */
+#define FWD_ACK_TIMEOUT_US 100000  /* micro sec */
+
+/*
+ * Idle policy of forwarding lcores. An lcore calls rte_pause() after
+ * `pause_polls` polls without any packets, and yields CPU after
+ * `yield_polls`, or sleeps `sleep_us` if it is not 0. Each of them is
+ * disabled if it is 0.
+ */
+struct fwd_idle_conf {
+	unsigned int pause_polls;
+	unsigned int yield_polls;
+	unsigned int sleep_us;
+};
+
+/* Destination of an active patch. */
+struct fwd_dst {
+	uint16_t out_port;
+	uint16_t out_queue;
+	uint16_t (*tx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
+	struct stats *tx_stats;  /* Counters of out_port for the lcore. */
+	enum tx_policy tx_policy;  /* TX policy of out_port. */
+	uint64_t retry_tsc;  /* Budget of retrying TX in TSC. */
+};
+
+/*
+ * Active patch resolved from ports_fwd_array to be referred in forward().
+ * Packets are sent to all of `dsts` without copying if it is a fan-out
+ * patch, which has more than one destinations, or distributed to one of
+ * them by hash of the flow if `mode` is PATCH_MODE_HASH.
+ */
+struct fwd_patch {
+	uint16_t in_port;
+	uint16_t in_queue;
+	uint16_t (*rx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
+	struct stats *rx_stats;  /* Counters of in_port for the lcore. */
+	uint16_t tx_burst;  /* Num of pkts buffered, or 0 for no buffering. */
+	uint64_t drain_tsc;  /* Interval of flushing TX buffer in TSC. */
+	enum patch_mode mode;
+	uint16_t nof_dsts;
+	struct fwd_dst dsts[MAX_PATCH_DSTS];
+};
+
+/*
+ * Buffer of packets to be sent in a burst, or held for TX_POLICY_HOLD.
+ * It is owned by an lcore, and destination is kept in it to be flushed
+ * even if the patch is changed.
+ */
+struct tx_buffer {
+	uint16_t port;
+	uint16_t queue;
+	uint16_t nof_pkts;
+	enum tx_policy tx_policy;
+	uint64_t retry_tsc;
+	uint16_t (*tx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
+	struct stats *stats;
+	uint64_t prev_tsc;  /* TSC of buffering the first packet. */
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+};
+
+/* Num of tables of patches of an lcore, referred one and updated one. */
+#define NOF_PATCH_TABLES 2
+
+/* Dense list of active patches assigned to an lcore. */
+struct lcore_patch_table {
+	uint16_t nof_patches;
+	struct fwd_patch patches[MAX_PATCHES_PER_LCORE];
+};
+
+/*
+ * Patches of an lcore are double buffered, same as `ref_index` and
+ * `upd_index` of spp_vf, so that they can be updated while forwarding. The
+ * main thread fills `tables[upd_index]` and sets `upd_index` to `ref_index`,
+ * then the lcore switches `ref_index` to the updated table between polls.
+ */
+struct lcore_patch_list {
+	volatile int ref_index;  /* Index of table referred from the lcore. */
+	volatile int upd_index;  /* Index of table updated from main thread. */
+	struct lcore_patch_table tables[NOF_PATCH_TABLES];
+	/* Updated only from the lcore, indexed same as patches and dsts. */
+	uint16_t nof_tx_bufs;
+	struct tx_buffer tx_bufs[MAX_PATCHES_PER_LCORE][MAX_PATCH_DSTS];
+} __rte_cache_aligned;
+
 struct port_map port_map[RTE_MAX_ETHPORTS];
 struct port ports_fwd_array[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
-void forward(void);
+/* Patches of each of forwarding lcores, allocated on socket of the lcore. */
+extern struct lcore_patch_list *lcore_patches[RTE_MAX_LCORE];
+
+/* Allocate patches of forwarding lcores. Return -1 if failed. */
+int init_lcore_patches(void);
+
+/* Forward packets of patches of the lcore, and return num of RX packets. */
+uint16_t forward(void);
+
+/* Parse idle policy given as `PAUSE_POLLS[,YIELD_POLLS[,SLEEP_US]]`. */
+int parse_idle_opt(const char *opt);
+
+/* Forward packets while `*cmd` is FORWARD, or wait for it. Never returns. */
+void fwd_lcore_loop(volatile enum cmd_type *cmd);
+
+/* Wait for forwarding lcores to enter given state, or timeout. */
+int wait_fwd_lcores(enum cmd_type state);
+
+/* Get the table of patches of given lcore to be updated. */
+struct lcore_patch_table *get_upd_patch_table(unsigned int lcore_id);
+
+/* Publish the updated table to given lcore and wait for it to be referred. */
+void publish_patch_table(unsigned int lcore_id);
+
+/* Num of polls of a forwarding lcore to know how busy it is. */
+struct fwd_lcore_polls {
+	uint64_t polls;  /* Polls while forwarding. */
+	uint64_t busy_polls;  /* Polls received any packets. */
+} __rte_cache_aligned;
+
+const struct fwd_lcore_polls *get_fwd_lcore_polls(unsigned int lcore_id);
 
 #endif
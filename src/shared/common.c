@@ -8,6 +8,36 @@
 
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
+/* TX policy of a port given with `--tx-policy` option. */
+struct tx_policy_entry {
+	enum port_type port_type;
+	int port_id;
+	struct tx_policy_conf conf;
+};
+
+static const char * const tx_policy_names[] = {
+	"drop",  /* TX_POLICY_DROP */
+	"retry",  /* TX_POLICY_RETRY */
+	"hold",  /* TX_POLICY_HOLD */
+};
+
+static const struct {
+	const char *name;
+	enum port_type port_type;
+} tx_policy_port_types[] = {
+	{ "phy", PHY },
+	{ "ring", RING },
+	{ "vhost", VHOST },
+	{ "pcap", PCAP },
+	{ "nullpmd", NULLPMD },
+	{ "tap", TAP },
+	{ "memif", MEMIF },
+};
+
+static struct tx_policy_conf default_tx_conf = { TX_POLICY_DROP, 0 };
+static struct tx_policy_entry tx_policy_entries[RTE_MAX_ETHPORTS];
+static int nof_tx_policy_entries;
+
 /**
  * Set log level of type RTE_LOGTYPE_USER* to given level, for instance,
  * RTE_LOG_INFO or RTE_LOG_DEBUG.
@@ -65,6 +95,70 @@ parse_server(char **server_ip, int *server_port, char *server_addr)
 	return 0;
 }
 
+/* Sum up counters of `port_stats[idx]` of all of lcores. */
+void
+sum_port_stats(const struct port_info *info, uint16_t idx,
+		struct stats *sum)
+{
+	unsigned int lcore_id;
+
+	memset(sum, 0, sizeof(*sum));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		add_stats(sum, &info->lcore_stats[lcore_id].port_stats[idx]);
+}
+
+/* Sum up counters of `client_stats[idx]` of all of lcores. */
+void
+sum_client_stats(const struct port_info *info, uint16_t idx,
+		struct stats *sum)
+{
+	unsigned int lcore_id;
+
+	memset(sum, 0, sizeof(*sum));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		add_stats(sum, &info->lcore_stats[lcore_id].client_stats[idx]);
+}
+
+/* Clear counters of all of lcores. */
+void
+clear_lcore_stats(struct port_info *info)
+{
+	memset(info->lcore_stats, 0, sizeof(info->lcore_stats));
+}
+
+/*
+ * Look up mbuf pool of given socket, or of a remote socket if it does not
+ * exist. Socket of the calling lcore is used if `socket_id` is invalid.
+ */
+struct rte_mempool *
+get_pktmbuf_pool(int socket_id)
+{
+	struct rte_mempool *mp;
+	unsigned int i;
+
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES)
+		socket_id = rte_socket_id();
+
+	mp = rte_mempool_lookup(get_pktmbuf_pool_name(socket_id));
+	if (mp != NULL)
+		return mp;
+
+	/* No port or lcore of primary on the socket, use remote one. */
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		if ((int)i == socket_id)
+			continue;
+		mp = rte_mempool_lookup(get_pktmbuf_pool_name(i));
+		if (mp != NULL) {
+			RTE_LOG(DEBUG, SHARED,
+				"No mbuf pool on socket %d, use socket %u.\n",
+				socket_id, i);
+			return mp;
+		}
+	}
+
+	return NULL;
+}
+
 /**
  * Get port type and port ID from ethdev name, such as `eth_vhost1` which
  * can be retrieved with rte_eth_dev_get_name_by_port().
@@ -147,3 +241,132 @@ int parse_dev_name(char *dev_name, int *port_type, int *port_id)
 
 	return 0;
 }
+
+/* Parse policy such as `retry:20` and set it to `conf`. */
+static int
+parse_tx_policy_conf(const char *str, struct tx_policy_conf *conf)
+{
+	char *endp;
+	unsigned long retry_us;
+	size_t len = strlen(tx_policy_names[TX_POLICY_RETRY]);
+
+	if (!strcmp(str, tx_policy_names[TX_POLICY_DROP])) {
+		conf->policy = TX_POLICY_DROP;
+		conf->retry_us = 0;
+		return 0;
+	}
+
+	if (!strcmp(str, tx_policy_names[TX_POLICY_HOLD])) {
+		conf->policy = TX_POLICY_HOLD;
+		conf->retry_us = 0;
+		return 0;
+	}
+
+	if (strncmp(str, tx_policy_names[TX_POLICY_RETRY], len))
+		return -1;
+
+	conf->policy = TX_POLICY_RETRY;
+	conf->retry_us = DEFAULT_TX_RETRY_US;
+	if (str[len] == '\0')
+		return 0;
+	if (str[len] != ':' || str[len + 1] == '\0')
+		return -1;
+
+	retry_us = strtoul(&str[len + 1], &endp, 10);
+	if (*endp || retry_us > UINT32_MAX)
+		return -1;
+	conf->retry_us = (unsigned int)retry_us;
+
+	return 0;
+}
+
+/* Parse port such as `ring:0` for `--tx-policy` option. */
+static int
+parse_tx_policy_port(const char *str, struct tx_policy_entry *entry)
+{
+	unsigned int i;
+	size_t len;
+	char *endp;
+
+	for (i = 0; i < RTE_DIM(tx_policy_port_types); i++) {
+		len = strlen(tx_policy_port_types[i].name);
+		if (strncmp(str, tx_policy_port_types[i].name, len) ||
+				str[len] != ':')
+			continue;
+
+		entry->port_type = tx_policy_port_types[i].port_type;
+		entry->port_id = (int)strtol(&str[len + 1], &endp, 10);
+		if (str[len + 1] == '\0' || *endp || entry->port_id < 0)
+			return -1;
+		return 0;
+	}
+
+	return -1;
+}
+
+int
+parse_tx_policy_opt(const char *opt)
+{
+	char buf[256];
+	char *saveptr = NULL;
+	char *token, *policy;
+	struct tx_policy_entry *entry;
+
+	if (strlen(opt) >= sizeof(buf)) {
+		RTE_LOG(ERR, SHARED, "Too long TX policy '%s'\n", opt);
+		return -1;
+	}
+	strcpy(buf, opt);
+
+	for (token = strtok_r(buf, ",", &saveptr); token != NULL;
+			token = strtok_r(NULL, ",", &saveptr)) {
+		policy = strchr(token, '=');
+		if (policy == NULL) {
+			if (parse_tx_policy_conf(token, &default_tx_conf) < 0)
+				goto invalid;
+			continue;
+		}
+
+		if (nof_tx_policy_entries >= RTE_MAX_ETHPORTS) {
+			RTE_LOG(ERR, SHARED, "Too many ports of TX policy\n");
+			return -1;
+		}
+
+		*policy++ = '\0';
+		entry = &tx_policy_entries[nof_tx_policy_entries];
+		if (parse_tx_policy_port(token, entry) < 0 ||
+				parse_tx_policy_conf(policy, &entry->conf) < 0)
+			goto invalid;
+		nof_tx_policy_entries++;
+	}
+
+	return 0;
+
+invalid:
+	RTE_LOG(ERR, SHARED, "Invalid TX policy '%s'\n", opt);
+	return -1;
+}
+
+void
+get_tx_policy(enum port_type port_type, int port_id,
+		struct tx_policy_conf *conf)
+{
+	int i;
+
+	/* Search from the last one to give priority to later option. */
+	for (i = nof_tx_policy_entries - 1; i >= 0; i--) {
+		if (tx_policy_entries[i].port_type == port_type &&
+				tx_policy_entries[i].port_id == port_id) {
+			*conf = tx_policy_entries[i].conf;
+			return;
+		}
+	}
+
+	*conf = default_tx_conf;
+}
+
+const char *
+tx_policy_str(enum tx_policy policy)
+{
+	return tx_policy_names[policy];
+}
@@ -79,11 +79,18 @@ enum cmd_type {
  * different cache lines for each client to use.
  */
 
+/*
+ * `tx_drop` is the total num of packets dropped in TX, and `tx_retry_drop`
+ * and `tx_hold_drop` are the num of them dropped after retried with
+ * TX_POLICY_RETRY or held with TX_POLICY_HOLD.
+ */
 struct stats {
 	uint64_t rx;
 	uint64_t rx_drop;
 	uint64_t tx;
 	uint64_t tx_drop;
+	uint64_t tx_retry_drop;
+	uint64_t tx_hold_drop;
 } __rte_cache_aligned;
 
 /* rx_queue and tx_queue set to port. */
@@ -92,11 +99,20 @@ struct port_queue {
 	uint16_t txq;
 };
 
+/*
+ * Counters of ports updated only from one lcore. It is to avoid false
+ * sharing and lost updates among lcores forwarding the same port. Actual
+ * value of a counter is a sum of all of lcores.
+ */
+struct lcore_port_stats {
+	struct stats port_stats[RTE_MAX_ETHPORTS];
+	struct stats client_stats[MAX_CLIENT];
+};
+
 struct port_info {
 	uint16_t num_ports;
 	uint16_t id[RTE_MAX_ETHPORTS];
-	struct stats port_stats[RTE_MAX_ETHPORTS];
-	struct stats client_stats[MAX_CLIENT];
+	struct lcore_port_stats lcore_stats[RTE_MAX_LCORE];
 	/* num of queues per port */
 	struct port_queue queue_info[RTE_MAX_ETHPORTS];
 };
@@ -112,27 +128,71 @@ enum port_type {
 	UNDEF,
 };
 
+/* Policy for packets which are not accepted by TX queue. */
+enum tx_policy {
+	TX_POLICY_DROP,  /* Drop them immediately. */
+	TX_POLICY_RETRY,  /* Retry to send them until `retry_us` is passed. */
+	TX_POLICY_HOLD,  /* Hold them and retry to send on the next poll. */
+};
+
+/* Default budget of retrying TX for TX_POLICY_RETRY. */
+#define DEFAULT_TX_RETRY_US 10  /* micro sec */
+
+struct tx_policy_conf {
+	enum tx_policy policy;
+	unsigned int retry_us;  /* Only for TX_POLICY_RETRY. */
+};
+
+/* Type of counters of a port in struct lcore_port_stats. */
+enum stats_type {
+	STATS_NONE,  /* Not shared with other processes. */
+	STATS_PORT,  /* Counted in port_stats. */
+	STATS_CLIENT,  /* Counted in client_stats. */
+};
+
 struct port_map {
 	int id;
 	enum port_type port_type;
-	struct stats *stats;
-	struct stats default_stats;
+	enum stats_type stats_type;
+	int stats_idx;  /* Index of port_stats or client_stats. */
+	struct tx_policy_conf tx_conf;
 	/* num of queues per port */
 	struct port_queue *queue_info;
 };
 
+/* Max num of destinations of a patch, including fan-out ones. */
+#define MAX_PATCH_DSTS 4
+
+/* How packets are sent to destinations of a fan-out patch. */
+enum patch_mode {
+	PATCH_MODE_COPY,  /* Send all of packets to each of destinations. */
+	PATCH_MODE_HASH,  /* Send packets of a flow to one of destinations. */
+};
+
+/* Destination of a fan-out patch other than the first one. */
+struct fanout_dst {
+	uint16_t port_id;
+	uint16_t queue_id;
+};
+
 struct port {
 	uint16_t in_port_id;
 	uint16_t in_queue_id;
 	uint16_t out_port_id;
 	uint16_t out_queue_id;
+	uint16_t nof_fanout;  /* Num of destinations other than out_port_id. */
+	struct fanout_dst fanout[MAX_PATCH_DSTS - 1];
+	enum patch_mode mode;
+	unsigned int lcore_id;  /* lcore forwarding this patch. */
+	uint16_t tx_burst;  /* Num of pkts buffered, or 0 for no buffering. */
+	unsigned int drain_us;  /* Interval of flushing TX buffer. */
 	uint16_t (*rx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
 	uint16_t (*tx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
 };
 
 /* define common names for structures shared between server and client */
 #define MP_CLIENT_RXQ_NAME "eth_ring%u"
-#define PKTMBUF_POOL_NAME "MProc_pktmbuf_pool"
+#define PKTMBUF_POOL_NAME "MProc_pktmbuf_pool_%u"
 #define MZ_PORT_INFO "MProc_port_info"
 
 /*
@@ -151,6 +211,26 @@ get_rx_queue_name(unsigned int id)
 	return buffer;
 }
 
+/*
+ * Given the mbuf pool name template above, get the name of pool on socket
+ */
+static inline const char *
+get_pktmbuf_pool_name(unsigned int socket_id)
+{
+	/* %u is replaced by maximum 3 digits of socket ID. */
+	static char buffer[sizeof(PKTMBUF_POOL_NAME) + 2];
+
+	snprintf(buffer, sizeof(buffer) - 1, PKTMBUF_POOL_NAME, socket_id);
+	return buffer;
+}
+
+/*
+ * Get mbuf pool of given socket created by spp_primary, or pool of any other
+ * socket if no pool on it. Socket of caller is used if `socket_id` is
+ * negative, such as SOCKET_ID_ANY returned for virtual devices.
+ */
+struct rte_mempool *get_pktmbuf_pool(int socket_id);
+
 /* Set log level of type RTE_LOGTYPE_USER* to given level. */
 int set_user_log_level(int num_user_log, uint32_t log_level);
 
@@ -159,6 +239,55 @@ int set_user_log_debug(int num_user_log);
 
 int parse_server(char **server_ip, int *server_port, char *server_addr);
 
+/* Add counters of `st` to `sum`. */
+static inline void
+add_stats(struct stats *sum, const struct stats *st)
+{
+	sum->rx += st->rx;
+	sum->rx_drop += st->rx_drop;
+	sum->tx += st->tx;
+	sum->tx_drop += st->tx_drop;
+	sum->tx_retry_drop += st->tx_retry_drop;
+	sum->tx_hold_drop += st->tx_hold_drop;
+}
+
+/* Count packets dropped in TX for the TX policy of the port. */
+static inline void
+count_tx_drop(struct stats *st, enum tx_policy policy, uint64_t nb_pkts)
+{
+	st->tx_drop += nb_pkts;
+	if (policy == TX_POLICY_RETRY)
+		st->tx_retry_drop += nb_pkts;
+	else if (policy == TX_POLICY_HOLD)
+		st->tx_hold_drop += nb_pkts;
+}
+
+/* Sum up counters of `port_stats[idx]` of all of lcores. */
+void sum_port_stats(const struct port_info *info, uint16_t idx,
+		struct stats *sum);
+
+/* Sum up counters of `client_stats[idx]` of all of lcores. */
+void sum_client_stats(const struct port_info *info, uint16_t idx,
+		struct stats *sum);
+
+/* Clear counters of all of lcores. */
+void clear_lcore_stats(struct port_info *info);
+
+/**
+ * Parse TX policies given as `--tx-policy` option of secondary processes.
+ * It is a comma separated list of policy of all of ports and ones of each
+ * of ports, for example, `retry:20,ring:0=hold,vhost:1=drop`. Policy is
+ * one of `drop`, `retry[:US]` or `hold`.
+ */
+int parse_tx_policy_opt(const char *opt);
+
+/* Get TX policy of given port configured with parse_tx_policy_opt(). */
+void get_tx_policy(enum port_type port_type, int port_id,
+		struct tx_policy_conf *conf);
+
+/* Get name of TX policy, such as `drop`. */
+const char *tx_policy_str(enum tx_policy policy);
+
 extern uint8_t lcore_id_used[RTE_MAX_LCORE];
 
 /**
@@ -0,0 +1,284 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <rte_branch_prediction.h>
+#include <rte_log.h>
+#include "shared/json_writer.h"
+
+#define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
+
+void
+jw_init(struct json_writer *jw)
+{
+	memset(jw, 0, sizeof(*jw));
+}
+
+void
+jw_free(struct json_writer *jw)
+{
+	free(jw->str);
+	jw_init(jw);
+}
+
+void
+jw_reset(struct json_writer *jw)
+{
+	jw->len = 0;
+	jw->depth = 0;
+	jw->has_member[0] = 0;
+	jw->err = 0;
+	if (jw->str != NULL)
+		jw->str[0] = '\0';
+}
+
+/* Make room for `len` bytes and '\0' at the end of message. */
+static int
+jw_reserve(struct json_writer *jw, size_t len)
+{
+	size_t new_size;
+	char *new_str;
+
+	if (unlikely(jw->err))
+		return -1;
+	if (likely(jw->len + len < jw->size))
+		return 0;
+
+	new_size = jw->size ? jw->size : JW_INIT_SIZE;
+	while (new_size <= jw->len + len)
+		new_size *= 2;
+
+	new_str = realloc(jw->str, new_size);
+	if (unlikely(new_str == NULL)) {
+		RTE_LOG(ERR, SHARED, "Cannot extend JSON message to %zu\n",
+				new_size);
+		jw->err = 1;
+		return -1;
+	}
+	jw->str = new_str;
+	jw->size = new_size;
+	return 0;
+}
+
+static void
+jw_append(struct json_writer *jw, const char *str, size_t len)
+{
+	if (jw_reserve(jw, len) < 0)
+		return;
+	memcpy(jw->str + jw->len, str, len);
+	jw->len += len;
+	jw->str[jw->len] = '\0';
+}
+
+static void
+jw_vappendf(struct json_writer *jw, const char *format, va_list ap)
+{
+	va_list ap_retry;
+	int len;
+
+	if (jw_reserve(jw, 0) < 0)
+		return;
+
+	va_copy(ap_retry, ap);
+	len = vsnprintf(jw->str + jw->len, jw->size - jw->len, format, ap);
+	if (unlikely(len < 0)) {
+		jw->str[jw->len] = '\0';
+		jw->err = 1;
+	} else if ((size_t)len >= jw->size - jw->len) {
+		/* Too short, retry after extended. */
+		if (jw_reserve(jw, len) == 0)
+			vsnprintf(jw->str + jw->len, len + 1, format,
+					ap_retry);
+	}
+	va_end(ap_retry);
+
+	if (likely(jw->err == 0))
+		jw->len += len;
+	else
+		jw->str[jw->len] = '\0';
+}
+
+static void
+jw_appendf(struct json_writer *jw, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+static void
+jw_appendf(struct json_writer *jw, const char *format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	jw_vappendf(jw, format, ap);
+	va_end(ap);
+}
+
+/* Append string quoted and escaped. */
+static void
+jw_append_escaped(struct json_writer *jw, const char *str, size_t len)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *p, *end = str + len;
+	char esc[6] = { '\\', 'u', '0', '0', 0, 0 };
+
+	jw_append(jw, "\"", 1);
+	while (str < end) {
+		/* Append characters not to be escaped at once. */
+		for (p = str; p < end; p++) {
+			if (*p == '"' || *p == '\\' ||
+					(unsigned char)*p < 0x20)
+				break;
+		}
+		jw_append(jw, str, p - str);
+		if (p == end)
+			break;
+
+		switch (*p) {
+		case '"':
+			jw_append(jw, "\\\"", 2);
+			break;
+		case '\\':
+			jw_append(jw, "\\\\", 2);
+			break;
+		case '\n':
+			jw_append(jw, "\\n", 2);
+			break;
+		case '\t':
+			jw_append(jw, "\\t", 2);
+			break;
+		default:
+			esc[4] = hex[(unsigned char)*p >> 4];
+			esc[5] = hex[(unsigned char)*p & 0xf];
+			jw_append(jw, esc, sizeof(esc));
+			break;
+		}
+		str = p + 1;
+	}
+	jw_append(jw, "\"", 1);
+}
+
+/* Append comma if needed and key of the member. */
+static void
+jw_key(struct json_writer *jw, const char *key)
+{
+	if (jw->has_member[jw->depth])
+		jw_append(jw, ",", 1);
+	jw->has_member[jw->depth] = 1;
+
+	if (key != NULL) {
+		jw_append_escaped(jw, key, strlen(key));
+		jw_append(jw, ":", 1);
+	}
+}
+
+static void
+jw_begin(struct json_writer *jw, const char *key, char bracket)
+{
+	jw_key(jw, key);
+	if (unlikely(jw->depth >= JW_MAX_DEPTH)) {
+		RTE_LOG(ERR, SHARED, "Too deep JSON message\n");
+		jw->err = 1;
+		return;
+	}
+	jw_append(jw, &bracket, 1);
+	jw->has_member[++jw->depth] = 0;
+}
+
+static void
+jw_end(struct json_writer *jw, char bracket)
+{
+	if (jw->depth > 0)
+		jw->depth--;
+	jw_append(jw, &bracket, 1);
+}
+
+void
+jw_obj_begin(struct json_writer *jw, const char *key)
+{
+	jw_begin(jw, key, '{');
+}
+
+void
+jw_obj_end(struct json_writer *jw)
+{
+	jw_end(jw, '}');
+}
+
+void
+jw_arr_begin(struct json_writer *jw, const char *key)
+{
+	jw_begin(jw, key, '[');
+}
+
+void
+jw_arr_end(struct json_writer *jw)
+{
+	jw_end(jw, ']');
+}
+
+void
+jw_str(struct json_writer *jw, const char *key, const char *val)
+{
+	jw_key(jw, key);
+	jw_append_escaped(jw, val, strlen(val));
+}
+
+void
+jw_strf(struct json_writer *jw, const char *key, const char *format, ...)
+{
+	char buf[128];
+	char *str = buf;
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+	if (unlikely(len < 0)) {
+		jw->err = 1;
+		return;
+	}
+
+	/* Format on heap if the value is long such as an error message. */
+	if ((size_t)len >= sizeof(buf)) {
+		str = malloc(len + 1);
+		if (unlikely(str == NULL)) {
+			jw->err = 1;
+			return;
+		}
+		va_start(ap, format);
+		vsnprintf(str, len + 1, format, ap);
+		va_end(ap);
+	}
+
+	jw_key(jw, key);
+	jw_append_escaped(jw, str, len);
+
+	if (str != buf)
+		free(str);
+}
+
+void
+jw_int(struct json_writer *jw, const char *key, int64_t val)
+{
+	jw_key(jw, key);
+	jw_appendf(jw, "%"PRId64, val);
+}
+
+void
+jw_uint(struct json_writer *jw, const char *key, uint64_t val)
+{
+	jw_key(jw, key);
+	jw_appendf(jw, "%"PRIu64, val);
+}
+
+void
+jw_null(struct json_writer *jw, const char *key)
+{
+	jw_key(jw, key);
+	jw_append(jw, "null", 4);
+}
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_JSON_WRITER_H__
+#define __SHARED_JSON_WRITER_H__
+
+/**
+ * @file
+ * Streaming writer of JSON message.
+ *
+ * Members are appended to a buffer growing on heap, and the length of the
+ * message is kept in the writer. So cost of building a message is linear to
+ * its size and there is no limit of the size. Commas between members are
+ * inserted by the writer. Key of a member is given as `NULL` for elements
+ * of an array.
+ *
+ * Failures of allocation are not returned from each of functions but kept
+ * in `err` of the writer, and appending is skipped after that. Check it
+ * with jw_error() after the message is completed.
+ *
+ *   struct json_writer jw;
+ *
+ *   jw_init(&jw);
+ *   jw_obj_begin(&jw, NULL);
+ *   jw_str(&jw, "result", "success");
+ *   jw_arr_begin(&jw, "ports");
+ *   jw_strf(&jw, NULL, "phy:%d", 0);
+ *   jw_arr_end(&jw);
+ *   jw_obj_end(&jw);
+ *   if (jw_error(&jw) == 0)
+ *       send(sock, jw.str, jw.len, 0);
+ *   jw_free(&jw);
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Initial size of buffer allocated at first appending. */
+#define JW_INIT_SIZE 4096
+
+/* Max depth of nested objects and arrays. */
+#define JW_MAX_DEPTH 32
+
+struct json_writer {
+	char *str;  /* Message terminated with '\0', or NULL if empty. */
+	size_t len;  /* Length of message without '\0'. */
+	size_t size;  /* Size of allocated buffer. */
+	int depth;  /* Depth of current object or array. */
+	uint8_t has_member[JW_MAX_DEPTH + 1];  /* Need comma if it is 1. */
+	int err;  /* Set if failed to append once. */
+};
+
+/**
+ * Initialize writer. Buffer is not allocated until appending.
+ *
+ * @param jw Writer.
+ */
+void jw_init(struct json_writer *jw);
+
+/**
+ * Release buffer of writer.
+ *
+ * @param jw Writer.
+ */
+void jw_free(struct json_writer *jw);
+
+/**
+ * Clear message and error to reuse the buffer for next message.
+ *
+ * @param jw Writer.
+ */
+void jw_reset(struct json_writer *jw);
+
+/**
+ * Check if all of appending are succeeded.
+ *
+ * @param jw Writer.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+static inline int
+jw_error(const struct json_writer *jw)
+{
+	return jw->err ? -1 : 0;
+}
+
+/**
+ * Begin an object as `"key":{`, or `{` if key is NULL.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ */
+void jw_obj_begin(struct json_writer *jw, const char *key);
+
+/**
+ * End current object.
+ *
+ * @param jw Writer.
+ */
+void jw_obj_end(struct json_writer *jw);
+
+/**
+ * Begin an array as `"key":[`, or `[` if key is NULL.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ */
+void jw_arr_begin(struct json_writer *jw, const char *key);
+
+/**
+ * End current array.
+ *
+ * @param jw Writer.
+ */
+void jw_arr_end(struct json_writer *jw);
+
+/**
+ * Append a string member. Value is escaped.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ * @param val String value.
+ */
+void jw_str(struct json_writer *jw, const char *key, const char *val);
+
+/**
+ * Append a string member formatted as printf(). Value is escaped.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ * @param format Format of printf().
+ */
+void jw_strf(struct json_writer *jw, const char *key,
+		const char *format, ...)
+	__attribute__((format(printf, 3, 4)));
+
+/**
+ * Append a signed integer member.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ * @param val Integer value.
+ */
+void jw_int(struct json_writer *jw, const char *key, int64_t val);
+
+/**
+ * Append an unsigned integer member.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ * @param val Integer value.
+ */
+void jw_uint(struct json_writer *jw, const char *key, uint64_t val);
+
+/**
+ * Append a `null` member.
+ *
+ * @param jw Writer.
+ * @param key Key of the member, or NULL.
+ */
+void jw_null(struct json_writer *jw, const char *key);
+
+#endif
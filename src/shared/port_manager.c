@@ -2,6 +2,11 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
 #include "shared/port_manager.h"
 
 struct porttype_map portmap[] = {
@@ -15,6 +20,54 @@ struct porttype_map portmap[] = {
 	{ .port_name = NULL,    .port_type = UNDEF, },
 };
 
+/*
+ * Counters of ports not shared with other processes, such as vhost. It is
+ * separated for each of lcores as same as `struct lcore_port_stats`.
+ */
+static struct stats local_stats[RTE_MAX_LCORE][RTE_MAX_ETHPORTS];
+
+/* Num of buckets of index for finding ethdev ID from port type and ID. */
+#define PORT_IDX_BUCKETS RTE_MAX_ETHPORTS
+
+/*
+ * Index for finding ethdev ID from port type and ID of port_map. Each of
+ * buckets is a list of ethdev IDs chained with `port_idx_next`. ethdev ID + 1
+ * is stored in the list so that zero means the end of it.
+ */
+static uint16_t port_idx_heads[PORT_IDX_BUCKETS];
+static uint16_t port_idx_next[RTE_MAX_ETHPORTS];
+static uint8_t port_idx_registered[RTE_MAX_ETHPORTS];
+
+/* Lcores for forwarding. Each of patches is assigned to one of them. */
+static unsigned int fwd_lcores[RTE_MAX_LCORE];
+static unsigned int nof_fwd_lcores;
+static uint8_t is_fwd_lcore[RTE_MAX_LCORE];
+
+/*
+ * Active patch and lcores it is assigned to in schedule_patches(). Patches
+ * sending to the same TX queue are put in a group with union-find, and
+ * members of a group are assigned to the same lcore, because TX queue is not
+ * thread safe.
+ */
+struct sched_patch {
+	uint16_t in_port;
+	uint16_t in_queue;
+	unsigned int prev_lcore_id;  /* Assigned before, or LCORE_ID_ANY. */
+	unsigned int lcore_id;  /* Assigned now, or LCORE_ID_ANY. */
+	unsigned int group;  /* Parent in union-find, or itself if root. */
+	/* Referred only for the root of a group. */
+	uint16_t nof_members;
+	unsigned int vote_lcore_id;  /* Lcore most of members assigned before. */
+	unsigned int nof_votes;
+};
+
+static struct sched_patch
+		sched_patches[RTE_MAX_ETHPORTS * RTE_MAX_QUEUES_PER_PORT];
+
+/* Index of sched_patches sending to each of TX queues, or NO_TX_USER. */
+#define NO_TX_USER UINT32_MAX
+static uint32_t tx_queue_users[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+
 void
 forward_array_init_one(unsigned int i, unsigned int j)
 {
@@ -22,6 +75,11 @@ forward_array_init_one(unsigned int i, unsigned int j)
 	ports_fwd_array[i][j].in_queue_id = 0;
 	ports_fwd_array[i][j].out_port_id = PORT_RESET;
 	ports_fwd_array[i][j].out_queue_id = 0;
+	ports_fwd_array[i][j].nof_fanout = 0;
+	ports_fwd_array[i][j].mode = PATCH_MODE_COPY;
+	ports_fwd_array[i][j].lcore_id = LCORE_ID_ANY;
+	ports_fwd_array[i][j].tx_burst = 0;
+	ports_fwd_array[i][j].drain_us = 0;
 }
 
 /* initialize forward array with default value */
@@ -51,6 +109,7 @@ forward_array_reset(void)
 		for (j = 0; j < max_queue; j++) {
 			if (ports_fwd_array[i][j].in_port_id != PORT_RESET) {
 				ports_fwd_array[i][j].out_port_id = PORT_RESET;
+				ports_fwd_array[i][j].nof_fanout = 0;
 				RTE_LOG(INFO, SHARED, "Port ID %d\n", i);
 				RTE_LOG(INFO, SHARED, "Queue ID %d\n", j);
 				RTE_LOG(INFO, SHARED, "out_port_id %d\n",
@@ -58,15 +117,617 @@ forward_array_reset(void)
 			}
 		}
 	}
+
+	schedule_patches();
+}
+
+/* Register slave lcores as forwarding lcores to which patches assigned. */
+void
+fwd_lcores_init(void)
+{
+	unsigned int lcore_id;
+
+	nof_fwd_lcores = 0;
+	memset(is_fwd_lcore, 0, sizeof(is_fwd_lcore));
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		fwd_lcores[nof_fwd_lcores++] = lcore_id;
+		is_fwd_lcore[lcore_id] = 1;
+	}
+}
+
+/* Resolve destination of a patch forwarded on given lcore. */
+static void
+set_fwd_dst(struct fwd_dst *dst, uint16_t out_port, uint16_t out_queue,
+		unsigned int lcore_id, uint64_t tsc_per_us)
+{
+	struct tx_policy_conf *tx_conf = &port_map[out_port].tx_conf;
+
+	dst->out_port = out_port;
+	dst->out_queue = out_queue;
+	dst->tx_func = ports_fwd_array[out_port][out_queue].tx_func;
+	dst->tx_stats = get_lcore_port_stats(out_port, lcore_id);
+	dst->tx_policy = tx_conf->policy;
+	if (tx_conf->policy == TX_POLICY_RETRY)
+		dst->retry_tsc = tsc_per_us * tx_conf->retry_us;
+	else
+		dst->retry_tsc = 0;
+}
+
+/*
+ * Return the forwarding lcore with the fewest patches which has room for
+ * `nof_new` patches, or LCORE_ID_ANY.
+ */
+static unsigned int
+get_least_loaded_lcore(const uint16_t *nof_lcore_patches, uint16_t nof_new)
+{
+	unsigned int i, lcore_id;
+	unsigned int least = LCORE_ID_ANY;
+
+	for (i = 0; i < nof_fwd_lcores; i++) {
+		lcore_id = fwd_lcores[i];
+		if (nof_lcore_patches[lcore_id] + nof_new >
+				MAX_PATCHES_PER_LCORE)
+			continue;
+		if (least == LCORE_ID_ANY || nof_lcore_patches[lcore_id] <
+				nof_lcore_patches[least])
+			least = lcore_id;
+	}
+
+	return least;
+}
+
+/* Find the root of the group of given patch in sched_patches. */
+static unsigned int
+find_patch_group(unsigned int i)
+{
+	while (sched_patches[i].group != i) {
+		sched_patches[i].group =
+			sched_patches[sched_patches[i].group].group;
+		i = sched_patches[i].group;
+	}
+
+	return i;
+}
+
+/* Merge groups of given patches. The smaller index becomes the root. */
+static void
+merge_patch_groups(unsigned int i, unsigned int j)
+{
+	i = find_patch_group(i);
+	j = find_patch_group(j);
+	if (i < j)
+		sched_patches[j].group = i;
+	else if (j < i)
+		sched_patches[i].group = j;
+}
+
+/* Put given patch in the group of patches sending to the TX queue. */
+static void
+join_tx_queue_group(unsigned int i, uint16_t out_port, uint16_t out_queue)
+{
+	uint32_t *user = &tx_queue_users[out_port][out_queue];
+
+	if (*user == NO_TX_USER)
+		*user = i;
+	else
+		merge_patch_groups(i, *user);
+}
+
+/*
+ * Fill tables of patches of lcores from sched_patches and publish them. If
+ * `stay_only` is 1, patches moving to another lcore are left out of both of
+ * the lcores.
+ */
+static void
+publish_patches(unsigned int nof_patches, int stay_only)
+{
+	unsigned int i, lcore_id;
+	struct sched_patch *sp;
+	struct port *patch;
+	struct lcore_patch_table *table;
+	struct fwd_patch *fwd_patch;
+	uint16_t d;
+	uint16_t nof_lcore_patches[RTE_MAX_LCORE] = { 0 };
+	const uint64_t tsc_per_us = (rte_get_tsc_hz() + US_PER_S - 1) /
+			US_PER_S;
+
+	for (i = 0; i < nof_patches; i++) {
+		sp = &sched_patches[i];
+		lcore_id = sp->lcore_id;
+		if (lcore_id == LCORE_ID_ANY ||
+				(stay_only && lcore_id != sp->prev_lcore_id))
+			continue;
+
+		patch = &ports_fwd_array[sp->in_port][sp->in_queue];
+		table = get_upd_patch_table(lcore_id);
+		fwd_patch = &table->patches[nof_lcore_patches[lcore_id]++];
+		fwd_patch->in_port = sp->in_port;
+		fwd_patch->in_queue = sp->in_queue;
+		fwd_patch->rx_func = patch->rx_func;
+		fwd_patch->rx_stats = get_lcore_port_stats(sp->in_port,
+				lcore_id);
+		fwd_patch->tx_burst = patch->tx_burst;
+		fwd_patch->drain_tsc = tsc_per_us * patch->drain_us;
+		fwd_patch->mode = patch->mode;
+		fwd_patch->nof_dsts = 1 + patch->nof_fanout;
+		set_fwd_dst(&fwd_patch->dsts[0], patch->out_port_id,
+				patch->out_queue_id, lcore_id, tsc_per_us);
+		for (d = 0; d < patch->nof_fanout; d++)
+			set_fwd_dst(&fwd_patch->dsts[d + 1],
+					patch->fanout[d].port_id,
+					patch->fanout[d].queue_id,
+					lcore_id, tsc_per_us);
+	}
+
+	/*
+	 * Publish updated tables to lcores. Patches are not changed in place,
+	 * so that lcores keep forwarding while updating.
+	 */
+	for (i = 0; i < nof_fwd_lcores; i++) {
+		lcore_id = fwd_lcores[i];
+		get_upd_patch_table(lcore_id)->nof_patches =
+				nof_lcore_patches[lcore_id];
+		publish_patch_table(lcore_id);
+	}
+}
+
+/*
+ * Assign each of patches to one of forwarding lcores, so that RX queue of a
+ * patch is polled from only one lcore. Patches sending to the same TX queue
+ * are also assigned to the same lcore. It is called every time patches are
+ * added or removed. A patch stays on the lcore assigned before, and a new
+ * patch is placed on the lcore with the fewest patches. A patch is moved
+ * only if it joins a group of patches on another lcore, to the lcore where
+ * most of the group are.
+ *
+ * Assigned patches are also packed into a dense list of each lcore, so that
+ * forward() does not need to scan all of ports and queues. The list is built
+ * in the table not referred from the lcore and published after that. If a
+ * patch is moved, it is removed from the old lcore and all of lcores switch
+ * tables before it is added to the new one, so that two lcores never poll
+ * the same queue.
+ */
+void
+schedule_patches(void)
+{
+	unsigned int i, j;
+	unsigned int nof_patches = 0;
+	uint16_t max_queue;
+	unsigned int lcore_id;
+	int moved = 0;
+	struct port *patch;
+	struct sched_patch *sp, *root;
+	uint16_t d;
+	uint16_t nof_lcore_patches[RTE_MAX_LCORE] = { 0 };
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		max_queue = get_port_max_queues(i);
+
+		for (j = 0; j < max_queue; j++) {
+			patch = &ports_fwd_array[i][j];
+			if (patch->in_port_id == PORT_RESET ||
+					patch->out_port_id == PORT_RESET ||
+					nof_fwd_lcores == 0) {
+				patch->lcore_id = LCORE_ID_ANY;
+				continue;
+			}
+
+			sp = &sched_patches[nof_patches];
+			sp->in_port = i;
+			sp->in_queue = j;
+			sp->lcore_id = LCORE_ID_ANY;
+			if (patch->lcore_id < RTE_MAX_LCORE &&
+					is_fwd_lcore[patch->lcore_id])
+				sp->prev_lcore_id = patch->lcore_id;
+			else
+				sp->prev_lcore_id = LCORE_ID_ANY;
+			sp->group = nof_patches;
+			sp->nof_members = 0;
+			sp->vote_lcore_id = LCORE_ID_ANY;
+			sp->nof_votes = 0;
+			nof_patches++;
+
+			tx_queue_users[patch->out_port_id][
+					patch->out_queue_id] = NO_TX_USER;
+			for (d = 0; d < patch->nof_fanout; d++)
+				tx_queue_users[patch->fanout[d].port_id][
+					patch->fanout[d].queue_id] =
+					NO_TX_USER;
+		}
+	}
+
+	/* Group patches sending to the same TX queue. */
+	for (i = 0; i < nof_patches; i++) {
+		sp = &sched_patches[i];
+		patch = &ports_fwd_array[sp->in_port][sp->in_queue];
+		join_tx_queue_group(i, patch->out_port_id,
+				patch->out_queue_id);
+		for (d = 0; d < patch->nof_fanout; d++)
+			join_tx_queue_group(i, patch->fanout[d].port_id,
+					patch->fanout[d].queue_id);
+	}
+
+	/* Vote for the lcore most of members are assigned before. */
+	for (i = 0; i < nof_patches; i++) {
+		sp = &sched_patches[i];
+		root = &sched_patches[find_patch_group(i)];
+		root->nof_members++;
+		if (sp->prev_lcore_id == LCORE_ID_ANY)
+			continue;
+		if (root->nof_votes == 0)
+			root->vote_lcore_id = sp->prev_lcore_id;
+		if (root->vote_lcore_id == sp->prev_lcore_id)
+			root->nof_votes++;
+		else
+			root->nof_votes--;
+	}
+
+	/* Keep groups on lcores assigned before. */
+	for (i = 0; i < nof_patches; i++) {
+		root = &sched_patches[i];
+		lcore_id = root->vote_lcore_id;
+		if (root->group != i || lcore_id == LCORE_ID_ANY ||
+				nof_lcore_patches[lcore_id] +
+				root->nof_members > MAX_PATCHES_PER_LCORE)
+			continue;
+		root->lcore_id = lcore_id;
+		nof_lcore_patches[lcore_id] += root->nof_members;
+	}
+
+	/* Place new groups. */
+	for (i = 0; i < nof_patches; i++) {
+		root = &sched_patches[i];
+		if (root->group != i || root->lcore_id != LCORE_ID_ANY)
+			continue;
+
+		lcore_id = get_least_loaded_lcore(nof_lcore_patches,
+				root->nof_members);
+		if (lcore_id == LCORE_ID_ANY) {
+			RTE_LOG(ERR, SHARED,
+				"Too many patches, port %u queue %u "
+				"is not forwarded\n",
+				root->in_port, root->in_queue);
+			continue;
+		}
+		root->lcore_id = lcore_id;
+		nof_lcore_patches[lcore_id] += root->nof_members;
+	}
+
+	for (i = 0; i < nof_patches; i++) {
+		sp = &sched_patches[i];
+		sp->lcore_id = sched_patches[find_patch_group(i)].lcore_id;
+		if (sp->prev_lcore_id != LCORE_ID_ANY &&
+				sp->lcore_id != sp->prev_lcore_id)
+			moved = 1;
+		ports_fwd_array[sp->in_port][sp->in_queue].lcore_id =
+				sp->lcore_id;
+
+		RTE_LOG(DEBUG, SHARED,
+			"Patch from port %u queue %u on lcore %u\n",
+			sp->in_port, sp->in_queue, sp->lcore_id);
+	}
+
+	if (moved)
+		publish_patches(nof_patches, 1);
+	publish_patches(nof_patches, 0);
+}
+
+/* Get counters of given port which are updated only from given lcore. */
+struct stats *
+get_lcore_port_stats(uint16_t port_id, unsigned int lcore_id)
+{
+	struct lcore_port_stats *lcore_stats = &ports->lcore_stats[lcore_id];
+
+	switch (port_map[port_id].stats_type) {
+	case STATS_PORT:
+		return &lcore_stats->port_stats[port_map[port_id].stats_idx];
+	case STATS_CLIENT:
+		return &lcore_stats->client_stats[port_map[port_id].stats_idx];
+	default:
+		return &local_stats[lcore_id][port_id];
+	}
+}
+
+/* Sum up counters of given port of all of lcores. */
+void
+get_port_stats_sum(uint16_t port_id, struct stats *sum)
+{
+	unsigned int lcore_id;
+
+	memset(sum, 0, sizeof(*sum));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		add_stats(sum, get_lcore_port_stats(port_id, lcore_id));
+}
+
+void
+collect_port_map_stats(struct shm_stats *st)
+{
+	struct shm_port_stats *port_st;
+	uint16_t port_id;
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		if (port_map[port_id].port_type == UNDEF)
+			continue;
+
+		port_st = &st->ports[st->nof_ports++];
+		port_st->port_type = port_map[port_id].port_type;
+		port_st->port_id = port_map[port_id].id;
+		get_port_stats_sum(port_id, &port_st->stats);
+	}
+}
+
+void
+collect_fwd_lcore_stats(struct shm_stats *st)
+{
+	const struct fwd_lcore_polls *polls;
+	struct shm_lcore_stats *lcore_st;
+	unsigned int lcore_id;
+	uint16_t port_id;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lcore_st = &st->lcores[st->nof_lcores++];
+		polls = get_fwd_lcore_polls(lcore_id);
+		lcore_st->lcore_id = lcore_id;
+		lcore_st->polls = polls->polls;
+		lcore_st->busy_polls = polls->busy_polls;
+
+		memset(&lcore_st->stats, 0, sizeof(lcore_st->stats));
+		for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+			if (port_map[port_id].port_type == UNDEF)
+				continue;
+			add_stats(&lcore_st->stats,
+				get_lcore_port_stats(port_id, lcore_id));
+		}
+	}
+}
+
+/* Words in names of xstats of drops and errors published to the segment. */
+static const char * const eth_xstat_keywords[] = {
+	"drop", "miss", "err", "nombuf", "no_mbuf", "discard", NULL,
+};
+
+/*
+ * IDs of xstats of drops and errors of each ethdev. They are looked up by
+ * names once, and only values are read by IDs for each sampling.
+ */
+static struct {
+	int looked_up;
+	uint16_t nof_ids;
+	uint64_t ids[SHM_STATS_MAX_XSTATS];
+	char names[SHM_STATS_MAX_XSTATS][RTE_ETH_XSTATS_NAME_SIZE];
+} eth_xstat_ids[RTE_MAX_ETHPORTS];
+
+static void
+lookup_eth_xstat_ids(uint16_t port_id)
+{
+	struct rte_eth_xstat_name *names;
+	int nof_names, i, j;
+
+	eth_xstat_ids[port_id].looked_up = 1;
+	eth_xstat_ids[port_id].nof_ids = 0;
+
+	nof_names = rte_eth_xstats_get_names(port_id, NULL, 0);
+	if (nof_names <= 0)
+		return;
+
+	names = malloc(sizeof(*names) * nof_names);
+	if (names == NULL)
+		return;
+
+	nof_names = rte_eth_xstats_get_names(port_id, names, nof_names);
+	for (i = 0; i < nof_names &&
+			eth_xstat_ids[port_id].nof_ids < SHM_STATS_MAX_XSTATS;
+			i++) {
+		for (j = 0; eth_xstat_keywords[j] != NULL; j++) {
+			if (strstr(names[i].name, eth_xstat_keywords[j]))
+				break;
+		}
+		if (eth_xstat_keywords[j] == NULL)
+			continue;
+
+		memcpy(eth_xstat_ids[port_id].names[
+				eth_xstat_ids[port_id].nof_ids],
+				names[i].name, RTE_ETH_XSTATS_NAME_SIZE);
+		eth_xstat_ids[port_id].ids[eth_xstat_ids[port_id].nof_ids++] =
+			i;
+	}
+
+	free(names);
+}
+
+void
+collect_eth_stats(struct shm_stats *st, uint16_t port_id)
+{
+	struct rte_eth_dev_data *data = rte_eth_devices[port_id].data;
+	uint64_t values[SHM_STATS_MAX_XSTATS];
+	struct shm_eth_stats *eth_st;
+	uint16_t nof_ids, i;
+
+	if (st->nof_eths >= RTE_MAX_ETHPORTS)
+		return;
+
+	eth_st = &st->eths[st->nof_eths];
+	if (rte_eth_stats_get(port_id, &eth_st->stats) != 0)
+		return;
+	st->nof_eths++;
+
+	eth_st->port_id = port_id;
+	eth_st->nof_rxq = RTE_MIN(data->nb_rx_queues,
+			RTE_ETHDEV_QUEUE_STAT_CNTRS);
+	eth_st->nof_txq = RTE_MIN(data->nb_tx_queues,
+			RTE_ETHDEV_QUEUE_STAT_CNTRS);
+	eth_st->nof_xstats = 0;
+
+	if (!eth_xstat_ids[port_id].looked_up)
+		lookup_eth_xstat_ids(port_id);
+
+	nof_ids = eth_xstat_ids[port_id].nof_ids;
+	if (nof_ids == 0)
+		return;
+
+	/* Look up again next time if the port is changed. */
+	if (rte_eth_xstats_get_by_id(port_id, eth_xstat_ids[port_id].ids,
+				values, nof_ids) != nof_ids) {
+		eth_xstat_ids[port_id].looked_up = 0;
+		return;
+	}
+
+	for (i = 0; i < nof_ids; i++) {
+		memcpy(eth_st->xstats[i].name, eth_xstat_ids[port_id].names[i],
+				RTE_ETH_XSTATS_NAME_SIZE);
+		eth_st->xstats[i].value = values[i];
+	}
+	eth_st->nof_xstats = nof_ids;
+}
+
+/* Append xstats of non-zero values as an object of names and values. */
+static void
+append_eth_xstats_json(struct json_writer *jw, uint16_t port_id)
+{
+	struct rte_eth_xstat_name *names = NULL;
+	struct rte_eth_xstat *xstats = NULL;
+	int nof_xstats, nof_names, i;
+
+	jw_obj_begin(jw, "xstats");
+
+	nof_xstats = rte_eth_xstats_get(port_id, NULL, 0);
+	if (nof_xstats <= 0)
+		goto end;
+
+	names = malloc(sizeof(*names) * nof_xstats);
+	xstats = malloc(sizeof(*xstats) * nof_xstats);
+	if (names == NULL || xstats == NULL)
+		goto end;
+
+	nof_names = rte_eth_xstats_get_names(port_id, names, nof_xstats);
+	nof_xstats = rte_eth_xstats_get(port_id, xstats, nof_xstats);
+	for (i = 0; i < nof_xstats; i++) {
+		if (xstats[i].value == 0 || xstats[i].id >= (uint64_t)nof_names)
+			continue;
+		jw_uint(jw, names[xstats[i].id].name, xstats[i].value);
+	}
+
+end:
+	jw_obj_end(jw);
+	free(names);
+	free(xstats);
+}
+
+void
+append_eth_stats_json(struct json_writer *jw, const char *key,
+		uint16_t port_id)
+{
+	struct rte_eth_dev_data *data = rte_eth_devices[port_id].data;
+	struct rte_eth_stats stats;
+	uint16_t nof_rxq, nof_txq, i;
+
+	if (rte_eth_stats_get(port_id, &stats) != 0) {
+		jw_null(jw, key);
+		return;
+	}
+
+	nof_rxq = RTE_MIN(data->nb_rx_queues, RTE_ETHDEV_QUEUE_STAT_CNTRS);
+	nof_txq = RTE_MIN(data->nb_tx_queues, RTE_ETHDEV_QUEUE_STAT_CNTRS);
+
+	jw_obj_begin(jw, key);
+	jw_uint(jw, "ipackets", stats.ipackets);
+	jw_uint(jw, "opackets", stats.opackets);
+	jw_uint(jw, "ibytes", stats.ibytes);
+	jw_uint(jw, "obytes", stats.obytes);
+	jw_uint(jw, "imissed", stats.imissed);
+	jw_uint(jw, "ierrors", stats.ierrors);
+	jw_uint(jw, "oerrors", stats.oerrors);
+	jw_uint(jw, "rx_nombuf", stats.rx_nombuf);
+
+	jw_arr_begin(jw, "rx_queues");
+	for (i = 0; i < nof_rxq; i++) {
+		jw_obj_begin(jw, NULL);
+		jw_uint(jw, "id", i);
+		jw_uint(jw, "packets", stats.q_ipackets[i]);
+		jw_uint(jw, "bytes", stats.q_ibytes[i]);
+		jw_uint(jw, "errors", stats.q_errors[i]);
+		jw_obj_end(jw);
+	}
+	jw_arr_end(jw);
+
+	jw_arr_begin(jw, "tx_queues");
+	for (i = 0; i < nof_txq; i++) {
+		jw_obj_begin(jw, NULL);
+		jw_uint(jw, "id", i);
+		jw_uint(jw, "packets", stats.q_opackets[i]);
+		jw_uint(jw, "bytes", stats.q_obytes[i]);
+		jw_obj_end(jw);
+	}
+	jw_arr_end(jw);
+
+	append_eth_xstats_json(jw, port_id);
+	jw_obj_end(jw);
+}
+
+static inline unsigned int
+get_port_idx_bucket(enum port_type type, int id)
+{
+	return ((unsigned int)id * UNDEF + type) % PORT_IDX_BUCKETS;
+}
+
+/* Remove ethdev ID from the index of port type and ID. */
+static void
+unregister_port_idx(uint16_t port_id)
+{
+	uint16_t *p;
+
+	if (!port_idx_registered[port_id])
+		return;
+
+	p = &port_idx_heads[get_port_idx_bucket(port_map[port_id].port_type,
+			port_map[port_id].id)];
+	while (*p != 0) {
+		if (*p == port_id + 1) {
+			*p = port_idx_next[port_id];
+			break;
+		}
+		p = &port_idx_next[*p - 1];
+	}
+	port_idx_next[port_id] = 0;
+	port_idx_registered[port_id] = 0;
+}
+
+/*
+ * Set port type and ID of given ethdev ID to port_map, and register it to
+ * the index to be found with find_port_id().
+ */
+void
+set_port_map_id(uint16_t port_id, enum port_type type, int id)
+{
+	unsigned int bucket;
+
+	unregister_port_idx(port_id);
+
+	port_map[port_id].port_type = type;
+	port_map[port_id].id = id;
+
+	bucket = get_port_idx_bucket(type, id);
+	port_idx_next[port_id] = port_idx_heads[bucket];
+	port_idx_heads[bucket] = port_id + 1;
+	port_idx_registered[port_id] = 1;
 }
 
 void
 port_map_init_one(unsigned int i)
 {
+	unsigned int lcore_id;
+
+	unregister_port_idx(i);
 	port_map[i].id = PORT_RESET;
 	port_map[i].port_type = UNDEF;
-	port_map[i].stats = &port_map[i].default_stats;
+	port_map[i].stats_type = STATS_NONE;
+	port_map[i].stats_idx = 0;
+	port_map[i].tx_conf.policy = TX_POLICY_DROP;
+	port_map[i].tx_conf.retry_us = 0;
 	port_map[i].queue_info = NULL;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		memset(&local_stats[lcore_id][i], 0, sizeof(struct stats));
 }
 
 void
@@ -78,9 +739,12 @@ port_map_init(void)
 		port_map_init_one(i);
 }
 
-/* Return -1 as an error if given patch is invalid */
-int
-add_patch(uint16_t in_port, uint16_t in_queue,
+/*
+ * Set out port of the patch from in_port and in_queue, and reset its options.
+ * It is not published to forwarding lcores until schedule_patches() is called.
+ */
+static int
+fill_patch(uint16_t in_port, uint16_t in_queue,
 		uint16_t out_port, uint16_t out_queue)
 {
 	if (!is_valid_port(in_port, in_queue) ||
@@ -98,6 +762,10 @@ add_patch(uint16_t in_port, uint16_t in_queue,
 	ports_fwd_array[in_port][in_queue].tx_func = &rte_eth_tx_burst;
 	ports_fwd_array[in_port][in_queue].out_port_id = out_port;
 	ports_fwd_array[in_port][in_queue].out_queue_id = out_queue;
+	ports_fwd_array[in_port][in_queue].nof_fanout = 0;
+	ports_fwd_array[in_port][in_queue].mode = PATCH_MODE_COPY;
+	ports_fwd_array[in_port][in_queue].tx_burst = 0;
+	ports_fwd_array[in_port][in_queue].drain_us = 0;
 
 	/* Populate out port data */
 	ports_fwd_array[out_port][out_queue].in_port_id = out_port;
@@ -124,6 +792,219 @@ add_patch(uint16_t in_port, uint16_t in_queue,
 	return 0;
 }
 
+/* Return -1 as an error if given patch is invalid */
+int
+add_patch(uint16_t in_port, uint16_t in_queue,
+		uint16_t out_port, uint16_t out_queue)
+{
+	int ret;
+
+	ret = fill_patch(in_port, in_queue, out_port, out_queue);
+	if (ret != 0)
+		return ret;
+
+	schedule_patches();
+
+	return 0;
+}
+
+/**
+ * Add a destination to the patch from given in_port and in_queue to make it
+ * a fan-out patch. Packets are sent to all of destinations without copying.
+ *
+ * Return -1 as an error if given patch or port is invalid, or the patch
+ * already has MAX_PATCH_DSTS destinations.
+ */
+static int
+add_patch_fanout(uint16_t in_port, uint16_t in_queue,
+		uint16_t out_port, uint16_t out_queue)
+{
+	struct port *patch;
+	uint16_t i;
+
+	if (!is_valid_port(in_port, in_queue) ||
+		!is_valid_port(out_port, out_queue) ||
+		!is_valid_port_txq(out_port, out_queue))
+		return -1;
+
+	patch = &ports_fwd_array[in_port][in_queue];
+	if (patch->out_port_id == PORT_RESET)
+		return -1;
+
+	if (patch->out_port_id == out_port &&
+			patch->out_queue_id == out_queue)
+		return -1;
+	for (i = 0; i < patch->nof_fanout; i++) {
+		if (patch->fanout[i].port_id == out_port &&
+				patch->fanout[i].queue_id == out_queue)
+			return -1;
+	}
+
+	if (patch->nof_fanout >= MAX_PATCH_DSTS - 1) {
+		RTE_LOG(ERR, SHARED, "Too many destinations of port %d "
+			"queue %d\n", in_port, in_queue);
+		return -1;
+	}
+
+	/* Populate out port data */
+	ports_fwd_array[out_port][out_queue].in_port_id = out_port;
+	ports_fwd_array[out_port][out_queue].in_queue_id = out_queue;
+	ports_fwd_array[out_port][out_queue].rx_func = &rte_eth_rx_burst;
+	ports_fwd_array[out_port][out_queue].tx_func = &rte_eth_tx_burst;
+
+	patch->fanout[patch->nof_fanout].port_id = out_port;
+	patch->fanout[patch->nof_fanout].queue_id = out_queue;
+	patch->nof_fanout++;
+
+	RTE_LOG(DEBUG, SHARED, "STATUS: in port %d in queue %d"
+		" fan-out to port %d queue %d\n",
+		in_port, in_queue, out_port, out_queue);
+
+	return 0;
+}
+
+/**
+ * Set how packets are sent to destinations of the patch from given in_port
+ * and in_queue, copied to all of them or distributed by hash of flows.
+ *
+ * Return -1 as an error if given patch is invalid.
+ */
+static int
+set_patch_mode(uint16_t in_port, uint16_t in_queue, enum patch_mode mode)
+{
+	if (!is_valid_port(in_port, in_queue) ||
+			ports_fwd_array[in_port][in_queue].out_port_id ==
+			PORT_RESET)
+		return -1;
+
+	ports_fwd_array[in_port][in_queue].mode = mode;
+
+	RTE_LOG(DEBUG, SHARED, "Mode of patch of port %d queue %d is %d\n",
+		in_port, in_queue, mode);
+
+	return 0;
+}
+
+/* Remove given port from destinations of fan-out patches. */
+static void
+remove_fanout_dst(uint16_t port_id, uint16_t queue_id)
+{
+	unsigned int i, j;
+	uint16_t d, max_queue;
+	struct port *patch;
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		max_queue = get_port_max_queues(i);
+
+		for (j = 0; j < max_queue; j++) {
+			patch = &ports_fwd_array[i][j];
+			d = 0;
+			while (d < patch->nof_fanout) {
+				if (patch->fanout[d].port_id != port_id ||
+					patch->fanout[d].queue_id != queue_id) {
+					d++;
+					continue;
+				}
+				patch->nof_fanout--;
+				memmove(&patch->fanout[d],
+					&patch->fanout[d + 1],
+					sizeof(patch->fanout[0]) *
+					(patch->nof_fanout - d));
+			}
+		}
+	}
+}
+
+/**
+ * Buffer packets to be sent on the patch from given in_port and in_queue up
+ * to `tx_burst`, and send them if it reaches `tx_burst` or `drain_us` is
+ * passed. Buffering is disabled if `tx_burst` is 0 or 1.
+ *
+ * Return -1 as an error if given patch is invalid.
+ */
+static int
+set_patch_tx_buffer(uint16_t in_port, uint16_t in_queue,
+		uint16_t tx_burst, unsigned int drain_us)
+{
+	if (!is_valid_port(in_port, in_queue) ||
+			ports_fwd_array[in_port][in_queue].out_port_id ==
+			PORT_RESET)
+		return -1;
+
+	if (tx_burst > MAX_PKT_BURST)
+		return -1;
+
+	ports_fwd_array[in_port][in_queue].tx_burst = tx_burst;
+	ports_fwd_array[in_port][in_queue].drain_us = drain_us;
+
+	RTE_LOG(DEBUG, SHARED, "TX buffer of port %d queue %d, "
+		"tx_burst %u drain_us %u\n",
+		in_port, in_queue, tx_burst, drain_us);
+
+	return 0;
+}
+
+/* Set options of the patch from in_port and in_queue without publishing. */
+static int
+fill_patch_opts(uint16_t in_port, uint16_t in_queue,
+		const struct patch_opts *opts)
+{
+	uint16_t i;
+
+	for (i = 0; i < opts->nof_fanout; i++) {
+		if (add_patch_fanout(in_port, in_queue,
+				opts->fanout[i].port_id,
+				opts->fanout[i].queue_id) < 0)
+			return -1;
+	}
+
+	if (opts->has_mode &&
+			set_patch_mode(in_port, in_queue, opts->mode) < 0)
+		return -1;
+
+	if (opts->has_tx_buf)
+		return set_patch_tx_buffer(in_port, in_queue, opts->tx_burst,
+				opts->drain_us);
+
+	return 0;
+}
+
+/**
+ * Patch in_port and in_queue to out_port and out_queue with options, and
+ * publish it to forwarding lcores at once, so that lcores never forward
+ * with a patch partially updated. If any of options cannot be set, the
+ * patch is restored as before and nothing is published.
+ *
+ * Return -1 as an error if given patch or any of options is invalid.
+ */
+int
+add_patch_with_opts(uint16_t in_port, uint16_t in_queue,
+		uint16_t out_port, uint16_t out_queue,
+		const struct patch_opts *opts)
+{
+	struct port *patch;
+	struct port prev;
+	int ret;
+
+	if (!is_valid_port(in_port, in_queue))
+		return -1;
+
+	patch = &ports_fwd_array[in_port][in_queue];
+	prev = *patch;
+
+	ret = fill_patch(in_port, in_queue, out_port, out_queue);
+	if (ret == 0)
+		ret = fill_patch_opts(in_port, in_queue, opts);
+	if (ret != 0) {
+		*patch = prev;
+		return -1;
+	}
+
+	schedule_patches();
+
+	return 0;
+}
+
 /*
  * Return actual port ID which is assigned by system internally, or PORT_RESET
  * if port is not found.
@@ -131,20 +1012,16 @@ add_patch(uint16_t in_port, uint16_t in_queue,
 uint16_t
 find_port_id(int id, enum port_type type)
 {
-	uint16_t port_id = PORT_RESET;
 	uint16_t i;
 
-	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
-		if (port_map[i].port_type != type)
-			continue;
-
-		if (port_map[i].id == id) {
-			port_id = i;
-			break;
-		}
+	for (i = port_idx_heads[get_port_idx_bucket(type, id)]; i != 0;
+			i = port_idx_next[i - 1]) {
+		if (port_map[i - 1].port_type == type &&
+				port_map[i - 1].id == id)
+			return i - 1;
 	}
 
-	return port_id;
+	return PORT_RESET;
 }
 
 /* Return 0 if invalid */
@@ -208,34 +1085,52 @@ is_valid_port_txq(uint16_t port_id, uint16_t txq)
 	return 1;
 }
 
+/*
+ * Remove given port from ports_fwd_array. It is also removed from
+ * destinations of patches, and other destinations of a fan-out patch keep
+ * forwarding. If it is the first destination, the first fan-out one is
+ * promoted to it.
+ */
 void
 forward_array_remove(int port_id, uint16_t queue_id)
 {
 	unsigned int i, j;
-	uint16_t max_queue;
-	int remove_flg = 0;
+	uint16_t d, max_queue;
+	struct port *patch;
 
 	/* Update ports_fwd_array */
 	forward_array_init_one(port_id, queue_id);
+	remove_fanout_dst(port_id, queue_id);
 
+	/* Reset patches to the port, and keep other patches forwarding. */
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
 
 		max_queue = get_port_max_queues(i);
 
 		for (j = 0; j < max_queue; j++) {
-			if (ports_fwd_array[i][j].in_port_id == PORT_RESET &&
-				(ports_fwd_array[i][j].out_port_id != port_id ||
-				ports_fwd_array[i][j].out_queue_id != queue_id))
+			patch = &ports_fwd_array[i][j];
+			if (patch->out_port_id != port_id ||
+				patch->out_queue_id != queue_id)
 				continue;
 
-			ports_fwd_array[i][j].out_port_id = PORT_RESET;
-			remove_flg = 1;
-			break;
-		}
+			if (patch->nof_fanout == 0) {
+				patch->out_port_id = PORT_RESET;
+				continue;
+			}
 
-		if (remove_flg)
-			break;
+			patch->out_port_id = patch->fanout[0].port_id;
+			patch->out_queue_id = patch->fanout[0].queue_id;
+			patch->nof_fanout--;
+			for (d = 0; d < patch->nof_fanout; d++)
+				patch->fanout[d] = patch->fanout[d + 1];
+
+			RTE_LOG(INFO, SHARED, "Destination of port %u queue %u "
+				"is changed to port %u queue %u\n", i, j,
+				patch->out_port_id, patch->out_queue_id);
+		}
 	}
+
+	schedule_patches();
 }
 
 /* Return a type of port as a enum member of porttype_map structure. */
@@ -250,6 +1145,19 @@ enum port_type get_port_type(char *portname)
 	return UNDEF;
 }
 
+/* Return name of port type such as `ring`, or `unknown` if it is invalid. */
+const char *
+get_port_type_name(enum port_type type)
+{
+	int i;
+
+	for (i = 0; portmap[i].port_name != NULL; i++) {
+		if (portmap[i].port_type == type)
+			return portmap[i].port_name;
+	}
+	return "unknown";
+}
+
 /* Returns a larger number of queues of RX or TX port as the maximum number */
 uint16_t
 get_port_max_queues(uint16_t port_id)
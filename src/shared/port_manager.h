@@ -9,6 +9,11 @@
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
 #include "shared/basic_forwarder.h"
+#include "shared/json_writer.h"
+#include "shared/shm_stats.h"
+
+/* Shared port info defined in each of processes. */
+extern struct port_info *ports;
 
 /* It is used to convert port name from string type to enum */
 struct porttype_map {
@@ -22,14 +27,67 @@ void forward_array_init(void);
 void forward_array_reset(void);
 void forward_array_remove(int port_id, uint16_t queue_id);
 
+/* Register slave lcores as forwarding lcores to which patches assigned. */
+void fwd_lcores_init(void);
+
+/* Assign each of patches to one of forwarding lcores, keeping old ones. */
+void schedule_patches(void);
+
 void port_map_init_one(unsigned int i);
+
+/* Set port type and ID of the ethdev to port_map to be found. */
+void set_port_map_id(uint16_t port_id, enum port_type type, int id);
 void port_map_init(void);
 
+/* Get counters of given port which are updated only from given lcore. */
+struct stats *get_lcore_port_stats(uint16_t port_id, unsigned int lcore_id);
+
+/* Sum up counters of given port of all of lcores. */
+void get_port_stats_sum(uint16_t port_id, struct stats *sum);
+
+/* Fill counters of ports in port_map to the stats segment. */
+void collect_port_map_stats(struct shm_stats *st);
+
+/* Fill counters of forwarding lcores to the stats segment. */
+void collect_fwd_lcore_stats(struct shm_stats *st);
+
+/*
+ * Fill HW counters of the ethdev to the stats segment. It should be called
+ * only if shm_stats_eth_due() returns 1.
+ */
+void collect_eth_stats(struct shm_stats *st, uint16_t port_id);
+
+/*
+ * Append HW counters of the ethdev as JSON object of `key`, including ones
+ * of each of queues and non-zero xstats.
+ */
+void append_eth_stats_json(struct json_writer *jw, const char *key,
+		uint16_t port_id);
+
 enum port_type get_port_type(char *portname);
 
+/* Return name of port type such as `ring`, or `unknown` if it is invalid. */
+const char *get_port_type_name(enum port_type type);
+
+/* Options of a patch given to add_patch_with_opts(). */
+struct patch_opts {
+	uint16_t nof_fanout;  /* Destinations other than out_port. */
+	struct fanout_dst fanout[MAX_PATCH_DSTS - 1];
+	int has_mode;
+	enum patch_mode mode;
+	int has_tx_buf;
+	uint16_t tx_burst;
+	unsigned int drain_us;
+};
+
 int add_patch(uint16_t in_port, uint16_t in_queue,
 	uint16_t out_port, uint16_t out_queue);
 
+/* Add a patch with its options, and publish it to lcores at once. */
+int add_patch_with_opts(uint16_t in_port, uint16_t in_queue,
+	uint16_t out_port, uint16_t out_queue,
+	const struct patch_opts *opts);
+
 uint16_t find_port_id(int id, enum port_type type);
 
 int is_valid_port(uint16_t port_id, uint16_t queue_id);
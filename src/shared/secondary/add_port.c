@@ -161,10 +161,6 @@ add_vhost_pmd(int index)
 	uint16_t q;
 	int ret;
 
-	mp = rte_mempool_lookup(PKTMBUF_POOL_NAME);
-	if (mp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannot get mempool for mbufs\n");
-
 	/* eth_vhost0 index 0 iface /tmp/sock0 on numa 0 */
 	name = get_vhost_backend_name(index);
 	iface = get_vhost_iface_name(index);
@@ -178,6 +174,10 @@ add_vhost_pmd(int index)
 		return ret;
 	}
 
+	mp = get_pktmbuf_pool(rte_eth_dev_socket_id(vhost_port_id));
+	if (mp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot get mempool for mbufs\n");
+
 	/* NOTE: make sure the eth_dev is stopped.
 	 * it is for the case a secondary process which used the vhost
 	 * was down without stopping the device.
@@ -268,10 +268,6 @@ add_pcap_pmd(int index)
 			return ret;
 	}
 
-	mp = rte_mempool_lookup(PKTMBUF_POOL_NAME);
-	if (mp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
-
 	name = get_pcap_pmd_name(index);
 	sprintf(devargs,
 			"%s,rx_pcap=%s,tx_pcap=%s",
@@ -281,6 +277,10 @@ add_pcap_pmd(int index)
 	if (ret < 0)
 		return ret;
 
+	mp = get_pktmbuf_pool(rte_eth_dev_socket_id(pcap_pmd_port_id));
+	if (mp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
+
 	ret = rte_eth_dev_configure(
 			pcap_pmd_port_id, nr_queues, nr_queues, &port_conf);
 
@@ -337,10 +337,6 @@ add_memif_pmd(int index)
 	memset(devargs, '\0', sizeof(devargs));
 	memset(sock_fn, '\0', sizeof(sock_fn));
 
-	mp = rte_mempool_lookup(PKTMBUF_POOL_NAME);
-	if (mp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
-
 	name = get_memif_pmd_name(index);
 	sprintf(devargs, "%s,id=%d,role=%s,socket=%s",
 			name, index, MEMIF_ROLE, MEMIF_SOCK);
@@ -349,6 +345,10 @@ add_memif_pmd(int index)
 	if (ret < 0)
 		return ret;
 
+	mp = get_pktmbuf_pool(rte_eth_dev_socket_id(memif_pmd_port_id));
+	if (mp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
+
 	ret = rte_eth_dev_configure(
 			memif_pmd_port_id, nr_queues, nr_queues,
 			&port_conf);
@@ -401,16 +401,16 @@ add_null_pmd(int index)
 
 	int ret;
 
-	mp = rte_mempool_lookup(PKTMBUF_POOL_NAME);
-	if (mp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
-
 	name = get_null_pmd_name(index);
 	sprintf(devargs, "%s", name);
 	ret = dev_attach_by_devargs(devargs, &null_pmd_port_id);
 	if (ret < 0)
 		return ret;
 
+	mp = get_pktmbuf_pool(rte_eth_dev_socket_id(null_pmd_port_id));
+	if (mp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannon get mempool for mbuf\n");
+
 	ret = rte_eth_dev_configure(
 			null_pmd_port_id, nr_queues, nr_queues,
 			&port_conf);
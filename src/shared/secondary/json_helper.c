@@ -24,10 +24,9 @@ append_json_comma(char **output)
 int
 append_json_uint_value(char **output, const char *name, unsigned int value)
 {
-	int len = strlen(*output);
-
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + JSON_APPEND_LEN*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%u"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's numeric format failed to add. "
@@ -35,8 +34,6 @@ append_json_uint_value(char **output, const char *name, unsigned int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%u"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -44,10 +41,9 @@ append_json_uint_value(char **output, const char *name, unsigned int value)
 int
 append_json_int_value(char **output, const char *name, int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + JSON_APPEND_LEN*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%d"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's numeric format failed to add. "
@@ -55,8 +51,6 @@ append_json_int_value(char **output, const char *name, int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%d"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -64,10 +58,9 @@ append_json_int_value(char **output, const char *name, int value)
 int
 append_json_str_value(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("\"%s\""),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's string format failed to add. "
@@ -75,8 +68,6 @@ append_json_str_value(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("\"%s\""),
-			JSON_APPEND_COMMA(len), name, val);
 	return SPPWK_RET_OK;
 }
 
@@ -88,10 +79,9 @@ append_json_str_value(char **output, const char *name, const char *val)
 int
 append_json_array_brackets(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_ARRAY,
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's square bracket failed to add. "
@@ -99,8 +89,6 @@ append_json_array_brackets(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_ARRAY,
-			JSON_APPEND_COMMA(len), name, val);
 	return SPPWK_RET_OK;
 }
 
@@ -115,10 +103,10 @@ append_json_array_brackets(char **output, const char *name, const char *val)
 int
 append_json_block_brackets(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	*output = spp_strbuf_appendf(*output, name[0] == '\0' ?
+			JSON_APPEND_BLOCK_NONAME : JSON_APPEND_BLOCK,
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's curly bracket failed to add. "
@@ -126,11 +114,5 @@ append_json_block_brackets(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
-	if (name[0] == '\0')
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK_NONAME,
-				JSON_APPEND_COMMA(len), name, val);
-	else
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK,
-				JSON_APPEND_COMMA(len), name, val);
 	return SPPWK_RET_OK;
 }
@@ -11,9 +11,6 @@
 #include "return_codes.h"
 #include "string_buffer.h"
 
-/* TODO(yasufum) revise name considering the usage. */
-#define JSON_APPEND_LEN 16
-
 /* Add comma at the end of JSON statement, or do nothing. */
 #define JSON_APPEND_COMMA(flg)    ((flg)?", ":"")
 
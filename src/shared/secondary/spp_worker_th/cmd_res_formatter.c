@@ -376,7 +376,7 @@ append_response_list_value(char **output,
 	}
 
 	for (i = 0; responses[i].tag_name[0] != '\0'; i++) {
-		tmp_buff[0] = '\0';
+		spp_strbuf_clear(tmp_buff);
 		ret = responses[i].func(responses[i].tag_name, &tmp_buff, tmp);
 		if (unlikely(ret < SPPWK_RET_OK)) {
 			spp_strbuf_free(tmp_buff);
@@ -402,7 +402,7 @@ append_response_list_value(char **output,
 		}
 
 		*output = spp_strbuf_append(*output, tmp_buff,
-				strlen(tmp_buff));
+				spp_strbuf_len(tmp_buff));
 		if (unlikely(*output == NULL)) {
 			spp_strbuf_free(tmp_buff);
 			RTE_LOG(ERR, WK_CMD_RES_FMT,
@@ -445,7 +445,7 @@ append_command_results_value(const char *name, char **output,
 	}
 
 	for (i = 0; i < num; i++) {
-		tmp_buff1[0] = '\0';
+		spp_strbuf_clear(tmp_buff1);
 
 		/* Setup key-val pair such as `"result": "success"` */
 		ret = append_response_list_value(&tmp_buff1,
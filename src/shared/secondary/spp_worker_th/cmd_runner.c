@@ -199,7 +199,7 @@ send_decode_error_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 				"Failed to send decode error response.\n");
@@ -282,7 +282,7 @@ send_result_spp_ctl(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 			"Failed to send command result response.\n");
@@ -20,17 +20,40 @@
 /* Num of entries of ops_list in vf_cmd_runner.c. */
 #define NOF_STAT_OPS 8
 
-/* Classifier for MAC addresses. */
-struct mac_classifier {
-	struct rte_hash *cls_tbl;  /* Hash table for MAC classification. */
+/**
+ * ID of MARK action of flow rules for classifying packets to a TX port by
+ * NIC. It is encoded from the TX port as
+ *   bit 28-31: type of port plus 1
+ *   bit 16-27: queue number
+ *   bit 0-15:  port number
+ * For example, `ring:1` is 0x20000001 and `phy:0nq1` is 0x10010000.
+ */
+#define CLS_FLOW_MARK_ID(iface_type, iface_no, queue_no) \
+	((((uint32_t)(iface_type) + 1) << 28) | \
+	 (((uint32_t)(queue_no) & 0xfff) << 16) | \
+	 ((uint32_t)(iface_no) & 0xffff))
+
+/* ID of TX port without any entry of classifier table, never marked. */
+#define CLS_FLOW_MARK_NONE 0
+
+/* Key of classifier table, destination MAC address in the VLAN. */
+struct cls_mac_key {
+	uint16_t vid;
+	struct rte_ether_addr mac;
+};
+
+/**
+ * Classifier for a VLAN, used for packets not found in classifier table
+ * such as multicast or unknown unicast.
+ */
+struct vlan_classifier {
+	int default_cls_idx;  /* Default index for classification. */
 	int nof_cls_ports;  /* Num of ports classified validly. */
 	/**
-	 * Ports for classification.
-	 * For multi-queue case, size of ports should be
-	 * RTE_MAX_QUEUES_PER_PORT. RTE_MAX_ETHPORTS is not enough.
+	 * Ports for flooding multicast packets. It is allocated for TX ports
+	 * of the classifier.
 	 */
-	int cls_ports[RTE_MAX_QUEUES_PER_PORT];
-	int default_cls_idx;  /* Default index for classification. */
+	int cls_ports[];
 };
 
 /* Attirbutes of port for classification. */
@@ -43,13 +66,18 @@ struct cls_port_info {
 	uint16_t ethdev_port_id;  /* Ethdev port ID. */
 	uint16_t nof_pkts;  /* Number of packets in pkts[]. */
 	struct rte_mbuf *pkts[MAX_PKT_BURST];  /* packets to be classified. */
+	uint64_t mac_addr;  /* MAC address registered in tables, or 0. */
+	uint16_t vid;  /* VID registered with `mac_addr`. */
 };
 
 /* classifier component information */
 struct cls_comp_info {
 	char name[STR_LEN_NAME];  /* component name */
 	int mac_addr_entry;  /* mac address entry flag */
-	struct mac_classifier *mac_clfs[NOF_VLAN];  /* classifiers per VLAN. */
+	struct rte_hash *mac_tbl;  /* (VID, MAC) to index of TX port. */
+	struct rte_hash *vlan_tbl;  /* VID to vlan_classifier. */
+	/* Classifier of untagged, used as general default. */
+	struct vlan_classifier *untagged_cls;
 	int nof_tx_ports;  /* Number of TX ports info entries. */
 	/* Classifier has one RX port and several TX ports. */
 	struct cls_port_info rx_port_i;  /* RX port info classified. */
@@ -59,22 +87,13 @@ struct cls_comp_info {
 	 * RTE_MAX_QUEUES_PER_PORT. RTE_MAX_ETHPORTS is not enough.
 	 */
 	struct cls_port_info tx_ports_i[RTE_MAX_QUEUES_PER_PORT];
+	/* IDs of MARK action of TX ports, packed to be scanned fast. */
+	uint32_t tx_mark_ids[RTE_MAX_QUEUES_PER_PORT];
 };
 
 int add_core(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
 
-/* Release instance of mac classifier. */
-static inline void
-free_mac_classifier(struct mac_classifier *mac_clf)
-{
-	if (mac_clf == NULL)
-		return;
-	if (mac_clf->cls_tbl != NULL)
-		rte_hash_free(mac_clf->cls_tbl);
-	rte_free(mac_clf);
-}
-
 int exec_one_cmd(const struct sppwk_cmd_attrs *cmd);
 
 /**
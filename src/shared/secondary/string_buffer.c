@@ -2,6 +2,8 @@
  * Copyright(c) 2017-2018 Nippon Telegraph and Telephone Corporation
  */
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -12,11 +14,27 @@
 
 #define RTE_LOGTYPE_SPP_STRING_BUFF RTE_LOGTYPE_USER1
 
+/*
+ * Header placed in front of message buffer. Length is kept in it not to
+ * count the string each time appending to the buffer.
+ */
+struct strbuf_hdr {
+	size_t capacity;
+	size_t len;
+};
+
+/* get header of message buffer */
+static inline struct strbuf_hdr *
+strbuf_get_hdr(const char *strbuf)
+{
+	return (struct strbuf_hdr *)(strbuf - sizeof(struct strbuf_hdr));
+}
+
 /* get message buffer capacity */
 static inline size_t
 strbuf_get_capacity(const char *strbuf)
 {
-	return *((const size_t *)(strbuf - sizeof(size_t)));
+	return strbuf_get_hdr(strbuf)->capacity;
 }
 
 /* re-allocate message buffer */
@@ -24,6 +42,7 @@ static inline char*
 strbuf_reallocate(char *strbuf, size_t required_len)
 {
 	size_t new_cap = strbuf_get_capacity(strbuf) * 2;
+	size_t len = spp_strbuf_len(strbuf);
 	char *new_strbuf = NULL;
 
 	while (unlikely(new_cap <= required_len))
@@ -33,7 +52,8 @@ strbuf_reallocate(char *strbuf, size_t required_len)
 	if (unlikely(new_strbuf == NULL))
 		return NULL;
 
-	strcpy(new_strbuf, strbuf);
+	memcpy(new_strbuf, strbuf, len + 1);
+	strbuf_get_hdr(new_strbuf)->len = len;
 	spp_strbuf_free(strbuf);
 
 	return new_strbuf;
@@ -43,17 +63,20 @@ strbuf_reallocate(char *strbuf, size_t required_len)
 char*
 spp_strbuf_allocate(size_t capacity)
 {
-	char *buf = (char *)malloc(capacity + sizeof(size_t));
+	struct strbuf_hdr *hdr;
+	char *buf = (char *)malloc(capacity + sizeof(struct strbuf_hdr));
 	if (unlikely(buf == NULL))
 		return NULL;
 
-	memset(buf, 0x00, capacity + sizeof(size_t));
-	*((size_t *)buf) = capacity;
+	memset(buf, 0x00, capacity + sizeof(struct strbuf_hdr));
+	hdr = (struct strbuf_hdr *)buf;
+	hdr->capacity = capacity;
+	hdr->len = 0;
 	RTE_LOG(DEBUG, SPP_STRING_BUFF,
 			";alloc  ; addr=%p; size=%lu; str= ; len=0;\n",
-			buf + sizeof(size_t), capacity);
+			buf + sizeof(struct strbuf_hdr), capacity);
 
-	return buf + sizeof(size_t);
+	return buf + sizeof(struct strbuf_hdr);
 }
 
 /* free message buffer */
@@ -65,17 +88,32 @@ spp_strbuf_free(char *strbuf)
 				";free   ; addr=%p; size=%lu; "
 				"str=%s; len=%lu;\n",
 				strbuf, strbuf_get_capacity(strbuf),
-				strbuf, strlen(strbuf));
-		free(strbuf - sizeof(size_t));
+				strbuf, spp_strbuf_len(strbuf));
+		free(strbuf - sizeof(struct strbuf_hdr));
 	}
 }
 
+/* get length of message in buffer */
+size_t
+spp_strbuf_len(const char *strbuf)
+{
+	return strbuf_get_hdr(strbuf)->len;
+}
+
+/* clear message in buffer */
+void
+spp_strbuf_clear(char *strbuf)
+{
+	strbuf_get_hdr(strbuf)->len = 0;
+	*strbuf = '\0';
+}
+
 /* append message to buffer */
 char*
 spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 {
 	size_t cap = strbuf_get_capacity(strbuf);
-	size_t len = strlen(strbuf);
+	size_t len = spp_strbuf_len(strbuf);
 	char *new_strbuf = strbuf;
 
 	if (unlikely(len + append_len >= cap)) {
@@ -86,10 +124,49 @@ spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 
 	memcpy(new_strbuf + len, append, append_len);
 	*(new_strbuf + len + append_len) = '\0';
+	strbuf_get_hdr(new_strbuf)->len = len + append_len;
 	RTE_LOG(DEBUG, SPP_STRING_BUFF,
 			";append ; addr=%p; size=%lu; str=%s; len=%lu;\n",
 			new_strbuf, strbuf_get_capacity(new_strbuf),
-			new_strbuf, strlen(new_strbuf));
+			new_strbuf, len + append_len);
+
+	return new_strbuf;
+}
+
+/* append formatted message to buffer */
+char*
+spp_strbuf_appendf(char *strbuf, const char *format, ...)
+{
+	size_t cap = strbuf_get_capacity(strbuf);
+	size_t len = spp_strbuf_len(strbuf);
+	char *new_strbuf = strbuf;
+	va_list ap;
+	int ret;
+
+	/* Format into the rest of buffer, and retry once if it is short. */
+	va_start(ap, format);
+	ret = vsnprintf(strbuf + len, cap - len, format, ap);
+	va_end(ap);
+	if (unlikely(ret < 0)) {
+		strbuf[len] = '\0';
+		return NULL;
+	}
+
+	if (unlikely(len + ret >= cap)) {
+		new_strbuf = strbuf_reallocate(strbuf, len + ret);
+		if (unlikely(new_strbuf == NULL))
+			return NULL;
+
+		va_start(ap, format);
+		vsnprintf(new_strbuf + len, ret + 1, format, ap);
+		va_end(ap);
+	}
+
+	strbuf_get_hdr(new_strbuf)->len = len + ret;
+	RTE_LOG(DEBUG, SPP_STRING_BUFF,
+			";appendf; addr=%p; size=%lu; str=%s; len=%lu;\n",
+			new_strbuf, strbuf_get_capacity(new_strbuf),
+			new_strbuf, len + ret);
 
 	return new_strbuf;
 }
@@ -98,9 +175,10 @@ spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 char*
 spp_strbuf_remove_front(char *strbuf, size_t remove_len)
 {
-	size_t len = strlen(strbuf);
+	size_t len = spp_strbuf_len(strbuf);
 	size_t new_len = len - remove_len;
 
+	strbuf_get_hdr(strbuf)->len = new_len;
 	if (likely(new_len == 0)) {
 		*strbuf = '\0';
 		return strbuf;
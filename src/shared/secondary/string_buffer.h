@@ -52,6 +52,45 @@ void spp_strbuf_free(char *strbuf);
  */
 char *spp_strbuf_append(char *strbuf, const char *append, size_t append_len);
 
+/**
+ * append formatted string to buffer.
+ *
+ * @param strbuf
+ *  destination string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ * @param format
+ *  format string of printf.
+ *
+ * @return if "strbuf" has enough space to append, returns "strbuf"
+ *         else returns a new pointer to the allocated memory.
+ */
+char *spp_strbuf_appendf(char *strbuf, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+/**
+ * get length of string in buffer.
+ *
+ * Length is kept in the buffer and updated by the functions of this file,
+ * so it should not be written directly such as `strbuf[0] = '\0'`.
+ *
+ * @param strbuf
+ *  target string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ *
+ * @return
+ *  length of string without null char.
+ */
+size_t spp_strbuf_len(const char *strbuf);
+
+/**
+ * clear string in buffer without releasing memory.
+ *
+ * @param strbuf
+ *  target string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ */
+void spp_strbuf_clear(char *strbuf);
+
 /**
  * remove string from front.
  *
@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <pthread.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include "shared/shm_stats.h"
+
+#define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
+
+/* Segment of this process and function to fill it. */
+static struct shm_stats *shm_stats;
+static shm_stats_collect_t shm_stats_collect;
+static uint64_t interval_tsc;
+static uint64_t eth_interval_tsc;
+
+int
+shm_stats_init(const char *proc_name, int client_id,
+		shm_stats_collect_t collect)
+{
+	const struct rte_memzone *mz;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+
+	/*
+	 * Version is included in the name, so that a segment reserved by
+	 * older process which has different layout is not reused.
+	 */
+	snprintf(mz_name, sizeof(mz_name), SHM_STATS_MZ_PREFIX "v%d_%s_%d",
+			SHM_STATS_VERSION, proc_name, client_id);
+
+	mz = rte_memzone_lookup(mz_name);
+	if (mz == NULL)
+		mz = rte_memzone_reserve(mz_name, sizeof(*shm_stats),
+				rte_socket_id(), NO_FLAGS);
+	if (mz == NULL) {
+		RTE_LOG(ERR, SHARED, "Cannot reserve stats segment '%s'\n",
+				mz_name);
+		return -1;
+	}
+	if (mz->len < sizeof(*shm_stats)) {
+		RTE_LOG(ERR, SHARED, "Stats segment '%s' is too small\n",
+				mz_name);
+		return -1;
+	}
+
+	shm_stats = mz->addr;
+	shm_stats_collect = collect;
+	interval_tsc = (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S *
+			SHM_STATS_INTERVAL_US;
+	eth_interval_tsc = (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S *
+			SHM_STATS_ETH_INTERVAL_US;
+
+	/* Keep it odd while initializing not to be read. */
+	shm_stats->seq |= 1;
+	rte_smp_wmb();
+	shm_stats->magic = SHM_STATS_MAGIC;
+	shm_stats->version = SHM_STATS_VERSION;
+	snprintf(shm_stats->proc_name, sizeof(shm_stats->proc_name), "%s",
+			proc_name);
+	shm_stats->client_id = client_id;
+	shm_stats->pid = getpid();
+	shm_stats->tsc_hz = rte_get_tsc_hz();
+	shm_stats->update_tsc = 0;
+	shm_stats->nof_ports = 0;
+	shm_stats->nof_lcores = 0;
+	shm_stats->nof_comps = 0;
+	shm_stats->eth_update_tsc = 0;
+	shm_stats->nof_eths = 0;
+	rte_smp_wmb();
+	shm_stats->seq++;
+
+	RTE_LOG(INFO, SHARED, "Publish stats in '%s'\n", mz_name);
+	return 0;
+}
+
+void
+shm_stats_update(void)
+{
+	if (shm_stats == NULL)
+		return;
+
+	shm_stats->seq++;
+	rte_smp_wmb();
+
+	shm_stats->nof_ports = 0;
+	shm_stats->nof_lcores = 0;
+	shm_stats->nof_comps = 0;
+	shm_stats_collect(shm_stats);
+	shm_stats->update_tsc = rte_rdtsc();
+
+	rte_smp_wmb();
+	shm_stats->seq++;
+}
+
+int
+shm_stats_eth_due(struct shm_stats *st)
+{
+	uint64_t now = rte_rdtsc();
+
+	if (st->eth_update_tsc != 0 &&
+			now - st->eth_update_tsc < eth_interval_tsc)
+		return 0;
+
+	st->eth_update_tsc = now;
+	st->nof_eths = 0;
+	return 1;
+}
+
+void
+shm_stats_update_periodic(void)
+{
+	if (shm_stats == NULL ||
+			rte_rdtsc() - shm_stats->update_tsc < interval_tsc)
+		return;
+	shm_stats_update();
+}
+
+static void *
+shm_stats_thread(void *arg __rte_unused)
+{
+	while (1) {
+		shm_stats_update();
+		usleep(SHM_STATS_INTERVAL_US);
+	}
+	return NULL;
+}
+
+int
+shm_stats_start_thread(void)
+{
+	pthread_t tid;
+	int ret;
+
+	if (shm_stats == NULL)
+		return -1;
+
+	ret = rte_ctrl_thread_create(&tid, "spp-stats", NULL,
+			shm_stats_thread, NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, SHARED, "Cannot create stats thread\n");
+		return -1;
+	}
+	pthread_detach(tid);
+
+	return 0;
+}
+
+int
+shm_stats_read(const struct shm_stats *st, struct shm_stats *snap)
+{
+	unsigned int i;
+	uint32_t seq;
+
+	if (st->magic != SHM_STATS_MAGIC || st->version != SHM_STATS_VERSION)
+		return -1;
+
+	for (i = 0; i < SHM_STATS_READ_RETRY; i++) {
+		seq = st->seq;
+		if (seq & 1) {
+			rte_pause();
+			continue;
+		}
+		rte_smp_rmb();
+
+		memcpy(snap, st, sizeof(*snap));
+
+		rte_smp_rmb();
+		if (st->seq == seq)
+			return 0;
+	}
+
+	return -1;
+}
+
+/* Args of walk_shm_stats() given to rte_memzone_walk(). */
+struct shm_stats_walk_arg {
+	void (*func)(const struct shm_stats *st, void *arg);
+	void *arg;
+	int nof_found;
+};
+
+static void
+walk_shm_stats(const struct rte_memzone *mz, void *arg)
+{
+	struct shm_stats_walk_arg *walk_arg = arg;
+
+	if (strncmp(mz->name, SHM_STATS_MZ_PREFIX,
+				strlen(SHM_STATS_MZ_PREFIX)) != 0 ||
+			mz->len < sizeof(struct shm_stats))
+		return;
+
+	walk_arg->func(mz->addr, walk_arg->arg);
+	walk_arg->nof_found++;
+}
+
+int
+shm_stats_walk(void (*func)(const struct shm_stats *st, void *arg),
+		void *arg)
+{
+	struct shm_stats_walk_arg walk_arg = { func, arg, 0 };
+
+	rte_memzone_walk(walk_shm_stats, &walk_arg);
+	return walk_arg.nof_found;
+}
@@ -0,0 +1,178 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_SHM_STATS_H__
+#define __SHARED_SHM_STATS_H__
+
+/**
+ * @file
+ * Statistics segment on shared memory.
+ *
+ * Each of SPP processes publishes counters of ports, lcores and components
+ * into its own memzone named `spp_stats_v[VERSION]_[PROC_NAME]_[CLIENT_ID]`.
+ * Counters are updated periodically under a sequence lock, so that readers
+ * in other processes can take a consistent snapshot at any time without
+ * sending `status` command or blocking the writer.
+ */
+
+#include <rte_ethdev.h>
+#include <rte_memzone.h>
+#include "shared/common.h"
+
+#define SHM_STATS_MZ_PREFIX "spp_stats_"
+#define SHM_STATS_MAGIC 0x53505053  /* "SPPS" */
+
+/* Incremented if layout of struct shm_stats is changed. */
+#define SHM_STATS_VERSION 2
+
+/* Interval of updating the segment. */
+#define SHM_STATS_INTERVAL_US 100000  /* micro sec */
+
+/*
+ * Interval of sampling HW counters of ethdevs. It is longer than updating
+ * the segment because reading them can be slow on some of NICs.
+ */
+#define SHM_STATS_ETH_INTERVAL_US 1000000  /* micro sec */
+
+/* Max num of retrying to read while the segment is updated. */
+#define SHM_STATS_READ_RETRY 1000
+
+#define SHM_STATS_NAME_LEN 32
+#define SHM_STATS_MAX_PORTS (RTE_MAX_ETHPORTS + MAX_CLIENT)
+#define SHM_STATS_MAX_COMPS RTE_MAX_LCORE
+
+/* Max num of xstats of drops and errors published for an ethdev. */
+#define SHM_STATS_MAX_XSTATS 16
+
+/* Counters of a port, `port_type` is enum port_type. */
+struct shm_port_stats {
+	int32_t port_type;
+	int32_t port_id;
+	struct stats stats;
+};
+
+/*
+ * Counters of an lcore. `stats` is a sum of ports or components on the
+ * lcore, and `busy_polls` is the num of polls received any packets.
+ */
+struct shm_lcore_stats {
+	uint32_t lcore_id;
+	uint64_t polls;
+	uint64_t busy_polls;
+	struct stats stats;
+};
+
+/* Counters of a component of spp_vf or spp_mirror. */
+struct shm_comp_stats {
+	char name[SHM_STATS_NAME_LEN];
+	char type[SHM_STATS_NAME_LEN];
+	uint32_t lcore_id;
+	struct stats stats;
+};
+
+/* Extended counter of an ethdev such as `rx_missed_errors`. */
+struct shm_xstat {
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	uint64_t value;
+};
+
+/*
+ * HW counters of an ethdev. Per queue counters in `stats` are valid for
+ * `nof_rxq` and `nof_txq` queues. Only xstats of drops and errors are
+ * included to keep it small.
+ */
+struct shm_eth_stats {
+	uint16_t port_id;
+	uint16_t nof_rxq;
+	uint16_t nof_txq;
+	uint16_t nof_xstats;
+	struct rte_eth_stats stats;
+	struct shm_xstat xstats[SHM_STATS_MAX_XSTATS];
+};
+
+struct shm_stats {
+	/* Header which is not changed after created. */
+	uint32_t magic;
+	uint32_t version;
+	char proc_name[SHM_STATS_NAME_LEN];
+	int32_t client_id;
+	int32_t pid;
+	uint64_t tsc_hz;
+
+	/* Sequence lock, odd while counters are updated. */
+	volatile uint32_t seq;
+
+	uint64_t update_tsc;  /* TSC of the last update. */
+	uint32_t nof_ports;
+	uint32_t nof_lcores;
+	uint32_t nof_comps;
+	struct shm_port_stats ports[SHM_STATS_MAX_PORTS];
+	struct shm_lcore_stats lcores[RTE_MAX_LCORE];
+	struct shm_comp_stats comps[SHM_STATS_MAX_COMPS];
+
+	/* HW counters sampled every SHM_STATS_ETH_INTERVAL_US. */
+	uint64_t eth_update_tsc;
+	uint32_t nof_eths;
+	struct shm_eth_stats eths[RTE_MAX_ETHPORTS];
+} __rte_cache_aligned;
+
+/*
+ * Function filling counters of the process to the segment. It is called
+ * while the segment is locked, and counts of entries are reset before.
+ */
+typedef void (*shm_stats_collect_t)(struct shm_stats *st);
+
+/**
+ * Reserve the segment of this process, or reuse it if it is remained from
+ * the previous process of the same name and ID.
+ *
+ * @param proc_name Name of process such as `nfv`.
+ * @param client_id Client ID of the process, or 0 for spp_primary.
+ * @param collect Function filling counters of the process.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int shm_stats_init(const char *proc_name, int client_id,
+		shm_stats_collect_t collect);
+
+/* Update the segment once. */
+void shm_stats_update(void);
+
+/*
+ * Check if HW counters of ethdevs should be sampled in this update. If so,
+ * entries of the last sampling are cleared and 1 is returned. Called from
+ * a collect function, and previous entries are kept if 0 is returned.
+ */
+int shm_stats_eth_due(struct shm_stats *st);
+
+/*
+ * Update the segment if SHM_STATS_INTERVAL_US is passed from the last
+ * update. It is for a process polling commands in its master thread.
+ */
+void shm_stats_update_periodic(void);
+
+/*
+ * Update the segment every SHM_STATS_INTERVAL_US in a control thread. It
+ * is for a process blocked while waiting for commands.
+ */
+int shm_stats_start_thread(void);
+
+/**
+ * Take a consistent snapshot of the segment.
+ *
+ * @param st Segment published by a process.
+ * @param snap Copy of the segment.
+ * @return 0 if succeeded, or -1 if version is unknown or it is updated
+ *   too frequently to be read.
+ */
+int shm_stats_read(const struct shm_stats *st, struct shm_stats *snap);
+
+/**
+ * Call `func` for each of segments published by SPP processes.
+ *
+ * @return Num of segments found.
+ */
+int shm_stats_walk(void (*func)(const struct shm_stats *st, void *arg),
+		void *arg);
+
+#endif
@@ -5,7 +5,6 @@ import eventlet
 eventlet.monkey_patch()
 
 import argparse
-import errno
 import json
 import logging
 import os
@@ -20,6 +19,11 @@ LOG = logging.getLogger(__name__)
 
 MSG_SIZE = 4096
 
+# Terminator of a command sent to spp_primary. It receives a command until
+# the terminator because a large one, such as bulk flow rules, can be split
+# into several segments.
+PRI_CMD_TERMINATOR = '\0'
+
 # relative path of `cpu_layout.py`
 CPU_LAYOUT_TOOL = 'tools/helpers/cpu_layout.py'
 
@@ -92,41 +96,32 @@ class Controller(object):
             self.procs[proc.id] = proc
 
     @staticmethod
-    def _continue_recv(conn):
-        try:
-            # must set non-blocking to recieve remining data not to happen
-            # blocking here.
-            # NOTE: usually MSG_DONTWAIT flag is used for this purpose but
-            # this flag is not supported under eventlet.
-            conn.setblocking(False)
-            data = b""
-            while True:
-                try:
-                    rcv_data = conn.recv(MSG_SIZE)
-                    data += rcv_data
-                    if len(rcv_data) < MSG_SIZE:
-                        break
-                except socket.error as e:
-                    if e.args[0] == errno.EAGAIN:
-                        # OK, no data remining. this happens when recieve data
-                        # length is just multiple of MSG_SIZE.
-                        break
-                    raise e
-            return data
-        finally:
-            conn.setblocking(True)
+    def _recv_reply(conn):
+        """Receive a reply until it is decoded as a whole of JSON.
+
+        A reply is not terminated with any of delimiter, and can be split
+        into several segments if it is large. Continue to receive until
+        the data is completed as JSON or the connection is closed.
+        """
+        data = b""
+        while True:
+            rcv_data = conn.recv(MSG_SIZE)
+            if not rcv_data:
+                return data
+            data += rcv_data
+            try:
+                json.loads(data.decode().replace('\0', ''))
+                return data
+            except ValueError:
+                # Not completed yet, or cut in a multibyte character.
+                continue
 
     @staticmethod
-    def _send_command(conn, command):
+    def _send_command(conn, command, terminator=""):
         data = None
         try:
-            conn.sendall(command.encode())
-            data = conn.recv(MSG_SIZE)
-            if data and len(data) == MSG_SIZE:
-                # could not receive data at once. recieve remining data.
-                data += Controller._continue_recv(conn)
-            if data:
-                data = data.decode()
+            conn.sendall((command + terminator).encode())
+            data = Controller._recv_reply(conn).decode() or None
         except Exception as e:
             LOG.info("Error: {}".format(e))
         return data
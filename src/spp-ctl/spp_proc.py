@@ -107,7 +107,8 @@ def exec_command(func):
             command = func(self, *args, **kwargs)
             LOG.info("%s(%d) command executed: %s", self.type, self.id,
                      command)
-            data = spp_ctl.Controller._send_command(self.conn, command)
+            data = spp_ctl.Controller._send_command(
+                self.conn, command, self.cmd_terminator)
             if data is None:
                 raise RuntimeError("%s(%d): %s: no-data returned" %
                                    (self.type, self.id, command))
@@ -124,6 +125,8 @@ class SppProc(object):
         # for each process.
         self.sem = eventlet.semaphore.Semaphore(value=1)
         self.conn = conn
+        # Only spp_primary expects a command to be terminated.
+        self.cmd_terminator = ""
 
     @staticmethod
     def _decode_reply(data):
@@ -260,8 +263,19 @@ class NfvProc(SppProc):
         return "del {port}".format(**locals())
 
     @exec_command
-    def patch_add(self, src_port, dst_port):
-        return "patch {src_port} {dst_port}".format(**locals())
+    def patch_add(self, src_port, dst_port, burst=None, drain=None,
+                  fanout=None, mode=None):
+        cmd = "patch {src_port} {dst_port}".format(**locals())
+        if fanout is not None:
+            for port in fanout:
+                cmd += " fanout {}".format(port)
+        if mode is not None:
+            cmd += " mode {}".format(mode)
+        if burst is not None:
+            cmd += " burst {}".format(burst)
+        if drain is not None:
+            cmd += " drain {}".format(drain)
+        return cmd
 
     @exec_command
     def patch_reset(self):
@@ -284,6 +298,7 @@ class PrimaryProc(SppProc):
 
     def __init__(self, conn):
         super(PrimaryProc, self).__init__(TYPE_PRIMARY, ID_PRIMARY, conn)
+        self.cmd_terminator = spp_ctl.PRI_CMD_TERMINATOR
 
     @exec_command
     def get_status(self):
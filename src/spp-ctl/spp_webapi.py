@@ -19,6 +19,10 @@ VF_PORT_TYPES = ["phy", "vhost", "ring"] # TODO(yasufum) add other ports
 
 LOG = logging.getLogger(__name__)
 
+# Max length of flow command of bulk rules, which is less than receive
+# buffer of spp_primary.
+FLOW_BULK_MSG_SIZE = 16384
+
 
 class KeyRequired(bottle.HTTPError):
 
@@ -456,10 +460,23 @@ class V1NFVHandler(BaseHandler):
                 raise KeyRequired(key)
         self._validate_port(body['src'])
         self._validate_port(body['dst'])
+        for key in ['burst', 'drain']:
+            if key in body:
+                if type(body[key]) is not int or body[key] < 0:
+                    raise KeyInvalid(key, body[key])
+        if 'fanout' in body:
+            if type(body['fanout']) is not list:
+                raise KeyInvalid('fanout', body['fanout'])
+            for port in body['fanout']:
+                self._validate_port(port)
+        if 'mode' in body and body['mode'] not in ['copy', 'hash']:
+            raise KeyInvalid('mode', body['mode'])
 
     def nfv_patch_add(self, proc, body):
         self._validate_nfv_patch(body)
-        proc.patch_add(body['src'], body['dst'])
+        proc.patch_add(body['src'], body['dst'],
+                       body.get('burst'), body.get('drain'),
+                       body.get('fanout'), body.get('mode'))
 
     def nfv_patch_del(self, proc):
         proc.patch_reset()
@@ -607,6 +624,12 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
                    'DELETE', callback=self.delete_flow_all_destroy)
         self.route('/<rule_id:int>/port_id/<port_id:int>',
                    'DELETE', callback=self.delete_flow_destroy)
+        self.route('/port_id/<port_id:int>',
+                   'GET', callback=self.get_flow_list)
+        self.route('/port_id/<port_id:int>/bulk',
+                   'POST', callback=self.post_flow_bulk_create)
+        self.route('/port_id/<port_id:int>/bulk',
+                   'DELETE', callback=self.delete_flow_bulk_destroy)
 
     def post_flow_validate(self, port_id, body):
         self._check_request_body(body)
@@ -636,7 +659,128 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
         proc = self._get_proc()
         return proc.flow(command)
 
+    def get_flow_list(self, port_id):
+        """Get a page of flow rules from `start` of rule ID."""
+        query = bottle.request.query
+        params = {}
+        for key in ["start", "limit"]:
+            if key in query:
+                try:
+                    params[key] = int(query.get(key))
+                    if params[key] < 0:
+                        raise ValueError
+                except ValueError:
+                    raise KeyInvalid(key, query.get(key))
+
+        command = "flow list phy:{0} {1}".format(
+            port_id, params.get("start", 0))
+        if "limit" in params:
+            command += " {0}".format(params["limit"])
+
+        proc = self._get_proc()
+        return proc.flow(command)
+
+    def post_flow_bulk_create(self, port_id, body):
+        """Create flow rules, or nothing if one of them is failed.
+
+        Rules are sent in several commands if it is too large for a
+        message. Rules created with previous commands are destroyed if
+        failed.
+        """
+        self._check_request_body_required_param(body, "rules", list)
+        rules = body.get("rules")
+        if len(rules) == 0:
+            raise KeyInvalid("rules", rules)
+        for rule in rules:
+            if type(rule) != dict:
+                raise KeyInvalid("rules", rules)
+            self._check_flow_rule(rule)
+
+        proc = self._get_proc()
+        rule_ids = []
+        for command in self._gen_flow_bulk_commands(
+                "flow create phy:{0}".format(port_id),
+                [self._gen_flow_rule(rule) for rule in rules]):
+            res = proc.flow(command)
+            if res.get("result") != "success":
+                if len(rule_ids) > 0:
+                    self._destroy_flow_rules(proc, port_id, rule_ids)
+                return res
+
+            if "rule_ids" in res:
+                rule_ids.extend(res.get("rule_ids"))
+            else:
+                rule_ids.append(int(res.get("rule_id")))
+
+        return {"result": "success",
+                "message": "{0} flow rules created".format(len(rule_ids)),
+                "rule_ids": rule_ids}
+
+    def delete_flow_bulk_destroy(self, port_id):
+        """Destroy flow rules of IDs given as `rule_ids` in body."""
+        try:
+            body = json.loads(bottle.request.body.read().decode())
+        except Exception:
+            raise RequestJSONDecodeHTTPError()
+        LOG.info("body: %s", body)
+
+        self._check_request_body_required_param(body, "rule_ids", list)
+        rule_ids = body.get("rule_ids")
+        if len(rule_ids) == 0:
+            raise KeyInvalid("rule_ids", rule_ids)
+        for rule_id in rule_ids:
+            if type(rule_id) != int or rule_id < 0:
+                raise KeyInvalid("rule_ids", rule_ids)
+
+        proc = self._get_proc()
+        return self._destroy_flow_rules(proc, port_id, rule_ids)
+
+    def _destroy_flow_rules(self, proc, port_id, rule_ids):
+        """Destroy flow rules, and return the first failure if any."""
+        result = None
+        nof_destroyed = 0
+        for command in self._gen_flow_bulk_commands(
+                "flow destroy phy:{0}".format(port_id),
+                [str(rule_id) for rule_id in rule_ids]):
+            res = proc.flow(command)
+            if res.get("result") == "success":
+                nof_destroyed += len(command.split(" ")) - 3
+            elif result is None:
+                result = res
+
+        if result is None:
+            result = {"result": "success",
+                      "message": "{0} flow rules destroyed".format(
+                          nof_destroyed)}
+        return result
+
+    def _gen_flow_bulk_commands(self, prefix, args):
+        """Generate commands of `prefix` and `args` fitting in a message.
+
+        Size of a command is limited not to be exceeded the size of receive
+        buffer of spp_primary.
+        """
+        command = prefix
+        nof_args = 0
+        for arg in args:
+            if (nof_args > 0 and
+                    len(command) + len(arg) + 1 > FLOW_BULK_MSG_SIZE):
+                yield command
+                command = prefix
+                nof_args = 0
+            command += " " + arg
+            nof_args += 1
+        if nof_args > 0:
+            yield command
+
     def _create_flow_rule_command(self, port_id, rule, sub_command):
+        command = "flow {sub_command} {res_uid} {rule}"
+        return command.format(sub_command=sub_command,
+                              res_uid="phy:{0}".format(port_id),
+                              rule=self._gen_flow_rule(rule))
+
+    def _gen_flow_rule(self, rule):
+        """Generate attributes, pattern and actions of a rule."""
         attr_data = {}
         data = {}
 
@@ -664,12 +808,9 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
 
         attrs = attr_command.format(**attr_data)
 
-        command = "flow {sub_command} {res_uid} {attrs} "
-        command += "pattern {pattern} / end "
+        command = "{attrs} pattern {pattern} / end "
         command += "actions {actions} / end"
 
-        data["sub_command"] = sub_command
-        data["res_uid"] = "phy:{0}".format(port_id)
         data["attrs"] = attrs
         data["pattern"] = " / ".join(rule.get("pattern"))
         data["actions"] = " / ".join(rule.get("actions"))
@@ -686,8 +827,9 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
 
     def _check_request_body(self, body):
         self._check_request_body_required_param(body, "rule", dict)
-        rule = body.get("rule")
+        self._check_flow_rule(body.get("rule"))
 
+    def _check_flow_rule(self, rule):
         self._check_request_body_optional_param(rule, "group", int)
         self._check_request_body_optional_param(rule, "priority", int)
         self._check_request_body_required_param(rule, "direction", str)
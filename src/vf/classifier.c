@@ -14,6 +14,7 @@
 #include <rte_log.h>
 #include <rte_cycles.h>
 #include <rte_memcpy.h>
+#include <rte_prefetch.h>
 #include <rte_random.h>
 #include <rte_byteorder.h>
 #include <rte_per_lcore.h>
@@ -43,12 +44,20 @@
 #define DEFAULT_HASH_FUNC rte_jhash
 #endif
 
-/* Number of classifier table entry */
-#define NOF_CLS_TABLE_ENTRIES 128
+/* Default num of entries of classifier table of each classifier. */
+#define DEFAULT_CLS_TABLE_ENTRIES 4096
 
 /* Interval transmit burst packet if buffer is not filled. */
 #define DRAIN_TX_PACKET_INTERVAL 100  /* nano sec */
 
+/* Num of packets of which headers are prefetched ahead of classifying. */
+#define PREFETCH_OFFSET 8
+
+/* Packets of a burst are looked up at once. */
+#if MAX_PKT_BURST > RTE_HASH_LOOKUP_BULK_MAX
+#error "MAX_PKT_BURST must not be over RTE_HASH_LOOKUP_BULK_MAX"
+#endif
+
 /* VID of VLAN untagged */
 #define VLAN_UNTAGGED_VID 0x0fff
 
@@ -61,18 +70,72 @@ struct cls_mng_info {
 	volatile int ref_index;  /* Flag for ref side */
 	volatile int upd_index;  /* Flag for update side */
 	volatile int is_used;
+	struct stats stats;  /* Counters of received packets */
 };
 
 /* classifier information per lcore */
 struct cls_mng_info cls_mng_info_list[RTE_MAX_LCORE];
 
+/**
+ * Entries deleted from tables while updating. They are released after
+ * classifier is switched to another side, because it might be still
+ * referred by the classifier until then.
+ */
+struct cls_garbage {
+	int nof_mac_pos;
+	int32_t mac_pos[RTE_MAX_QUEUES_PER_PORT * 2];  /* Keys of mac_tbl. */
+	int nof_vlan_pos;
+	int32_t vlan_pos[RTE_MAX_QUEUES_PER_PORT * 2];  /* Keys of vlan_tbl. */
+	int nof_vlan_cls;
+	struct vlan_classifier *vlan_cls[RTE_MAX_QUEUES_PER_PORT * 2];
+};
+
+/* Garbage of updating, used only from the thread of commands. */
+static struct cls_garbage g_cls_garbage;
+
+/**
+ * Entries of tables before they are changed while updating, to be restored
+ * if updating is failed. `data` of a key or VID is NULL if it is not
+ * registered before.
+ */
+struct cls_undo {
+	int nof_macs;
+	struct cls_mac_key mac_keys[RTE_MAX_QUEUES_PER_PORT * 2];
+	void *mac_data[RTE_MAX_QUEUES_PER_PORT * 2];
+	int mac_found[RTE_MAX_QUEUES_PER_PORT * 2];
+	int nof_vlans;
+	uint16_t vids[RTE_MAX_QUEUES_PER_PORT * 2];
+	struct vlan_classifier *vlan_cls[RTE_MAX_QUEUES_PER_PORT * 2];
+	/* MAC address and VID of TX ports registered in tables. */
+	uint64_t port_mac_addrs[RTE_MAX_QUEUES_PER_PORT];
+	uint16_t port_vids[RTE_MAX_QUEUES_PER_PORT];
+};
+
+/* Undo log of updating, used only from the thread of commands. */
+static struct cls_undo g_cls_undo;
+
+/* Classify packets by MARK of NIC flow rules if it is 1. */
+static int g_flow_mark_mode;
+
+/* Num of entries of classifier table of each classifier. */
+static uint32_t g_cls_table_entries = DEFAULT_CLS_TABLE_ENTRIES;
+
 /* uninitialize classifier information. */
 static void
 clean_component_info(struct cls_comp_info *comp_info)
 {
-	int i;
-	for (i = 0; i < NOF_VLAN; ++i)
-		free_mac_classifier(comp_info->mac_clfs[i]);
+	const void *key;
+	void *data;
+	uint32_t next = 0;
+
+	if (comp_info->vlan_tbl != NULL) {
+		while (rte_hash_iterate(comp_info->vlan_tbl, &key, &data,
+				&next) >= 0)
+			rte_free(data);
+		rte_hash_free(comp_info->vlan_tbl);
+	}
+	if (comp_info->mac_tbl != NULL)
+		rte_hash_free(comp_info->mac_tbl);
 	memset(comp_info, 0, sizeof(struct cls_comp_info));
 }
 
@@ -253,53 +316,117 @@ is_used_mng_info(const struct cls_mng_info *mng_info)
 	return (mng_info != NULL && mng_info->is_used);
 }
 
-/* create mac classification instance. */
-static struct mac_classifier *
-create_mac_classification(void)
+/* create hash table for classifier, named as `prefix` and unique num. */
+static struct rte_hash *
+create_cls_table(const char *prefix, uint32_t entries, uint32_t key_len)
 {
-	struct mac_classifier *mac_cls;
+	struct rte_hash *tbl;
 	char hash_tab_name[HASH_TABLE_NAME_BUF_SZ];
-	struct rte_hash **mac_cls_tab;
-
-	mac_cls = (struct mac_classifier *)rte_zmalloc(
-			NULL, sizeof(struct mac_classifier), 0);
-
-	if (unlikely(mac_cls == NULL))
-		return NULL;
-
-	mac_cls->nof_cls_ports = 0;
-	mac_cls->default_cls_idx = -1;
-
-	mac_cls_tab = &mac_cls->cls_tbl;
 
 	/* make hash table name(require uniqueness between processes) */
-	sprintf(hash_tab_name, "cmtab_%07x%02hx", getpid(),
+	sprintf(hash_tab_name, "%s_%07x%02hx", prefix, getpid(),
 			rte_atomic16_add_return(&g_hash_table_count, 1));
 
-	RTE_LOG(INFO, VF_CLS, "Create table. name=%s, bufsz=%lu\n",
-			hash_tab_name, HASH_TABLE_NAME_BUF_SZ);
-
-	/* set hash creating parameters */
+	RTE_LOG(INFO, VF_CLS, "Create table. name=%s, bufsz=%lu, "
+			"entries=%u\n",
+			hash_tab_name, HASH_TABLE_NAME_BUF_SZ, entries);
+
+	/**
+	 * set hash creating parameters. Extendable buckets are used to
+	 * store entries up to `entries` even if keys are collided. Entries
+	 * are updated while classifier looks up the table without lock, and
+	 * keys deleted are not freed until released with
+	 * rte_hash_free_key_with_position().
+	 */
 	struct rte_hash_parameters hash_params = {
 			.name      = hash_tab_name,
-			.entries   = NOF_CLS_TABLE_ENTRIES,
-			.key_len   = sizeof(struct rte_ether_addr),
+			.entries   = entries,
+			.key_len   = key_len,
 			.hash_func = DEFAULT_HASH_FUNC,
 			.hash_func_init_val = 0,
 			.socket_id = rte_socket_id(),
+			.extra_flag = RTE_HASH_EXTRA_FLAGS_EXT_TABLE |
+				RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF |
+				RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL,
 	};
 
-	/* Create classifier table. */
-	*mac_cls_tab = rte_hash_create(&hash_params);
-	if (unlikely(*mac_cls_tab == NULL)) {
+	tbl = rte_hash_create(&hash_params);
+	if (unlikely(tbl == NULL))
 		RTE_LOG(ERR, VF_CLS,
-				"Cannot create mac classification table. "
+				"Cannot create classifier table. "
 				"name=%s\n", hash_tab_name);
-		rte_free(mac_cls);
+	return tbl;
+}
+
+/*
+ * Set ID of MARK action of the TX port. Packets marked with the ID are sent
+ * to the port only while it has an entry of classifier table, so that a
+ * deleted entry is not used by flow rules remained in NIC.
+ */
+static inline void
+set_tx_mark_id(struct cls_comp_info *cmp_info, int idx)
+{
+	const struct cls_port_info *cls_port = &cmp_info->tx_ports_i[idx];
+
+	if (cls_port->mac_addr == 0)
+		cmp_info->tx_mark_ids[idx] = CLS_FLOW_MARK_NONE;
+	else
+		cmp_info->tx_mark_ids[idx] = CLS_FLOW_MARK_ID(
+				cls_port->iface_type,
+				cls_port->iface_no_global,
+				cls_port->queue_no);
+}
+
+/* Get classifier of the VLAN, or NULL if it is not registered. */
+static inline struct vlan_classifier *
+get_vlan_classifier(const struct cls_comp_info *cmp_info, uint16_t vid)
+{
+	void *data;
+
+	if (vid == VLAN_UNTAGGED_VID)
+		return cmp_info->untagged_cls;
+
+	if (rte_hash_lookup_data(cmp_info->vlan_tbl, &vid, &data) < 0)
+		return NULL;
+	return data;
+}
+
+/* Get classifier of the VLAN, or create it if it is not registered. */
+static struct vlan_classifier *
+add_vlan_classifier(struct cls_comp_info *cmp_info, uint16_t vid,
+		int nof_tx_ports)
+{
+	int ret;
+	void *data;
+	struct vlan_classifier *vlan_cls;
+
+	if (rte_hash_lookup_data(cmp_info->vlan_tbl, &vid, &data) >= 0)
+		return data;
+
+	RTE_LOG(DEBUG, VF_CLS,
+			"Vlan classification is not registered."
+			" create. vid=%hu\n", vid);
+	vlan_cls = rte_zmalloc(NULL, sizeof(struct vlan_classifier) +
+			sizeof(int) * nof_tx_ports, 0);
+	if (unlikely(vlan_cls == NULL))
+		return NULL;
+
+	vlan_cls->nof_cls_ports = 0;
+	vlan_cls->default_cls_idx = -1;
+
+	ret = rte_hash_add_key_data(cmp_info->vlan_tbl, &vid, vlan_cls);
+	if (unlikely(ret < 0)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot add vlan classification. "
+				"ret=%d, vid=%hu\n", ret, vid);
+		rte_free(vlan_cls);
 		return NULL;
 	}
 
-	return mac_cls;
+	if (vid == VLAN_UNTAGGED_VID)
+		cmp_info->untagged_cls = vlan_cls;
+
+	return vlan_cls;
 }
 
 /* initialize classifier information. */
@@ -309,8 +436,8 @@ init_component_info(struct cls_comp_info *cmp_info,
 {
 	int ret = SPPWK_RET_NG;
 	int i;
-	struct mac_classifier *mac_cls;
-	struct rte_ether_addr eth_addr;
+	struct vlan_classifier *vlan_cls;
+	struct cls_mac_key key;
 	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
 	/* Classifier has one RX port and several TX ports. */
 	struct cls_port_info *cls_rx_port_info = &cmp_info->rx_port_i;
@@ -339,6 +466,16 @@ init_component_info(struct cls_comp_info *cmp_info,
 		cls_rx_port_info->nof_pkts = 0;
 	}
 
+	/* create tables, (VID, MAC) for classifier and VID for defaults */
+	RTE_BUILD_BUG_ON(sizeof(struct cls_mac_key) != sizeof(uint16_t) +
+			RTE_ETHER_ADDR_LEN);
+	cmp_info->mac_tbl = create_cls_table("cmtab", g_cls_table_entries,
+			sizeof(struct cls_mac_key));
+	cmp_info->vlan_tbl = create_cls_table("cvtab", NOF_VLAN,
+			sizeof(uint16_t));
+	if (unlikely(cmp_info->mac_tbl == NULL || cmp_info->vlan_tbl == NULL))
+		return SPPWK_RET_NG;
+
 	/* set tx */
 	cmp_info->nof_tx_ports = wk_comp_info->nof_tx;
 	cmp_info->mac_addr_entry = 0;
@@ -353,31 +490,28 @@ init_component_info(struct cls_comp_info *cmp_info,
 		cls_tx_ports_info[i].iface_no_global = tx_port->iface_no;
 		cls_tx_ports_info[i].ethdev_port_id = tx_port->ethdev_port_id;
 		cls_tx_ports_info[i].nof_pkts = 0;
+		cls_tx_ports_info[i].mac_addr = tx_port->cls_attrs.mac_addr;
+		cls_tx_ports_info[i].vid = vid;
+		set_tx_mark_id(cmp_info, i);
 
 		if (tx_port->cls_attrs.mac_addr == 0)
 			continue;
 
-		/* if mac classification is NULL, make instance */
-		if (unlikely(cmp_info->mac_clfs[vid] == NULL)) {
-			RTE_LOG(DEBUG, VF_CLS,
-					"Mac classification is not registered."
-					" create. vid=%hu\n", vid);
-			cmp_info->mac_clfs[vid] =
-					create_mac_classification();
-			if (unlikely(cmp_info->mac_clfs[vid] == NULL))
-				return SPPWK_RET_NG;
-		}
-		mac_cls = cmp_info->mac_clfs[vid];
+		/* if vlan classification is NULL, make instance */
+		vlan_cls = add_vlan_classifier(cmp_info, vid,
+				wk_comp_info->nof_tx);
+		if (unlikely(vlan_cls == NULL))
+			return SPPWK_RET_NG;
 
 		/* store active tx_port that associate with mac address */
-		mac_cls->cls_ports[mac_cls->nof_cls_ports++] = i;
+		vlan_cls->cls_ports[vlan_cls->nof_cls_ports++] = i;
 
 		/* mac address entry flag set */
 		cmp_info->mac_addr_entry = 1;
 
 		/* store default classified */
 		if (unlikely(tx_port->cls_attrs.mac_addr == CLS_DUMMY_ADDR)) {
-			mac_cls->default_cls_idx = i;
+			vlan_cls->default_cls_idx = i;
 			RTE_LOG(INFO, VF_CLS,
 					"default classified. vid=%hu, "
 					"iface_type=%d, iface_no=%d, queue_no=%d, "
@@ -389,13 +523,14 @@ init_component_info(struct cls_comp_info *cmp_info,
 		}
 
 		/* Add entry to classifier table. */
-		rte_memcpy(&eth_addr, &tx_port->cls_attrs.mac_addr,
+		key.vid = vid;
+		rte_memcpy(&key.mac, &tx_port->cls_attrs.mac_addr,
 				RTE_ETHER_ADDR_LEN);
 		rte_ether_format_addr(mac_addr_str, sizeof(mac_addr_str),
-				&eth_addr);
+				&key.mac);
 
-		ret = rte_hash_add_key_data(mac_cls->cls_tbl,
-				(void *)&eth_addr, (void *)(long)i);
+		ret = rte_hash_add_key_data(cmp_info->mac_tbl,
+				(void *)&key, (void *)(long)i);
 		if (unlikely(ret < 0)) {
 			RTE_LOG(ERR, VF_CLS,
 					"Cannot add to classifier table. "
@@ -416,6 +551,409 @@ init_component_info(struct cls_comp_info *cmp_info,
 	return SPPWK_RET_OK;
 }
 
+/* Check if port of classifier is same as given port. */
+static inline int
+is_same_port(const struct cls_port_info *cls_port,
+		const struct sppwk_port_info *wk_port)
+{
+	return cls_port->iface_type == wk_port->iface_type &&
+			cls_port->iface_no_global == wk_port->iface_no &&
+			cls_port->queue_no == wk_port->queue_no &&
+			cls_port->ethdev_port_id == wk_port->ethdev_port_id;
+}
+
+/* Check if RX and TX ports of classifier are same as given component. */
+static int
+is_same_ports(const struct cls_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info)
+{
+	int i;
+
+	if (wk_comp_info->nof_rx == 0) {
+		if (cmp_info->rx_port_i.iface_type != UNDEF)
+			return 0;
+	} else if (!is_same_port(&cmp_info->rx_port_i,
+			wk_comp_info->rx_ports[0]))
+		return 0;
+
+	if (cmp_info->nof_tx_ports != wk_comp_info->nof_tx)
+		return 0;
+
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		if (!is_same_port(&cmp_info->tx_ports_i[i],
+				wk_comp_info->tx_ports[i]))
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Check if entry of TX port is changed from the one in tables. */
+static inline int
+is_changed_entry(const struct cls_port_info *cls_port,
+		const struct sppwk_port_info *wk_port)
+{
+	if (cls_port->mac_addr != wk_port->cls_attrs.mac_addr)
+		return 1;
+	return cls_port->mac_addr != 0 &&
+			cls_port->vid != wk_port->cls_attrs.vlantag.vid;
+}
+
+/**
+ * Make classifier of the VLAN from TX ports again, and replace the old one
+ * in vlan_tbl. It is deleted from the table if no ports are in the VLAN.
+ * Classifier referring the old one keeps it until it is released.
+ */
+static int
+replace_vlan_classifier(struct cls_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info, uint16_t vid,
+		struct cls_garbage *garbage)
+{
+	int i, ret;
+	int32_t pos;
+	void *data;
+	struct vlan_classifier *vlan_cls, *old_cls = NULL;
+	struct sppwk_port_info *tx_port;
+
+	vlan_cls = rte_zmalloc(NULL, sizeof(struct vlan_classifier) +
+			sizeof(int) * wk_comp_info->nof_tx, 0);
+	if (unlikely(vlan_cls == NULL))
+		return SPPWK_RET_NG;
+
+	vlan_cls->nof_cls_ports = 0;
+	vlan_cls->default_cls_idx = -1;
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		tx_port = wk_comp_info->tx_ports[i];
+		if (tx_port->cls_attrs.mac_addr == 0 ||
+				tx_port->cls_attrs.vlantag.vid != vid)
+			continue;
+
+		vlan_cls->cls_ports[vlan_cls->nof_cls_ports++] = i;
+		if (tx_port->cls_attrs.mac_addr == CLS_DUMMY_ADDR)
+			vlan_cls->default_cls_idx = i;
+	}
+
+	if (rte_hash_lookup_data(cmp_info->vlan_tbl, &vid, &data) >= 0)
+		old_cls = data;
+
+	if (vlan_cls->nof_cls_ports == 0) {
+		rte_free(vlan_cls);
+		if (old_cls == NULL)
+			return SPPWK_RET_OK;
+
+		pos = rte_hash_del_key(cmp_info->vlan_tbl, &vid);
+		if (likely(pos >= 0))
+			garbage->vlan_pos[garbage->nof_vlan_pos++] = pos;
+		RTE_LOG(DEBUG, VF_CLS,
+				"Delete vlan classification. vid=%hu\n", vid);
+	} else {
+		/* Data is replaced atomically if the VID is registered. */
+		ret = rte_hash_add_key_data(cmp_info->vlan_tbl, &vid,
+				vlan_cls);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, VF_CLS,
+					"Cannot add vlan classification. "
+					"ret=%d, vid=%hu\n", ret, vid);
+			rte_free(vlan_cls);
+			return SPPWK_RET_NG;
+		}
+		RTE_LOG(DEBUG, VF_CLS,
+				"Replace vlan classification. vid=%hu, "
+				"nof_cls_ports=%d, default_cls_idx=%d\n",
+				vid, vlan_cls->nof_cls_ports,
+				vlan_cls->default_cls_idx);
+	}
+
+	if (old_cls != NULL)
+		garbage->vlan_cls[garbage->nof_vlan_cls++] = old_cls;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Get index of TX port of the key. If several ports have the same key, the
+ * last one is used as same as init_component_info().
+ */
+static int
+get_key_owner(const struct sppwk_comp_info *wk_comp_info,
+		const struct cls_mac_key *key)
+{
+	int i;
+	uint64_t mac_addr = 0;
+	const struct sppwk_port_info *tx_port;
+
+	rte_memcpy(&mac_addr, &key->mac, RTE_ETHER_ADDR_LEN);
+	for (i = wk_comp_info->nof_tx - 1; i >= 0; i--) {
+		tx_port = wk_comp_info->tx_ports[i];
+		if (tx_port->cls_attrs.mac_addr == mac_addr &&
+				tx_port->cls_attrs.vlantag.vid == key->vid)
+			return i;
+	}
+	return -1;
+}
+
+/* Add or delete the key in mac_tbl as TX ports of the component have. */
+static int
+update_mac_entry(struct cls_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info,
+		const struct cls_mac_key *key, struct cls_garbage *garbage)
+{
+	int ret;
+	int32_t pos;
+	void *data;
+	int idx = get_key_owner(wk_comp_info, key);
+	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
+
+	rte_ether_format_addr(mac_addr_str, sizeof(mac_addr_str), &key->mac);
+
+	if (idx < 0) {
+		pos = rte_hash_del_key(cmp_info->mac_tbl, key);
+		if (pos < 0)
+			return SPPWK_RET_OK;
+
+		garbage->mac_pos[garbage->nof_mac_pos++] = pos;
+		RTE_LOG(INFO, VF_CLS, "Delete entry from classifier table. "
+				"vid=%hu, mac_addr=%s\n", key->vid,
+				mac_addr_str);
+		return SPPWK_RET_OK;
+	}
+
+	if (rte_hash_lookup_data(cmp_info->mac_tbl, key, &data) >= 0 &&
+			(long)data == idx)
+		return SPPWK_RET_OK;
+
+	/* Data is replaced atomically if the key is registered. */
+	ret = rte_hash_add_key_data(cmp_info->mac_tbl, key, (void *)(long)idx);
+	if (unlikely(ret < 0)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot add to classifier table. "
+				"ret=%d, vid=%hu, mac_addr=%s\n",
+				ret, key->vid, mac_addr_str);
+		return SPPWK_RET_NG;
+	}
+
+	RTE_LOG(INFO, VF_CLS,
+			"Add entry to classifier table. "
+			"vid=%hu, mac_addr=%s, iface_type=%d, "
+			"iface_no=%d, queue_no=%d, ethdev_port_id=%d\n",
+			key->vid, mac_addr_str,
+			wk_comp_info->tx_ports[idx]->iface_type,
+			wk_comp_info->tx_ports[idx]->iface_no,
+			wk_comp_info->tx_ports[idx]->queue_no,
+			wk_comp_info->tx_ports[idx]->ethdev_port_id);
+	return SPPWK_RET_OK;
+}
+
+/* Add key of the entry and its VID to lists of updating. */
+static inline void
+add_entry_to_list(uint64_t mac_addr, uint16_t vid,
+		struct cls_mac_key *keys, int *nof_keys,
+		uint16_t *vids, int *nof_vids)
+{
+	int i;
+
+	if (mac_addr == 0)
+		return;
+
+	for (i = 0; i < *nof_vids; i++) {
+		if (vids[i] == vid)
+			break;
+	}
+	if (i == *nof_vids)
+		vids[(*nof_vids)++] = vid;
+
+	if (mac_addr == CLS_DUMMY_ADDR)
+		return;
+
+	keys[*nof_keys].vid = vid;
+	rte_memcpy(&keys[*nof_keys].mac, &mac_addr, RTE_ETHER_ADDR_LEN);
+	(*nof_keys)++;
+}
+
+/* Remove the classifier from garbage if it is restored to vlan_tbl. */
+static void
+unlink_garbage_vlan_cls(struct cls_garbage *garbage,
+		const struct vlan_classifier *vlan_cls)
+{
+	int i;
+
+	for (i = garbage->nof_vlan_cls - 1; i >= 0; i--) {
+		if (garbage->vlan_cls[i] != vlan_cls)
+			continue;
+		garbage->vlan_cls[i] =
+			garbage->vlan_cls[--garbage->nof_vlan_cls];
+		return;
+	}
+}
+
+/**
+ * Restore tables and TX ports changed by update_component_entries() from the
+ * undo log in reverse order. Entries added while updating are deleted, and
+ * released with garbage as same as ones deleted.
+ */
+static void
+rollback_component_entries(struct cls_comp_info *cmp_info,
+		const struct cls_undo *undo, struct cls_garbage *garbage)
+{
+	int i, ret;
+	int32_t pos;
+	void *data;
+
+	for (i = undo->nof_vlans - 1; i >= 0; i--) {
+		if (rte_hash_lookup_data(cmp_info->vlan_tbl, &undo->vids[i],
+				&data) >= 0) {
+			if (data == undo->vlan_cls[i])
+				continue;
+			garbage->vlan_cls[garbage->nof_vlan_cls++] = data;
+		}
+
+		if (undo->vlan_cls[i] == NULL) {
+			pos = rte_hash_del_key(cmp_info->vlan_tbl,
+					&undo->vids[i]);
+			if (pos >= 0)
+				garbage->vlan_pos[garbage->nof_vlan_pos++] =
+					pos;
+			continue;
+		}
+
+		ret = rte_hash_add_key_data(cmp_info->vlan_tbl,
+				&undo->vids[i], undo->vlan_cls[i]);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, VF_CLS,
+					"Cannot restore vlan classification. "
+					"ret=%d, vid=%hu\n", ret,
+					undo->vids[i]);
+			continue;
+		}
+		unlink_garbage_vlan_cls(garbage, undo->vlan_cls[i]);
+	}
+
+	for (i = undo->nof_macs - 1; i >= 0; i--) {
+		if (!undo->mac_found[i]) {
+			pos = rte_hash_del_key(cmp_info->mac_tbl,
+					&undo->mac_keys[i]);
+			if (pos >= 0)
+				garbage->mac_pos[garbage->nof_mac_pos++] = pos;
+			continue;
+		}
+
+		ret = rte_hash_add_key_data(cmp_info->mac_tbl,
+				&undo->mac_keys[i], undo->mac_data[i]);
+		if (unlikely(ret < 0))
+			RTE_LOG(ERR, VF_CLS,
+					"Cannot restore classifier table. "
+					"ret=%d, vid=%hu\n", ret,
+					undo->mac_keys[i].vid);
+	}
+
+	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+		cmp_info->tx_ports_i[i].mac_addr = undo->port_mac_addrs[i];
+		cmp_info->tx_ports_i[i].vid = undo->port_vids[i];
+		set_tx_mark_id(cmp_info, i);
+	}
+}
+
+/**
+ * Apply entries of TX ports changed by `classifier_table` command to tables
+ * of the classifier. Only keys of changed entries are added or deleted, and
+ * classifiers of VLANs of the entries are replaced, instead of creating all
+ * of tables again. Tables are shared with classifier running on reference
+ * side while updating.
+ *
+ * If it is failed, entries already applied are rolled back, so that tables
+ * and TX ports are the same as before.
+ */
+static int
+update_component_entries(struct cls_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info,
+		struct cls_garbage *garbage)
+{
+	int i, ret = SPPWK_RET_OK;
+	int nof_keys = 0, nof_vids = 0;
+	/* Old and new keys, and VIDs of changed entries. */
+	struct cls_mac_key keys[RTE_MAX_QUEUES_PER_PORT * 2];
+	uint16_t vids[RTE_MAX_QUEUES_PER_PORT * 2];
+	struct cls_port_info *cls_port;
+	struct sppwk_port_info *tx_port;
+	struct cls_undo *undo = &g_cls_undo;
+	void *data;
+
+	undo->nof_macs = 0;
+	undo->nof_vlans = 0;
+	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+		undo->port_mac_addrs[i] = cmp_info->tx_ports_i[i].mac_addr;
+		undo->port_vids[i] = cmp_info->tx_ports_i[i].vid;
+	}
+
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		cls_port = &cmp_info->tx_ports_i[i];
+		tx_port = wk_comp_info->tx_ports[i];
+		if (!is_changed_entry(cls_port, tx_port))
+			continue;
+
+		add_entry_to_list(cls_port->mac_addr, cls_port->vid,
+				keys, &nof_keys, vids, &nof_vids);
+		cls_port->mac_addr = tx_port->cls_attrs.mac_addr;
+		cls_port->vid = tx_port->cls_attrs.vlantag.vid;
+		set_tx_mark_id(cmp_info, i);
+		add_entry_to_list(cls_port->mac_addr, cls_port->vid,
+				keys, &nof_keys, vids, &nof_vids);
+	}
+
+	for (i = 0; i < nof_keys; i++) {
+		undo->mac_keys[undo->nof_macs] = keys[i];
+		undo->mac_found[undo->nof_macs] = rte_hash_lookup_data(
+				cmp_info->mac_tbl, &keys[i], &data) >= 0;
+		undo->mac_data[undo->nof_macs] =
+				undo->mac_found[undo->nof_macs] ? data : NULL;
+		undo->nof_macs++;
+
+		ret = update_mac_entry(cmp_info, wk_comp_info, &keys[i],
+				garbage);
+		if (unlikely(ret != SPPWK_RET_OK))
+			goto rollback;
+	}
+
+	for (i = 0; i < nof_vids; i++) {
+		undo->vids[undo->nof_vlans] = vids[i];
+		undo->vlan_cls[undo->nof_vlans] = NULL;
+		if (rte_hash_lookup_data(cmp_info->vlan_tbl, &vids[i],
+				&data) >= 0)
+			undo->vlan_cls[undo->nof_vlans] = data;
+		undo->nof_vlans++;
+
+		ret = replace_vlan_classifier(cmp_info, wk_comp_info, vids[i],
+				garbage);
+		if (unlikely(ret != SPPWK_RET_OK))
+			goto rollback;
+	}
+
+	return SPPWK_RET_OK;
+
+rollback:
+	rollback_component_entries(cmp_info, undo, garbage);
+	return ret;
+}
+
+/* Release entries deleted from tables after they are no longer referred. */
+static void
+release_garbage(struct cls_comp_info *cmp_info, struct cls_garbage *garbage)
+{
+	int i;
+
+	for (i = 0; i < garbage->nof_mac_pos; i++)
+		rte_hash_free_key_with_position(cmp_info->mac_tbl,
+				garbage->mac_pos[i]);
+	for (i = 0; i < garbage->nof_vlan_pos; i++)
+		rte_hash_free_key_with_position(cmp_info->vlan_tbl,
+				garbage->vlan_pos[i]);
+	for (i = 0; i < garbage->nof_vlan_cls; i++)
+		rte_free(garbage->vlan_cls[i]);
+
+	garbage->nof_mac_pos = 0;
+	garbage->nof_vlan_pos = 0;
+	garbage->nof_vlan_cls = 0;
+}
+
 /* transmit packet to one destination. */
 static inline void
 transmit_packets(struct cls_port_info *clsd_data)
@@ -491,16 +1029,16 @@ push_packet(struct rte_mbuf *pkt, struct cls_port_info *clsd_data)
 static inline int
 get_general_default_classified_index(struct cls_comp_info *cmp_info)
 {
-	struct mac_classifier *mac_cls;
+	struct vlan_classifier *vlan_cls;
 
-	mac_cls = cmp_info->mac_clfs[VLAN_UNTAGGED_VID];
-	if (unlikely(mac_cls == NULL)) {
+	vlan_cls = cmp_info->untagged_cls;
+	if (unlikely(vlan_cls == NULL)) {
 		LOG_DBG(cmp_info->name, "Untagged's default is not set. "
 				"vid=%d\n", (int)VLAN_UNTAGGED_VID);
 		return SPPWK_RET_NG;
 	}
 
-	return mac_cls->default_cls_idx;
+	return vlan_cls->default_cls_idx;
 }
 
 /* handle L2 multicast(include broadcast) packet */
@@ -510,15 +1048,15 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 		struct cls_port_info *clsd_data)
 {
 	int i;
-	struct mac_classifier *mac_cls;
+	struct vlan_classifier *vlan_cls;
 	uint16_t vid = get_vid(pkt);
 	int gen_def_clsd_idx = get_general_default_classified_index(cmp_info);
 	int n_act_clsd;
 
-	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
-	if (unlikely(mac_cls == NULL ||
-			mac_cls->nof_cls_ports == 0)) {
+	/* select vlan classification by vid */
+	vlan_cls = get_vlan_classifier(cmp_info, vid);
+	if (unlikely(vlan_cls == NULL ||
+			vlan_cls->nof_cls_ports == 0)) {
 		/* specific vlan is not registered
 		 * use untagged's default(as general default)
 		 */
@@ -537,16 +1075,17 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 	}
 
 	/* add to mbuf's refcnt */
-	n_act_clsd = mac_cls->nof_cls_ports;
+	n_act_clsd = vlan_cls->nof_cls_ports;
 	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID)
 		++n_act_clsd;
 
 	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
 
 	/* transmit to specific segment & general default */
-	for (i = 0; i < mac_cls->nof_cls_ports; i++) {
-		LOG_CLS((long)mac_cls->cls_ports[i], pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)mac_cls->cls_ports[i]);
+	for (i = 0; i < vlan_cls->nof_cls_ports; i++) {
+		LOG_CLS((long)vlan_cls->cls_ports[i], pkt, cmp_info,
+				clsd_data);
+		push_packet(pkt, clsd_data + (long)vlan_cls->cls_ports[i]);
 	}
 
 	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID) {
@@ -555,56 +1094,95 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 	}
 }
 
-/* select index of classified */
+/* select index of classified for a packet not found in the table */
 static inline int
-select_classified_index(const struct rte_mbuf *pkt,
+select_default_index(const struct cls_mac_key *key,
 		struct cls_comp_info *cmp_info)
 {
-	int ret;
-	struct rte_ether_hdr *eth;
-	void *lookup_data;
-	struct mac_classifier *mac_cls;
-	uint16_t vid;
-
-	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	vid = get_vid(pkt);
+	struct vlan_classifier *vlan_cls;
 
-	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
-	if (unlikely(mac_cls == NULL)) {
-		LOG_DBG(cmp_info->name, "Mac classification is not "
-				"registered. vid=%hu\n", vid);
+	/* select vlan classification by vid */
+	vlan_cls = get_vlan_classifier(cmp_info, key->vid);
+	if (unlikely(vlan_cls == NULL)) {
+		LOG_DBG(cmp_info->name, "Vlan classification is not "
+				"registered. vid=%hu\n", key->vid);
 		return get_general_default_classified_index(cmp_info);
 	}
 
-	/* find in table (by destination mac address) */
-	ret = rte_hash_lookup_data(mac_cls->cls_tbl,
-			(const void *)&eth->d_addr, &lookup_data);
-	if (ret >= 0) {
-		LOG_DBG(cmp_info->name, "Mac address is registered. "
-				"ret=%d, vid=%hu\n", ret, vid);
-		return (int)(long)lookup_data;
-	}
-
-	LOG_DBG(cmp_info->name,
-			"Mac address is not registered. ret=%d, "
-			"(EINVAL=%d, ENOENT=%d)\n", ret, EINVAL, ENOENT);
-
 	/* check if packet is l2 multicast */
-	if (unlikely(rte_is_multicast_ether_addr(&eth->d_addr)))
+	if (unlikely(rte_is_multicast_ether_addr(&key->mac)))
 		return -2;
 
 	/* if default is not set, use untagged's default */
-	if (unlikely(mac_cls->default_cls_idx < 0 &&
-			vid != VLAN_UNTAGGED_VID)) {
+	if (unlikely(vlan_cls->default_cls_idx < 0 &&
+			key->vid != VLAN_UNTAGGED_VID)) {
 		LOG_DBG(cmp_info->name, "Vid's default is not set. "
-				"use general default. vid=%hu\n", vid);
+				"use general default. vid=%hu\n", key->vid);
 		return get_general_default_classified_index(cmp_info);
 	}
 
 	/* use default */
-	LOG_DBG(cmp_info->name, "Use vid's default. vid=%hu\n", vid);
-	return mac_cls->default_cls_idx;
+	LOG_DBG(cmp_info->name, "Use vid's default. vid=%hu\n", key->vid);
+	return vlan_cls->default_cls_idx;
+}
+
+/**
+ * Select indexes of classified for packets. Keys of the packets are looked
+ * up at once to hide latency of accessing the table. `pkt_ids` are indexes
+ * of the packets in the burst, and results are set to `clsd_idxs` at the
+ * same indexes.
+ */
+static inline void
+select_classified_indexes(const struct cls_mac_key *keys,
+		const uint16_t *pkt_ids, uint32_t nof_pkts,
+		struct cls_comp_info *cmp_info, long *clsd_idxs)
+{
+	int ret;
+	uint32_t i;
+	uint64_t hit_mask = 0;
+	const void *key_ptrs[MAX_PKT_BURST];
+	void *lookup_data[MAX_PKT_BURST];
+
+	for (i = 0; i < nof_pkts; i++)
+		key_ptrs[i] = &keys[pkt_ids[i]];
+
+	/* find in table (by vid and destination mac address) */
+	ret = rte_hash_lookup_bulk_data(cmp_info->mac_tbl, key_ptrs, nof_pkts,
+			&hit_mask, lookup_data);
+	if (unlikely(ret < 0))
+		hit_mask = 0;
+	LOG_DBG(cmp_info->name, "Mac addresses are looked up. "
+			"ret=%d, nof_pkts=%u\n", ret, nof_pkts);
+
+	for (i = 0; i < nof_pkts; i++) {
+		if (likely(hit_mask & (1ULL << i)))
+			clsd_idxs[pkt_ids[i]] = (long)lookup_data[i];
+		else
+			clsd_idxs[pkt_ids[i]] = select_default_index(
+					&keys[pkt_ids[i]], cmp_info);
+	}
+}
+
+/**
+ * Select index of TX port from MARK given by NIC flow rule, or return -1
+ * for software lookup if the packet is not marked or no port has the ID.
+ * A port without any entry of classifier table has no ID. TX ports of a
+ * classifier are few, so IDs are scanned without hashing.
+ */
+static inline int
+select_marked_index(const struct rte_mbuf *pkt,
+		const struct cls_comp_info *cmp_info)
+{
+	int i;
+
+	if (!(pkt->ol_flags & PKT_RX_FDIR_ID))
+		return -1;
+
+	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+		if (cmp_info->tx_mark_ids[i] == pkt->hash.fdir.hi)
+			return i;
+	}
+	return -1;
 }
 
 static inline void
@@ -614,11 +1192,42 @@ _classify_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
 {
 	int i;
 	long clsd_idx;
+	long clsd_idxs[MAX_PKT_BURST];
+	struct cls_mac_key keys[MAX_PKT_BURST];
+	uint16_t unclsd_ids[MAX_PKT_BURST];  /* Packets to be looked up. */
+	uint32_t nof_unclsd = 0;
+	struct rte_ether_hdr *eth;
+
+	/* Prefetch headers of packets ahead of making keys. */
+	for (i = 0; i < PREFETCH_OFFSET && i < n_rx; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(rx_pkts[i], void *));
 
 	for (i = 0; i < n_rx; i++) {
+		if (i + PREFETCH_OFFSET < n_rx)
+			rte_prefetch0(rte_pktmbuf_mtod(
+					rx_pkts[i + PREFETCH_OFFSET], void *));
+
 		LOG_PKT(cmp_info->name, rx_pkts[i]);
 
-		clsd_idx = select_classified_index(rx_pkts[i], cmp_info);
+		if (g_flow_mark_mode) {
+			clsd_idxs[i] = select_marked_index(rx_pkts[i],
+					cmp_info);
+			if (clsd_idxs[i] >= 0)
+				continue;
+		}
+
+		eth = rte_pktmbuf_mtod(rx_pkts[i], struct rte_ether_hdr *);
+		keys[i].vid = get_vid(rx_pkts[i]);
+		rte_ether_addr_copy(&eth->d_addr, &keys[i].mac);
+		unclsd_ids[nof_unclsd++] = i;
+	}
+
+	if (nof_unclsd != 0)
+		select_classified_indexes(keys, unclsd_ids, nof_unclsd,
+				cmp_info, clsd_idxs);
+
+	for (i = 0; i < n_rx; i++) {
+		clsd_idx = clsd_idxs[i];
 		LOG_CLS(clsd_idx, rx_pkts[i], cmp_info, clsd_data);
 
 		if (likely(clsd_idx >= 0)) {
@@ -658,6 +1267,20 @@ change_classifier_index(struct cls_mng_info *mng_info, int id)
 	}
 }
 
+/* Enable or disable to classify packets by MARK of NIC flow rules. */
+void
+set_cls_flow_mark_mode(int enable)
+{
+	g_flow_mark_mode = enable;
+}
+
+/* Set num of entries of classifier table of each classifier. */
+void
+set_cls_table_entries(uint32_t entries)
+{
+	g_cls_table_entries = entries;
+}
+
 /* classifier(mac address) initialize globals. */
 int
 init_cls_mng_info(void)
@@ -666,6 +1289,79 @@ init_cls_mng_info(void)
 	return 0;
 }
 
+/**
+ * Update entries of classifier if only entries of TX ports are changed.
+ * Tables of reference side are updated without lock and shared with update
+ * side, then classifier is switched to update side only for waiting until
+ * deleted entries are no longer referred.
+ */
+static int
+update_classifier_entries(struct cls_mng_info *mng_info,
+		const struct sppwk_comp_info *wk_comp_info)
+{
+	int i, ret;
+	void *data;
+	uint16_t vid = VLAN_UNTAGGED_VID;
+	struct cls_comp_info *ref_info = mng_info->comp_list +
+			mng_info->ref_index;
+	struct cls_comp_info *upd_info = mng_info->comp_list +
+			mng_info->upd_index;
+
+	ret = update_component_entries(ref_info, wk_comp_info,
+			&g_cls_garbage);
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot update classifier entries, ret=%d.\n",
+				ret);
+
+		/*
+		 * Tables are rolled back and the same as reference side.
+		 * Sides are switched without any change only for releasing
+		 * entries of rolled back keys after they are not referred.
+		 */
+		if (g_cls_garbage.nof_mac_pos == 0 &&
+				g_cls_garbage.nof_vlan_pos == 0 &&
+				g_cls_garbage.nof_vlan_cls == 0)
+			return ret;
+	}
+
+	/* Share tables, and packets of reference side are not copied. */
+	memcpy(upd_info, ref_info, sizeof(struct cls_comp_info));
+	upd_info->rx_port_i.nof_pkts = 0;
+	for (i = 0; i < upd_info->nof_tx_ports; i++)
+		upd_info->tx_ports_i[i].nof_pkts = 0;
+
+	if (likely(ret == SPPWK_RET_OK)) {
+		upd_info->untagged_cls = NULL;
+		if (rte_hash_lookup_data(upd_info->vlan_tbl, &vid,
+				&data) >= 0)
+			upd_info->untagged_cls = data;
+
+		upd_info->mac_addr_entry = 0;
+		for (i = 0; i < wk_comp_info->nof_tx; i++) {
+			if (wk_comp_info->tx_ports[i]->cls_attrs.mac_addr !=
+					0)
+				upd_info->mac_addr_entry = 1;
+		}
+		memcpy(upd_info->name, wk_comp_info->name, STR_LEN_NAME);
+	}
+
+	/* change index of reference side */
+	mng_info->upd_index = mng_info->ref_index;
+
+	/* wait until no longer access the new update side */
+	while (likely(mng_info->ref_index ==
+			mng_info->upd_index))
+		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+
+	/* Release deleted entries, and old side without its tables. */
+	release_garbage(upd_info, &g_cls_garbage);
+	memset(mng_info->comp_list + mng_info->upd_index, 0,
+			sizeof(struct cls_comp_info));
+
+	return ret;
+}
+
 /* classifier(mac address) update component info. */
 int
 update_classifier(struct sppwk_comp_info *wk_comp_info)
@@ -678,6 +1374,17 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 	RTE_LOG(INFO, VF_CLS,
 			"Start updating classifier, id=%u.\n", wk_id);
 
+	/* Update entries incrementally if ports are not changed. */
+	cls_info = mng_info->comp_list + mng_info->ref_index;
+	if (is_used_mng_info(mng_info) && cls_info->mac_tbl != NULL &&
+			is_same_ports(cls_info, wk_comp_info)) {
+		ret = update_classifier_entries(mng_info, wk_comp_info);
+		RTE_LOG(INFO, VF_CLS,
+				"Done update classifier entries, id=%u.\n",
+				wk_id);
+		return ret;
+	}
+
 	/* TODO(yasufum) rename `infos`. */
 	cls_info = mng_info->comp_list + mng_info->upd_index;
 
@@ -768,12 +1475,20 @@ classify_packets(int comp_id)
 #endif
 	if (unlikely(n_rx == 0))
 		return SPPWK_RET_OK;
+	mng_info->stats.rx += n_rx;
 
 	_classify_packets(rx_pkts, n_rx, cmp_info, clsd_data_tx);
 
 	return SPPWK_RET_OK;
 }
 
+/* Get counters of classifier. */
+const struct stats *
+get_classifier_stats(int id)
+{
+	return &cls_mng_info_list[id].stats;
+}
+
 /* classifier iterate component information */
 int
 get_classifier_status(unsigned int lcore_id, int id,
@@ -826,65 +1541,86 @@ get_classifier_status(unsigned int lcore_id, int id,
 	return SPPWK_RET_OK;
 }
 
-/* Add MAC addresses in classifier table for `status` command. */
+/* Set port of TX port info for `status` command. */
+static inline void
+set_entry_port(struct sppwk_port_idx *port, struct cls_port_info *port_info,
+		long clsd_idx)
+{
+	port->iface_type = (port_info + clsd_idx)->iface_type;
+	port->iface_no = (port_info + clsd_idx)->iface_no_global;
+	port->queue_no = (port_info + clsd_idx)->queue_no;
+}
+
+/* Get type of classifier entry, MAC for untagged or VLAN for others. */
+static inline enum sppwk_cls_type
+get_entry_cls_type(uint16_t vid)
+{
+	if (unlikely(vid == VLAN_UNTAGGED_VID))
+		return SPPWK_CLS_TYPE_MAC;
+	return SPPWK_CLS_TYPE_VLAN;
+}
+
+/* Add default entries of each VLAN for `status` command. */
 static void
-add_mac_entry(struct classifier_table_params *params,
-		uint16_t vid,
-		struct mac_classifier *mac_cls,
-		__rte_unused struct cls_comp_info *cmp_info,
+add_default_entries(struct classifier_table_params *params,
+		struct cls_comp_info *cmp_info,
 		struct cls_port_info *port_info)
 {
-	int ret;
 	const void *key;
 	void *data;
-	uint32_t next;
+	uint32_t next = 0;
+	uint16_t vid;
+	struct vlan_classifier *vlan_cls;
 	struct sppwk_port_idx port;
-	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
-	enum sppwk_cls_type cls_type;
 
-	cls_type = SPPWK_CLS_TYPE_VLAN;
-	if (unlikely(vid == VLAN_UNTAGGED_VID))
-		cls_type = SPPWK_CLS_TYPE_MAC;
+	while (rte_hash_iterate(cmp_info->vlan_tbl, &key, &data, &next) >= 0) {
+		vid = *(const uint16_t *)key;
+		vlan_cls = data;
+		if (vlan_cls->default_cls_idx < 0)
+			continue;
 
-	if (mac_cls->default_cls_idx >= 0) {
-		port.iface_type = (port_info +
-				mac_cls->default_cls_idx)->iface_type;
-		port.iface_no = (port_info +
-				mac_cls->default_cls_idx)->iface_no_global;
-		port.queue_no = (port_info +
-				mac_cls->default_cls_idx)->queue_no;
+		set_entry_port(&port, port_info, vlan_cls->default_cls_idx);
 
-		LOG_ENT((long)mac_cls->default_cls_idx, vid,
+		LOG_ENT((long)vlan_cls->default_cls_idx, vid,
 				SPPWK_TERM_DEFAULT, cmp_info, port_info);
 		/**
 		 * Append "default" entry. `tbl_proc` is funciton pointer to
 		 * append_classifier_element_value().
 		 */
-		(*params->tbl_proc)(params, cls_type, vid,
+		(*params->tbl_proc)(params, get_entry_cls_type(vid), vid,
 				SPPWK_TERM_DEFAULT, &port);
 	}
+}
 
-	next = 0;
-	while (1) {
-		ret = rte_hash_iterate(mac_cls->cls_tbl, &key, &data, &next);
-
-		if (unlikely(ret < 0))
-			break;
+/* Add MAC addresses in classifier table for `status` command. */
+static void
+add_mac_entries(struct classifier_table_params *params,
+		struct cls_comp_info *cmp_info,
+		struct cls_port_info *port_info)
+{
+	const void *key;
+	void *data;
+	uint32_t next = 0;
+	const struct cls_mac_key *mac_key;
+	struct sppwk_port_idx port;
+	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
 
+	while (rte_hash_iterate(cmp_info->mac_tbl, &key, &data, &next) >= 0) {
+		mac_key = key;
 		rte_ether_format_addr(mac_addr_str, sizeof(mac_addr_str),
-				(const struct rte_ether_addr *)key);
+				&mac_key->mac);
 
-		port.iface_type = (port_info + (long)data)->iface_type;
-		port.iface_no = (port_info + (long)data)->iface_no_global;
-		port.queue_no = (port_info + (long)data)->queue_no;
+		set_entry_port(&port, port_info, (long)data);
 
-		LOG_ENT((long)data, vid, mac_addr_str, cmp_info, port_info);
+		LOG_ENT((long)data, mac_key->vid, mac_addr_str, cmp_info,
+				port_info);
 
 		/**
 		 * Append each entry of MAC address. `tbl_proc` is function
 		 * pointer to append_classifier_element_value().
 		 */
-		(*params->tbl_proc)(params, cls_type, vid, mac_addr_str, &port);
+		(*params->tbl_proc)(params, get_entry_cls_type(mac_key->vid),
+				mac_key->vid, mac_addr_str, &port);
 	}
 }
 
@@ -892,7 +1628,7 @@ add_mac_entry(struct classifier_table_params *params,
 static int
 _add_classifier_table(struct classifier_table_params *params)
 {
-	int i, vlan_id;
+	int i;
 	struct cls_mng_info *mng_info;
 	struct cls_comp_info *cmp_info;
 	struct cls_port_info *port_info;
@@ -908,14 +1644,11 @@ _add_classifier_table(struct classifier_table_params *params)
 		RTE_LOG(DEBUG, VF_CLS,
 			"Parse MAC entries for status on lcore %u.\n", i);
 
-		for (vlan_id = 0; vlan_id < NOF_VLAN; ++vlan_id) {
-			if (cmp_info->mac_clfs[vlan_id] == NULL)
-				continue;
+		if (cmp_info->vlan_tbl == NULL || cmp_info->mac_tbl == NULL)
+			continue;
 
-			add_mac_entry(params, (uint16_t) vlan_id,
-					cmp_info->mac_clfs[vlan_id], cmp_info,
-					port_info);
-		}
+		add_default_entries(params, cmp_info, port_info);
+		add_mac_entries(params, cmp_info, port_info);
 	}
 
 	return SPPWK_RET_OK;
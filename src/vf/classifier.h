@@ -75,6 +75,24 @@ int init_cls_mng_info(void);
 void init_classifier_info(int comp_id);
 
 
+/**
+ * Enable or disable to classify packets by MARK of NIC flow rules. If it
+ * is enabled, packets marked with CLS_FLOW_MARK_ID() of a TX port are
+ * sent to the port without lookup of classifier table.
+ *
+ * @param enable 1 for enabling, or 0 for disabling.
+ */
+void set_cls_flow_mark_mode(int enable);
+
+/**
+ * Set num of entries of classifier table. It is the max num of pairs of
+ * VID and MAC address registered in a classifier, and applied to tables
+ * created after this function is called.
+ *
+ * @param entries Num of entries.
+ */
+void set_cls_table_entries(uint32_t entries);
+
 /**
  * Classify incoming packets.
  *
@@ -84,6 +102,15 @@ void init_classifier_info(int comp_id);
  */
 int classify_packets(int comp_id);
 
+/**
+ * Get counters of classifier. Only RX is counted because packets are sent
+ * to several TX ports in bursts.
+ *
+ * @param[in] id Unique component ID.
+ * @return Counters of received packets.
+ */
+const struct stats *get_classifier_stats(int id);
+
 /**
  * Get classifier status.
  *
@@ -3,6 +3,7 @@
  */
 
 #include <rte_cycles.h>
+#include <rte_pause.h>
 
 #include "forwarder.h"
 #include "shared/secondary/return_codes.h"
@@ -27,15 +28,31 @@ struct forward_path {
 	volatile enum sppwk_worker_type wk_type;
 	int nof_rx;  /* Number of RX ports */
 	int nof_tx;  /* Number of TX ports */
+	enum tx_policy tx_policy;  /* TX policy of TX port */
+	uint64_t retry_tsc;  /* Budget of retrying TX in TSC */
 	struct forward_rxtx ports[RTE_MAX_ETHPORTS];  /* Set of RX and TX */
 };
 
+/**
+ * Packets held for TX_POLICY_HOLD to be sent on the next poll. It is kept
+ * over updates of forward_path, and the destination is also kept to drop
+ * held packets if TX port is changed.
+ */
+struct forward_hold {
+	int ethdev_port_id;
+	int queue_no;
+	uint16_t nof_pkts;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+};
+
 /* Information for forward. */
 struct forward_info {
 	volatile int ref_index; /* index to reference area */
 	volatile int upd_index; /* index to update area    */
 	struct forward_path path[TWO_SIDES];
 				/* Information of data path */
+	struct forward_hold hold;  /* Held packets of TX port */
+	struct stats stats;  /* Counters of packets in RX and TX */
 };
 
 struct forward_info g_forward_info[RTE_MAX_LCORE];
@@ -110,6 +127,7 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	int nof_rx = comp_info->nof_rx;
 	int nof_tx = comp_info->nof_tx;
 	int max = (nof_rx > nof_tx)?nof_rx*nof_tx:nof_tx;
+	struct tx_policy_conf tx_conf;
 	struct forward_info *fwd_info = &g_forward_info[comp_info->comp_id];
 	/* TODO(yasufum) rename `path` of struct forward_path. */
 	struct forward_path *fwd_path = &fwd_info->path[fwd_info->upd_index];
@@ -154,6 +172,15 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 		memcpy(&fwd_path->ports[cnt].tx, comp_info->tx_ports[0],
 				sizeof(struct sppwk_port_info));
 
+	if (nof_tx == 1) {
+		get_tx_policy(comp_info->tx_ports[0]->iface_type,
+				comp_info->tx_ports[0]->iface_no, &tx_conf);
+		fwd_path->tx_policy = tx_conf.policy;
+		if (tx_conf.policy == TX_POLICY_RETRY)
+			fwd_path->retry_tsc = (rte_get_tsc_hz() + US_PER_S - 1)
+					/ US_PER_S * tx_conf.retry_us;
+	}
+
 	fwd_info->upd_index = fwd_info->ref_index;
 	while (likely(fwd_info->ref_index == fwd_info->upd_index))
 		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
@@ -166,6 +193,13 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	return SPPWK_RET_OK;
 }
 
+/* Get counters of forwarder or merger. */
+const struct stats *
+get_forwarder_stats(int id)
+{
+	return &g_forward_info[id].stats;
+}
+
 /* Change index of forward info */
 static inline void
 change_forward_index(int id)
@@ -178,6 +212,104 @@ change_forward_index(int id)
 		info->ref_index = (info->upd_index+1) % TWO_SIDES;
 	}
 }
+/* Send packets to TX port. */
+static inline uint16_t
+send_packets(struct sppwk_port_info *tx, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+#ifdef SPP_RINGLATENCYSTATS_ENABLE
+	return sppwk_eth_vlan_ring_stats_tx_burst(tx->ethdev_port_id,
+			tx->iface_type, tx->iface_no, 0, bufs, nb_pkts);
+#else
+	return sppwk_eth_vlan_tx_burst(tx->ethdev_port_id, tx->queue_no,
+			bufs, nb_pkts);
+#endif
+}
+
+/* Send packets, and retry to send the rest until `retry_tsc` is passed. */
+static inline uint16_t
+send_packets_retry(struct sppwk_port_info *tx, struct rte_mbuf **bufs,
+		uint16_t nb_pkts, uint64_t retry_tsc)
+{
+	uint16_t nb_tx;
+	uint64_t start_tsc;
+
+	nb_tx = send_packets(tx, bufs, nb_pkts);
+	if (likely(nb_tx == nb_pkts) || retry_tsc == 0)
+		return nb_tx;
+
+	start_tsc = rte_rdtsc();
+	do {
+		rte_pause();
+		nb_tx += send_packets(tx, &bufs[nb_tx], nb_pkts - nb_tx);
+	} while (nb_tx < nb_pkts && rte_rdtsc() - start_tsc < retry_tsc);
+
+	return nb_tx;
+}
+
+/* Discard packets to release mbuf, and count them for the TX policy. */
+static inline void
+drop_packets(struct stats *stats, enum tx_policy tx_policy,
+		struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	uint16_t buf;
+
+	count_tx_drop(stats, tx_policy, nb_pkts);
+	for (buf = 0; buf < nb_pkts; buf++)
+		rte_pktmbuf_free(bufs[buf]);
+}
+
+/* Hold packets to be sent on the next poll, or drop them if no room. */
+static inline void
+hold_packets(struct forward_info *info, struct sppwk_port_info *tx,
+		struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct forward_hold *hold = &info->hold;
+	uint16_t nb_hold = RTE_MIN(nb_pkts,
+			(uint16_t)(MAX_PKT_BURST - hold->nof_pkts));
+
+	if (hold->nof_pkts == 0) {
+		hold->ethdev_port_id = tx->ethdev_port_id;
+		hold->queue_no = tx->queue_no;
+	}
+
+	memcpy(&hold->pkts[hold->nof_pkts], bufs,
+			sizeof(struct rte_mbuf *) * nb_hold);
+	hold->nof_pkts += nb_hold;
+
+	if (unlikely(nb_hold < nb_pkts))
+		drop_packets(&info->stats, TX_POLICY_HOLD, &bufs[nb_hold],
+				nb_pkts - nb_hold);
+}
+
+/**
+ * Send packets held on the previous poll. Packets which cannot be sent are
+ * kept, or dropped if TX port or TX policy is changed.
+ */
+static inline void
+send_held_packets(struct forward_info *info, struct forward_path *path)
+{
+	uint16_t nb_tx;
+	struct forward_hold *hold = &info->hold;
+	struct sppwk_port_info *tx = &path->ports[0].tx;
+
+	if (unlikely(path->tx_policy != TX_POLICY_HOLD ||
+			hold->ethdev_port_id != tx->ethdev_port_id ||
+			hold->queue_no != tx->queue_no)) {
+		drop_packets(&info->stats, TX_POLICY_HOLD, hold->pkts,
+				hold->nof_pkts);
+		hold->nof_pkts = 0;
+		return;
+	}
+
+	nb_tx = send_packets(tx, hold->pkts, hold->nof_pkts);
+	info->stats.tx += nb_tx;
+	hold->nof_pkts -= nb_tx;
+	if (hold->nof_pkts > 0 && nb_tx > 0)
+		memmove(hold->pkts, &hold->pkts[nb_tx],
+				sizeof(struct rte_mbuf *) * hold->nof_pkts);
+}
+
 /**
  * Forward packets as forwarder or merger.
  *
@@ -187,9 +319,9 @@ change_forward_index(int id)
 int
 forward_packets(int id)
 {
-	int cnt, buf;
-	int nb_rx = 0;
-	int nb_tx = 0;
+	int cnt;
+	uint16_t nb_rx = 0;
+	uint16_t nb_tx = 0;
 	struct forward_info *info = &g_forward_info[id];
 	struct forward_path *path = NULL;
 	struct sppwk_port_info *rx;
@@ -210,6 +342,10 @@ forward_packets(int id)
 			return SPPWK_RET_OK;
 	}
 
+	/* Send packets held on the previous poll before new ones. */
+	if (unlikely(info->hold.nof_pkts > 0))
+		send_held_packets(info, path);
+
 	for (cnt = 0; cnt < path->nof_rx; cnt++) {
 		rx = &path->ports[cnt].rx;
 		tx = &path->ports[cnt].tx;
@@ -224,23 +360,29 @@ forward_packets(int id)
 #endif
 		if (unlikely(nb_rx == 0))
 			continue;
+		info->stats.rx += nb_rx;
+
+		/* Keep order of packets behind held ones. */
+		if (unlikely(info->hold.nof_pkts > 0)) {
+			hold_packets(info, tx, bufs, nb_rx);
+			continue;
+		}
 
 		/* Send packets */
+		nb_tx = 0;
 		if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx = sppwk_eth_vlan_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, bufs, nb_rx);
-#else
-			nb_tx = sppwk_eth_vlan_tx_burst(tx->ethdev_port_id,
-					tx->queue_no, bufs, nb_rx);
-#endif
+			nb_tx = send_packets_retry(tx, bufs, nb_rx,
+					path->retry_tsc);
+		info->stats.tx += nb_tx;
+		if (likely(nb_tx == nb_rx))
+			continue;
 
-		/* Discard remained packets to release mbuf */
-		if (unlikely(nb_tx < nb_rx)) {
-			for (buf = nb_tx; buf < nb_rx; buf++)
-				rte_pktmbuf_free(bufs[buf]);
-		}
+		if (path->tx_policy == TX_POLICY_HOLD &&
+				tx->ethdev_port_id >= 0)
+			hold_packets(info, tx, &bufs[nb_tx], nb_rx - nb_tx);
+		else  /* Discard remained packets to release mbuf */
+			drop_packets(&info->stats, path->tx_policy,
+					&bufs[nb_tx], nb_rx - nb_tx);
 	}
 	return SPPWK_RET_OK;
 }
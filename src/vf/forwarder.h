@@ -38,6 +38,14 @@ void init_forwarder(void);
  */
 int forward_packets(int id);
 
+/**
+ * Get counters of forwarder or merger.
+ *
+ * @param id Unique component ID.
+ * @return Counters of packets in RX and TX.
+ */
+const struct stats *get_forwarder_stats(int id);
+
 /**
  * Get forwarder status.
  *
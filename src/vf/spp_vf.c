@@ -16,6 +16,7 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/shm_stats.h"
 
 #define RTE_LOGTYPE_SPP_VF RTE_LOGTYPE_USER1
 
@@ -29,7 +30,10 @@ enum SPP_LONGOPT_RETVAL {
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT,  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_TX_POLICY,  /* For `--tx-policy` */
+	SPP_LONGOPT_RETVAL_FLOW_MARK,  /* For `--flow-mark` */
+	SPP_LONGOPT_RETVAL_CLS_TABLE_SIZE  /* For `--cls-table-size` */
 };
 
 /* Declare global variables */
@@ -58,14 +62,46 @@ usage(const char *progname)
 	RTE_LOG(INFO, SPP_VF, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--tx-policy POLICY]"
+			" [--flow-mark]"
+			" [--cls-table-size NUM]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  :"
 			" Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --tx-policy POLICY        :"
+			" Policy of packets not accepted by TX queue,"
+			" such as `retry:20,ring:0=hold`\n"
+			" --flow-mark               :"
+			" Classify packets marked by NIC flow rules\n"
+			" --cls-table-size NUM      :"
+			" Max num of MAC entries of each classifier\n"
 			, progname);
 }
 
+/* Parse num of entries of classifier table given as `--cls-table-size`. */
+static int
+parse_cls_table_size(const char *size_str)
+{
+	unsigned long entries;
+	char *endptr = NULL;
+
+	entries = strtoul(size_str, &endptr, 0);
+	if (unlikely(size_str == endptr) || unlikely(*endptr != '\0'))
+		return SPPWK_RET_NG;
+
+	if (entries == 0 || entries > RTE_HASH_ENTRIES_MAX) {
+		RTE_LOG(ERR, SPP_VF, "Invalid size of classifier table "
+				"`%s`, must be 1 to %u.\n", size_str,
+				RTE_HASH_ENTRIES_MAX);
+		return SPPWK_RET_NG;
+	}
+
+	set_cls_table_entries(entries);
+	return SPPWK_RET_OK;
+}
+
 /* Parse options for client app */
 static int
 parse_app_args(int argc, char *argv[])
@@ -89,6 +125,12 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "tx-policy", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TX_POLICY },
+			{ "flow-mark", no_argument, NULL,
+					SPP_LONGOPT_RETVAL_FLOW_MARK },
+			{ "cls-table-size", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_CLS_TABLE_SIZE },
 			{ 0 },
 	};
 
@@ -120,6 +162,21 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_TX_POLICY:
+			if (parse_tx_policy_opt(optarg) != SPPWK_RET_OK) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_FLOW_MARK:
+			set_cls_flow_mark_mode(1);
+			break;
+		case SPP_LONGOPT_RETVAL_CLS_TABLE_SIZE:
+			if (parse_cls_table_size(optarg) != SPPWK_RET_OK) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			set_spp_ctl_ip(ctl_ip);
@@ -202,6 +259,58 @@ slave_main(void *arg __attribute__ ((unused)))
 	return ret;
 }
 
+/* Fill counters of components and its lcores to the stats segment. */
+static void
+collect_vf_stats(struct shm_stats *st)
+{
+	int cnt;
+	unsigned int lcore_id;
+	const char *type;
+	const struct stats *comp_stats;
+	struct sppwk_comp_info *comp;
+	struct shm_comp_stats *shm_comp;
+	struct shm_lcore_stats *shm_lcores[RTE_MAX_LCORE] = { NULL };
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		comp = &g_component_info[cnt];
+		switch (comp->wk_type) {
+		case SPPWK_TYPE_CLS:
+			type = SPPWK_TYPE_CLS_STR;
+			comp_stats = get_classifier_stats(cnt);
+			break;
+		case SPPWK_TYPE_MRG:
+			type = SPPWK_TYPE_MRG_STR;
+			comp_stats = get_forwarder_stats(cnt);
+			break;
+		case SPPWK_TYPE_FWD:
+			type = SPPWK_TYPE_FWD_STR;
+			comp_stats = get_forwarder_stats(cnt);
+			break;
+		default:
+			continue;
+		}
+
+		shm_comp = &st->comps[st->nof_comps++];
+		snprintf(shm_comp->name, sizeof(shm_comp->name), "%s",
+				comp->name);
+		snprintf(shm_comp->type, sizeof(shm_comp->type), "%s", type);
+		shm_comp->lcore_id = comp->lcore_id;
+		shm_comp->stats = *comp_stats;
+
+		/* Sum up components on the same lcore. */
+		lcore_id = comp->lcore_id;
+		if (lcore_id >= RTE_MAX_LCORE)
+			continue;
+		if (shm_lcores[lcore_id] == NULL) {
+			shm_lcores[lcore_id] = &st->lcores[st->nof_lcores++];
+			memset(shm_lcores[lcore_id], 0,
+					sizeof(struct shm_lcore_stats));
+			shm_lcores[lcore_id]->lcore_id = lcore_id;
+		}
+		add_stats(&shm_lcores[lcore_id]->stats, comp_stats);
+	}
+}
+
 /**
  * Main function
  *
@@ -318,6 +427,9 @@ main(int argc, char *argv[])
 		/* Backup the management information after initialization */
 		backup_mng_info(&g_backup_info);
 
+		/* Counters are published from this thread not to race cmds. */
+		shm_stats_init("vf", get_client_id(), collect_vf_stats);
+
 		/* Enter loop for accepting commands */
 		while (likely(g_core_info[master_lcore].status !=
 					SPPWK_LCORE_REQ_STOP))
@@ -327,6 +439,8 @@ main(int argc, char *argv[])
 			if (unlikely(ret != SPPWK_RET_OK))
 				break;
 
+			shm_stats_update_periodic();
+
 		       /*
 			* Wait to avoid CPU overloaded.
 			*/
@@ -109,7 +109,7 @@ class TestSppNfv(TestCase):
         nfv = self._get_nfv_status()
         self.assertFalse(port in nfv['ports'])
 
-    def _patch(self, src, dst):
+    def _patch(self, src, dst, fanout=None):
         """Set patch between given ports."""
 
         url = "{baseurl}/{sec_type}/{sec_id}/patches".format(
@@ -117,6 +117,8 @@ class TestSppNfv(TestCase):
                 sec_type=self.sec_type,
                 sec_id=self.default_sec_id)
         params = {'src': src, 'dst': dst}
+        if fanout is not None:
+            params['fanout'] = fanout
         requests.put(url, data=json.dumps(params))
 
     def _reset_patches(self):
@@ -180,7 +182,8 @@ class TestSppNfv(TestCase):
             self._add_port(port)
         self._patch(ports[0], ports[1])
         nfv = self._get_nfv_status()
-        self.assertTrue({'src': ports[0], 'dst': ports[1]} in nfv['patches'])
+        patches = [(p['src'], p['dst']) for p in nfv['patches']]
+        self.assertTrue((ports[0], ports[1]) in patches)
 
         self._reset_patches()
         nfv = self._get_nfv_status()
@@ -189,6 +192,58 @@ class TestSppNfv(TestCase):
         for port in ports:
             self._del_port(port)
 
+    def test_make_fanout_patch(self):
+        """Check if patch to several ports is created and reseted."""
+
+        ports = ['ring:1', 'ring:2', 'ring:3']
+
+        for port in ports:
+            self._add_port(port)
+        self._patch(ports[0], ports[1], ports[2:])
+        nfv = self._get_nfv_status()
+        patches = [(p['src'], p['dst'], p['fanout'])
+                   for p in nfv['patches']]
+        self.assertTrue((ports[0], ports[1], ports[2:]) in patches)
+
+        self._reset_patches()
+        nfv = self._get_nfv_status()
+        self.assertEqual(nfv['patches'], [])
+
+        for port in ports:
+            self._del_port(port)
+
+    def test_make_patch_bad_fanout(self):
+        """Check if patch is not created if fanout port is not found."""
+
+        ports = ['ring:1', 'ring:2']
+
+        for port in ports:
+            self._add_port(port)
+        self._patch(ports[0], ports[1], ['ring:3'])
+        nfv = self._get_nfv_status()
+        self.assertEqual(nfv['patches'], [])
+
+        for port in ports:
+            self._del_port(port)
+
+    def test_repatch_bad_fanout(self):
+        """Check if existing patch is kept if fanout port is not found."""
+
+        ports = ['ring:1', 'ring:2', 'ring:3']
+
+        for port in ports:
+            self._add_port(port)
+        self._patch(ports[0], ports[1], ports[2:])
+        self._patch(ports[0], ports[1], ['ring:4'])
+        nfv = self._get_nfv_status()
+        patches = [(p['src'], p['dst'], p['fanout'])
+                   for p in nfv['patches']]
+        self.assertEqual(patches, [(ports[0], ports[1], ports[2:])])
+
+        self._reset_patches()
+        for port in ports:
+            self._del_port(port)
+
     def test_forwarding(self):
         """Check if forwarding packet is counted up.
 